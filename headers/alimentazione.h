@@ -9,6 +9,30 @@
 #include "../lib/semaphore.h"
 #include "../lib/shared_memory.h"
 #include "../lib/conf.h"
+#include "../lib/processi.h"
+#include "../lib/istanza.h"
+#include "../lib/ammissione.h"
+#include "../lib/generazione.h"
+#include "../lib/pianificazione.h"
+#include "../lib/casuale.h"
+#include "../lib/eventi.h"
+
+/**
+ * @brief Numero massimo di tentativi per un atomo la cui generazione è fallita.
+ */
+#define MAX_TENTATIVI 6
+
+/**
+ * @struct ritentativo_
+ * @brief Atomo la cui generazione è fallita, in attesa di un nuovo tentativo.
+ */
+typedef struct ritentativo_
+{
+    int n_atomico;
+    int tentativi;
+    long long pronto_ms;
+    lignaggio_atomo lignaggio;
+} ritentativo;
 
 /**
  * @brief gestore segnale di terminazione, imposta a 0 la flag "simulazione in corso"
@@ -21,11 +45,57 @@ void term_handler(int signum);
  * Questa funzione crea un nuovo atomo con un numero atomico specificato
  * e avvia un nuovo processo eseguendo il programma associato all'atomo.
  *
+ * L'atomo è la radice di un nuovo lignaggio, con il passo corrente come lotto.
+ * Se la fork fallisce l'atomo viene messo nella coda dei ritentativi.
+ *
  * @param n_atomico Il numero atomico del nuovo atomo.
- * @return Il PID del processo creato.
+ * @return Il PID del processo creato, -1 se la fork è fallita.
  */
 int new_atomo(int n_atomico);
 
+/**
+ * @brief Comunica al master la nascita di un atomo con un record di evento.
+ *
+ * @param pid PID del nuovo atomo
+ * @param n_atomico Numero atomico del nuovo atomo
+ */
+void annuncia_nascita(pid_t pid, int n_atomico);
+
+/**
+ * @brief Comunica al master una scoria contata senza avviare il suo processo atomo.
+ *
+ * @param n_atomico Numero atomico estratto, sotto MIN_N_ATOMICO
+ */
+void annuncia_scoria(int n_atomico);
+
+/**
+ * @brief Calcola quanti atomi generare nel prossimo passo.
+ *
+ * Parte da N_NUOVI_ATOMI e la riduce in base alla latenza osservata della fork,
+ * al carico del sistema e ai processi ancora disponibili.
+ *
+ * @return Numero di atomi da generare (0 se non ci sono processi disponibili)
+ */
+int calcola_quota();
+
+/**
+ * @brief Mette in coda un atomo la cui generazione è fallita.
+ *
+ * Se la coda è piena l'atomo viene scartato e il suo lignaggio annullato.
+ *
+ * @param n_atomico Numero atomico dell'atomo
+ * @param lignaggio Lignaggio già assegnato all'atomo, conservato tra i tentativi
+ */
+void accoda_ritentativo(int n_atomico, const lignaggio_atomo *lignaggio);
+
+/**
+ * @brief Ritenta la generazione degli atomi in coda il cui tempo di attesa è scaduto.
+ *
+ * @param quota Numero massimo di tentativi da eseguire
+ * @return Il numero di tentativi eseguiti
+ */
+int esegui_ritentativi(int quota);
+
 /**
  * @brief Calcola un numero atomico casuale.
  *
@@ -9,33 +9,22 @@
 #include "../lib/semaphore.h"
 #include "../lib/shared_memory.h"
 #include "../lib/conf.h"
+#include "../lib/processi.h"
+#include "../lib/istanza.h"
+#include "../lib/ammissione.h"
+#include "../lib/generazione.h"
+#include "../lib/pianificazione.h"
+#include "../lib/casuale.h"
+#include "../lib/eventi.h"
 
 // DICHIARAZIONE DI FUNZIONI
 
-/**
- * @brief Calcola il massimo tra due numeri.
- *
- * @param a Primo numero
- * @param b Secondo numero
- * @return Il maggiore tra i due numeri
- */
-int max(int a, int b);
-
-/**
- * @brief Calcola l'energia generata dalla scissione dell'atomo.
- *
- * L'energia è calcolata in base al numero atomico dell'atomo e del suo figlio.
- *
- * @param n_atomico_figlio Numero atomico del nuovo atomo generato dalla scissione
- * @return Energia generata dalla scissione
- */
-int energy(int n_atomico_figlio);
-
 /**
  * @brief Esegue la scissione dell'atomo.
  *
  * La scissione genera un nuovo atomo con un numero atomico inferiore e calcola
- * l'energia rilasciata. Viene poi creato un nuovo processo per gestire il nuovo atomo.
+ * l'energia rilasciata. Viene poi creato un nuovo processo per gestire il nuovo atomo;
+ * se la fork fallisce la scissione viene annullata.
  *
  * @return Energia generata dalla scissione
  */
@@ -58,10 +47,14 @@ int calcolo_numero_atomico(int n_atomico_max);
  * Questa funzione crea un nuovo atomo con un numero atomico specificato
  * e avvia un nuovo processo eseguendo il programma associato all'atomo.
  *
+ * Se la fork fallisce e i fallimenti consecutivi hanno raggiunto SOGLIA_MELTDOWN
+ * viene dichiarato MELTDOWN.
+ *
  * @param n_atomico Il numero atomico del nuovo atomo.
- * @return Il PID del processo creato.
+ * @param lignaggio_figlio Lignaggio, generazione e nodo del nuovo atomo.
+ * @return Il PID del processo creato, -1 se la fork è fallita.
  */
-int new_atomo(int n_atomico);
+int new_atomo(int n_atomico, const lignaggio_atomo *lignaggio_figlio);
 
 /**
  * @brief gestore segnale di terminazione, imposta a 0 la flag "simulazione in corso"
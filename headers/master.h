@@ -2,13 +2,146 @@
 #include <unistd.h>
 #include <stdio.h>
 #include <signal.h>
+#include <sys/prctl.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
+#include <pthread.h>
+#include <sched.h>
 #include "../lib/handler.h"
 #include "../lib/code.h"
 #include "../lib/semaphore.h"
 #include "../lib/shared_memory.h"
 #include "../lib/conf.h"
+#include "../lib/processi.h"
+#include "../lib/istanza.h"
+#include "../lib/report.h"
+#include "../lib/generazione.h"
+#include "../lib/pianificazione.h"
+#include "../lib/casuale.h"
+#include "../lib/checkpoint.h"
+#include "../lib/registro.h"
+#include "../lib/inibizione.h"
+#include "../lib/eventi.h"
+#include "../lib/cgroup.h"
+#include "../lib/metriche.h"
+#include "../lib/latenza.h"
+#include "../lib/anello.h"
+
+/**
+ * @brief Numero di processi di controllo (attivatore, alimentazione, inibitore) esclusi
+ *        dalle statistiche degli atomi.
+ */
+#define N_PROCESSI_CONTROLLO 3
+
+/**
+ * @brief Record letti dalla coda a ogni iterazione del ciclo eventi, prima di controllare le altre richieste.
+ */
+#define RECORD_PER_ITERAZIONE 64
+
+/**
+ * @brief Lignaggi più energetici stampati a fine simulazione.
+ */
+#define LIGNAGGI_STAMPATI 5
+
+/**
+ * @brief Secchi dei contatori per tick: uno aperto al ciclo eventi, uno chiuso letto dal thread del tick.
+ */
+#define N_SECCHI 2
+
+/**
+ * @brief Istantanee dei tick in attesa del thread di stampa; oltre questo numero le più recenti vengono perse.
+ */
+#define CAPACITA_STAMPA 8
+
+/**
+ * @brief Attesa massima in millisecondi del thread del tick prima di ricontrollare la fine del ciclo eventi.
+ */
+#define ATTESA_TICK_MS 50
+
+/**
+ * @brief Attesa in millisecondi del thread di stampa quando non ci sono istantanee.
+ */
+#define ATTESA_STAMPA_MS 10
+
+/**
+ * @struct secchio_tick_
+ * @brief Contatori del master per un secondo di simulazione, scritti solo dal ciclo eventi.
+ *
+ * L'energia è contata anche nel contatore condiviso che l'inibitore legge mentre si accumula;
+ * al tick ne viene tolta solo quella del secchio chiuso.
+ */
+typedef struct secchio_tick_
+{
+    long long inizio_ns;
+    int scissioni;
+    int energia;
+    int scorie;
+    int scorie_senza_processo;
+    int attivazioni;
+    int delta_atomi;
+    long long fuori_secondo;
+    istogramma_latenza latenze;
+} secchio_tick;
+
+/**
+ * @struct istantanea_tick_
+ * @brief Valori di un tick passati dal thread del tick a quello di stampa.
+ *
+ * Anche le diagnostiche lette dal sistema (popolazione, code, scheduler, cgroup, inibitore)
+ * sono campionate dal thread del tick: il thread di stampa formatta soltanto, così i valori
+ * dell'ultimo secondo restano legati al proprio tick anche se la stampa resta indietro.
+ */
+typedef struct istantanea_tick_
+{
+    int tempo_passato;
+    int atomi_attivi;
+    int attivazioni;
+    int attivazioni_ultimo_secondo;
+    int energia_totale;
+    int energia_ultimo_secondo;
+    int energia_prelevata;
+    int scissioni;
+    int scissioni_ultimo_secondo;
+    int scorie;
+    int scorie_ultimo_secondo;
+    int scorie_senza_processo;
+    statistiche_generazione generazione;
+    long long latenza_media_generazione_us;
+    int inibitore_attivo;
+    int energia_assorbita;
+    int energia_assorbita_ultimo_secondo;
+    int obiettivo_atomi;
+    int permessi_concessi_ultimo_secondo;
+    int permessi_disponibili;
+    int ammissione_chiusa;
+    long long latenze_campioni;
+    long long latenza_p50_ns;
+    long long latenza_p99_ns;
+    long long latenza_massima_ns;
+    long long fuori_secondo;
+    riepilogo_popolazione popolazione;
+    long long attesa_cpu_us[N_COMPONENTI]; // -1 per i processi di controllo non avviati
+    stato_coda code[N_CODE];
+    int code_lette[N_CODE];
+    long long invii_bloccati_ultimo_secondo;
+    int atomi_ospitati;
+    int atomi_ospitati_minimo;
+    int atomi_ospitati_massimo;
+    campione_cgroup cgroup;
+    long long cpu_cgroup_ultimo_secondo_us; // -1 se non disponibile
+    unsigned long long passi_inibitore_ultimo_secondo;
+    unsigned long long interventi_inibitore_ultimo_secondo;
+    long long previsione_intervalli;
+    long long previsione_errore;
+    long long previsione_errore_assoluto;
+    int previsione;
+    int previsione_margine;
+    int previsione_limite;
+    int previsione_in_avvio;
+} istantanea_tick;
 
 /**
  * @brief Lancia un eseguibile in un processo figlio.
@@ -19,19 +152,288 @@
 int start(char *pathname);
 
 /**
- * @brief Gestisce il timer e la stampa della simulazione tramite il segnale SIGALRM.
+ * @brief Avvia N_OSPITI processi ospite degli atomi nel gruppo del reattore.
  *
- * @param signum Il numero del segnale ricevuto.
+ * I PID degli ospiti seguono i processi di controllo in `processi_controllo`, così che la
+ * raccolta non li conti tra gli atomi. Se la fork fallisce viene dichiarato MELTDOWN come per
+ * gli altri processi di controllo.
+ */
+void avvia_ospiti();
+
+/**
+ * @brief Stampa il numero di atomi vivi negli ospiti e il loro bilanciamento.
+ *
+ * @param istantanea Valori del tick
+ */
+void stampa_ospiti(const istantanea_tick *istantanea);
+
+/**
+ * @brief Avvia il thread del tick e quello di stampa con tutti i segnali bloccati.
+ *
+ * I segnali del master (SIGINT, SIGUSR1) restano così al thread principale, che esegue il ciclo eventi.
+ */
+void avvia_thread_master();
+
+/**
+ * @brief Chiamata all'uscita dal ciclo eventi: attende il thread del tick, poi quello di stampa
+ *        dopo che ha stampato le istantanee rimaste.
+ */
+void termina_thread_master();
+
+/**
+ * @brief Thread del tick: a ogni secondo, su scadenze assolute, esegue `esegui_tick`.
+ *
+ * @param argomento Non usato
+ * @return NULL
+ */
+void *thread_tick(void *argomento);
+
+/**
+ * @brief Attende la scadenza a passi di ATTESA_TICK_MS.
+ *
+ * @param scadenza Istante assoluto (CLOCK_MONOTONIC)
+ * @return 0 alla scadenza, -1 se il ciclo eventi è terminato prima
+ */
+int attendi_scadenza(const struct timespec *scadenza);
+
+/**
+ * @brief Registra il ritardo del tick rispetto alla scadenza e lo pubblica per bin/loadgen.
+ *
+ * @param istante Istante in cui il secondo si chiude (CLOCK_MONOTONIC)
+ */
+void registra_ritardo_tick(const struct timespec *istante);
+
+/**
+ * @brief Esegue un tick: chiude il secchio del secondo, aggiorna la simulazione, passa l'istantanea
+ *        al thread di stampa e controlla le soglie.
+ *
+ * @return 1 se la simulazione prosegue, 0 dopo l'ultimo tick
+ */
+int esegui_tick();
+
+/**
+ * @brief Thread di stampa: formatta e scrive le istantanee dei tick fuori dal percorso del tick.
+ *
+ * @param argomento Non usato
+ * @return NULL
+ */
+void *thread_stampa(void *argomento);
+
+/**
+ * @brief Chiamata dal ciclo eventi a ogni iterazione: passa al secchio dell'epoca aperta e la conferma.
+ *
+ * Al cambio di epoca scrive nel registro la variazione degli atomi e il tick del secchio chiuso.
+ * Dopo la conferma il ciclo eventi non scrive più il secchio precedente.
+ */
+void segui_epoca();
+
+/**
+ * @brief Apre il secchio del secondo successivo e attende che il ciclo eventi lo confermi.
+ *
+ * @param adesso Inizio del nuovo secondo
+ * @return Il secchio chiuso, che il thread del tick può leggere senza lock
+ */
+secchio_tick *chiudi_secchio(const struct timespec *adesso);
+
+/**
+ * @brief Aggiunge ai totali i valori dell'ultimo secondo e preleva l'energia richiesta.
+ *
+ * @param secchio Contatori dell'ultimo secondo
+ */
+void aggiorna_simulazione(const secchio_tick *secchio);
+
+/**
+ * @brief Raccoglie i valori del tick per la stampa e azzera i contatori per secondo dell'inibitore.
+ *
+ * Le latenze del secchio vengono riassunte nei percentili e sommate al totale.
+ *
+ * @param secchio Contatori dell'ultimo secondo
+ * @param istantanea Valori del tick
+ */
+void fotografa_tick(const secchio_tick *secchio, istantanea_tick *istantanea);
+
+/**
+ * @brief Campiona per l'istantanea le diagnostiche lette dal sistema e i loro valori dell'ultimo secondo.
+ *
+ * Chiamata solo dal thread del tick: i valori precedenti delle differenze sono suoi.
+ *
+ * @param istantanea Istantanea da completare
+ */
+void fotografa_diagnostiche(istantanea_tick *istantanea);
+
+/**
+ * @brief Gestori della tabella dei record: aggiornano i contatori dell'ultimo secondo e il registro degli eventi.
+ *
+ * @param record Record ricevuto dalla coda
  */
-void alarm_handler(int signum);
+void gestisci_nascita(const record_evento *record);
+void gestisci_scissione(const record_evento *record);
+void gestisci_scoria(const record_evento *record);
+void gestisci_attivazione(const record_evento *record);
+void gestisci_terminazione(const record_evento *record);
 
-void aggiorna_simulazione();
+/**
+ * @brief Invia al ciclo eventi del master un record con la causa di terminazione.
+ *
+ * @param causa Causa di terminazione (1 EXPLODE, 2 BLACKOUT, 3 MELTDOWN)
+ */
+void invia_terminazione(int causa);
+
+/**
+ * @brief Stampa i record ricevuti e il confronto con il formato a un intero per messaggio.
+ */
+void stampa_statistiche_record();
+
+/**
+ * @brief Esegue un tick durante la riproduzione: aggiornamento, inibitore, stato e soglie.
+ *
+ * @param secchio Contatori registrati nel tick
+ * @return La causa di terminazione (1 EXPLODE, 2 BLACKOUT), 0 se la simulazione prosegue
+ */
+int tick_riproduzione(const secchio_tick *secchio);
+
+/**
+ * @brief Riproduce un registro di eventi senza avviare processi e termina il programma.
+ *
+ * Gli eventi vengono applicati come se fossero letti dalla coda; a ogni tick registrato
+ * vengono eseguiti `aggiorna_simulazione`, l'assorbimento dell'inibitore e `stampa_stato`
+ * con i parametri della configurazione corrente, che può differire da quella registrata.
+ *
+ * @param percorso File del registro
+ */
+void riproduci_registro(const char *percorso);
 
 /**
- * @brief Stampa lo stato attuale della simulazione, inclusi il tempo rimanente,
+ * @brief Stampa lo stato della simulazione a un tick, inclusi il tempo rimanente,
  *        il numero di atomi attivi e l'energia totale accumulata.
+ *
+ * Fuori dalla riproduzione aggiunge le diagnostiche lette al momento (popolazione, code, scheduler).
+ *
+ * @param istantanea Valori del tick
+ */
+void stampa_stato(const istantanea_tick *istantanea);
+
+/**
+ * @brief Tempo di CPU consumato dal master e da tutti i processi del reattore già raccolti.
+ *
+ * Gli atomi raccolti da altri atomi sono inclusi, perché il loro consumo risale lungo la catena
+ * di `wait` fino al master.
+ *
+ * @return Tempo di CPU (utente e sistema) in millisecondi
+ */
+long long tempo_cpu_reattore_ms();
+
+/**
+ * @brief Legge tempo di esecuzione e attesa in coda di master, processi di controllo e atomi raccolti.
+ *
+ * @param uso Vettore di N_COMPONENTI elementi, indicizzato per componente
+ */
+void leggi_uso_componenti(uso_scheduler *uso);
+
+/**
+ * @brief Stampa i passi del ciclo di controllo dell'inibitore e gli assorbimenti dell'ultimo secondo.
+ *
+ * @param istantanea Valori del tick
+ */
+void stampa_ciclo_inibitore(const istantanea_tick *istantanea);
+
+/**
+ * @brief Stampa i quantili del numero atomico degli atomi vivi e il loro potenziale energetico.
+ *
+ * @param istantanea Valori del tick
+ */
+void stampa_popolazione(const istantanea_tick *istantanea);
+
+/**
+ * @brief Crea la coda di controllo dell'istanza e le code degli atomi, con la capacità richiesta da BYTE_CODA.
+ *
+ * @param istanza Istanza del reattore
+ */
+void crea_code(int istanza);
+
+/**
+ * @brief Rimuove tutte le code del reattore.
+ */
+void rimuovi_code();
+
+/**
+ * @brief Legge e smista i record di tutte le code, al più RECORD_PER_ITERAZIONE per coda.
+ *
+ * @return Il numero di record letti
+ */
+int consuma_code();
+
+/**
+ * @brief Stampa l'occupazione delle code letta con IPC_STAT e gli invii che hanno trovato una coda piena nell'ultimo secondo.
+ *
+ * @param istantanea Valori del tick
+ */
+void stampa_code(const istantanea_tick *istantanea);
+
+/**
+ * @brief Stampa a fine simulazione gli invii totali e quelli che hanno trovato la coda piena.
+ */
+void stampa_bloccati_code();
+
+/**
+ * @brief Stampa il consumo di CPU dell'ultimo secondo, la memoria, i processi e la pressione del cgroup della simulazione.
+ *
+ * @param istantanea Valori del tick
+ */
+void stampa_cgroup(const istantanea_tick *istantanea);
+
+/**
+ * @brief Stampa a fine simulazione gli aggregati dei lignaggi di scissione e i più energetici.
+ *
+ * Va chiamata dopo aver raccolto tutti gli atomi, quando l'arena non viene più scritta.
+ */
+void stampa_lignaggi();
+
+/**
+ * @brief Stampa a fine simulazione la latenza di contabilizzazione di tutte le scissioni.
+ */
+void stampa_latenza_contabilita_totale();
+
+/**
+ * @brief Pubblica per il thread di esposizione i contatori correnti e il ritardo dei tick.
+ *
+ * Chiamata dal thread del tick dopo l'aggiornamento: usa solo letture e scritture in memoria.
+ */
+void pubblica_stato_metriche();
+
+/**
+ * @brief Stampa la previsione dell'inibitore e il suo errore medio nel secondo del tick.
+ *
+ * @param istantanea Valori del tick
+ */
+void stampa_previsione(const istantanea_tick *istantanea);
+
+/**
+ * @brief Stampa l'attesa in coda di ogni componente nell'ultimo secondo.
+ *
+ * @param istantanea Valori del tick
+ */
+void stampa_attesa_ultimo_secondo(const istantanea_tick *istantanea);
+
+/**
+ * @brief Stampa il riepilogo finale della latenza di scheduling per componente.
+ *
+ * @param uso Valori letti prima dell'arresto, indicizzati per componente
+ * @param statistiche Statistiche degli atomi raccolti
+ */
+void stampa_latenza_scheduling(const uso_scheduler *uso, const statistiche_atomi *statistiche);
+
+/**
+ * @brief Gestisce SIGUSR1 richiedendo un checkpoint al tick successivo.
+ *
+ * @param signum Il numero del segnale ricevuto.
+ */
+void checkpoint_handler(int signum);
+
+/**
+ * @brief Scrive il checkpoint con i contatori del master e lo stato condiviso della simulazione.
  */
-void stato_simulazione();
+void salva_checkpoint();
 
 int new_atomo(int n_atomico);
 
@@ -0,0 +1,79 @@
+#include <sys/wait.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <signal.h>
+#include "../lib/handler.h"
+#include "../lib/semaphore.h"
+#include "../lib/shared_memory.h"
+#include "../lib/conf.h"
+#include "../lib/processi.h"
+#include "../lib/istanza.h"
+#include "../lib/ammissione.h"
+#include "../lib/generazione.h"
+#include "../lib/pianificazione.h"
+#include "../lib/casuale.h"
+#include "../lib/eventi.h"
+#include "../lib/lignaggio.h"
+#include "../lib/ospiti.h"
+
+/**
+ * @struct atomo_ospitato_
+ * @brief Stato di un atomo eseguito da un processo ospite.
+ */
+typedef struct atomo_ospitato_
+{
+    int n_atomico;
+    lignaggio_atomo lignaggio;
+} atomo_ospitato;
+
+// DICHIARAZIONE DI FUNZIONI
+
+/**
+ * @brief Attende l'avvio della simulazione accogliendo intanto gli atomi iniziali.
+ *
+ * @return 1 se la simulazione è partita, 0 se nel frattempo è stato richiesto l'arresto
+ */
+int attendi_avvio_ospite();
+
+/**
+ * @brief Aggiunge un atomo a quelli dell'ospite e lo conta nella popolazione.
+ *
+ * @param n_atomico Numero atomico del nuovo atomo
+ * @param lignaggio Lignaggio del nuovo atomo
+ */
+void aggiungi_atomo(int n_atomico, const lignaggio_atomo *lignaggio);
+
+/**
+ * @brief Riceve dalla coda degli ospiti gli atomi creati dal master e dall'alimentazione.
+ */
+void accogli_atomi();
+
+/**
+ * @brief Rende scoria gli atomi sotto MIN_N_ATOMICO, come fa un processo atomo all'inizio di ogni ciclo.
+ */
+void elimina_scorie();
+
+/**
+ * @brief Esegue la scissione di un atomo dell'ospite.
+ *
+ * Segue gli stessi passi della scissione di un processo atomo (estrazione del figlio, permesso,
+ * scoria senza processo, record di scissione), ma il figlio nasce nell'ospite senza fork.
+ *
+ * @param i Indice dell'atomo attivato
+ * @return Energia generata dalla scissione
+ */
+int scissione_ospitata(int i);
+
+/**
+ * @brief Toglie dalla popolazione gli atomi ancora vivi a fine simulazione.
+ */
+void rilascia_atomi();
+
+/**
+ * @brief Pubblica il numero di atomi vivi dell'ospite, usato per scegliere dove creare i nuovi atomi.
+ *
+ * @param delta Atomi nati (positivo) o terminati (negativo)
+ */
+void aggiorna_atomi_ospitati(int delta);
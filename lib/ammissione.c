@@ -0,0 +1,190 @@
+/**
+ * @file ammissione.c
+ * @brief Implementazione del controllo di ammissione degli atomi attivi.
+ *
+ * Il semaforo `sem_scissione` è un secchio di gettoni: ogni scissione o nuovo atomo consuma
+ * un gettone, il controllore ne aggiunge a ogni passo in proporzione alla distanza dall'obiettivo.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include "ammissione.h"
+#include "semaphore.h"
+
+/**
+ * @brief Legge un intero da un file di /proc.
+ *
+ * @param percorso Percorso del file
+ * @return Il valore letto, -1 in caso di errore
+ */
+static long leggi_valore_proc(const char *percorso)
+{
+    long valore = -1;
+    FILE *file = fopen(percorso, "r");
+    if (file == NULL)
+    {
+        return -1;
+    }
+    if (fscanf(file, "%ld", &valore) != 1)
+    {
+        valore = -1;
+    }
+    fclose(file);
+    return valore;
+}
+
+/**
+ * @brief Conta i processi esistenti nel sistema (quarto campo di /proc/loadavg).
+ *
+ * @return Numero di processi e thread esistenti, 0 se non disponibile
+ */
+static long processi_esistenti()
+{
+    long in_esecuzione, totale = 0;
+    FILE *file = fopen("/proc/loadavg", "r");
+    if (file == NULL)
+    {
+        return 0;
+    }
+    if (fscanf(file, "%*f %*f %*f %ld/%ld", &in_esecuzione, &totale) != 2)
+    {
+        totale = 0;
+    }
+    fclose(file);
+    return totale;
+}
+
+long processi_disponibili()
+{
+    // Se RLIMIT_NPROC non è limitato vale il limite globale dei pid
+    long limite;
+    struct rlimit rl;
+    if (getrlimit(RLIMIT_NPROC, &rl) == 0 && rl.rlim_cur != RLIM_INFINITY)
+    {
+        limite = (long)rl.rlim_cur;
+    }
+    else
+    {
+        limite = leggi_valore_proc("/proc/sys/kernel/pid_max");
+    }
+
+    if (limite <= 0)
+    {
+        return -1;
+    }
+    // Si lascia il 20% di margine ai processi non appartenenti al reattore
+    long disponibili = limite * 8 / 10 - processi_esistenti();
+    return disponibili > 0 ? disponibili : 0;
+}
+
+int calcola_obiettivo_atomi(const SimulationParams *params)
+{
+    if (params->max_atomi_attivi > 0)
+    {
+        return params->max_atomi_attivi;
+    }
+
+    long cpu = sysconf(_SC_NPROCESSORS_ONLN);
+    long obiettivo = (cpu > 0 ? cpu : 1) * (long)params->atomi_per_cpu;
+
+    // Con i processi ospite gli atomi non occupano pid
+    long disponibili = params->n_ospiti > 0 ? -1 : processi_disponibili();
+    if (disponibili >= 0 && disponibili < obiettivo)
+    {
+        obiettivo = disponibili;
+    }
+
+    return obiettivo > 0 ? (int)obiettivo : 1;
+}
+
+void inizializza_ammissione(controllore_ammissione *controllore, int obiettivo, int passi_al_secondo)
+{
+    controllore->obiettivo = obiettivo;
+    controllore->capacita = obiettivo / 10 > 0 ? obiettivo / 10 : 1;
+    controllore->chiuso = 0;
+    controllore->passi_al_secondo = passi_al_secondo > 0 ? passi_al_secondo : 1;
+    controllore->credito = 0;
+}
+
+int passo_ammissione(controllore_ammissione *controllore, shmseg *memoria, shmseg2 *memoria2, int atomi_attivi, int limite)
+{
+    int soglia_riapertura = controllore->obiettivo - (int)(controllore->obiettivo * ISTERESI_AMMISSIONE);
+    int concessi = 0;
+
+    if (controllore->chiuso && atomi_attivi < soglia_riapertura)
+    {
+        controllore->chiuso = 0;
+    }
+    else if (!controllore->chiuso && atomi_attivi >= controllore->obiettivo)
+    {
+        controllore->chiuso = 1;
+    }
+
+    if (controllore->chiuso)
+    {
+        controllore->credito = 0;
+        // Ritira tutti i gettoni per bloccare scissioni e nuovi atomi
+        if (trim_sem(memoria->sem_scissione, 0) == -1)
+        {
+            fprintf(stderr, "Errore nel ritirare i permessi dal semaforo.\n");
+            exit(1);
+        }
+    }
+    else
+    {
+        int capacita = controllore->capacita;
+        if (limite >= 0 && limite < capacita)
+        {
+            capacita = limite;
+        }
+        // Permessi in eccesso rispetto al limite previsto vengono ritirati, senza sovrascrivere
+        // il semaforo che alimentazione e atomi decrementano nel frattempo
+        if (trim_sem(memoria->sem_scissione, capacita) == -1)
+        {
+            fprintf(stderr, "Errore nel ritirare i permessi dal semaforo.\n");
+            exit(1);
+        }
+        int disponibili = sem_getvalue(memoria->sem_scissione);
+        double richiesti = (controllore->obiettivo - atomi_attivi) * GUADAGNO_AMMISSIONE;
+        if (richiesti < 1)
+        {
+            richiesti = 1;
+        }
+        // I permessi di un secondo sono distribuiti tra i passi; il resto frazionario si accumula
+        controllore->credito += richiesti / controllore->passi_al_secondo;
+        if (controllore->credito > controllore->capacita)
+        {
+            controllore->credito = controllore->capacita;
+        }
+        concessi = capacita - disponibili;
+        if (concessi > (int)controllore->credito)
+        {
+            concessi = (int)controllore->credito;
+        }
+        if (concessi > 0)
+        {
+            add_sem(memoria->sem_scissione, concessi);
+            controllore->credito -= concessi;
+        }
+        else
+        {
+            concessi = 0;
+        }
+    }
+
+    memoria2->obiettivo_atomi = controllore->obiettivo;
+    memoria2->ammissione_chiusa = controllore->chiuso;
+    __atomic_fetch_add(&memoria2->permessi_concessi_ultimo_sec, concessi, __ATOMIC_RELAXED);
+    return concessi;
+}
+
+int richiedi_permesso(shmseg *memoria, shmseg2 *memoria2)
+{
+    if (!__atomic_load_n(&memoria2->ammissione_attiva, __ATOMIC_ACQUIRE))
+    {
+        return 1;
+    }
+    return try_decrease_sem(memoria->sem_scissione) == 0;
+}
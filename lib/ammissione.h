@@ -0,0 +1,97 @@
+/**
+ * @file ammissione.h
+ * @brief Controllo di ammissione degli atomi attivi.
+ *
+ * Questo file contiene le dichiarazioni del controllore che regola scissioni e nuovi atomi
+ * concedendo permessi tramite il semaforo `sem_scissione`, usato come secchio di gettoni.
+ */
+
+#ifndef AMMISSIONE_H
+#define AMMISSIONE_H
+
+#include "conf.h"
+#include "shared_memory.h"
+
+/**
+ * @brief Frazione dell'obiettivo sotto la quale un controllore chiuso torna a concedere permessi.
+ */
+#define ISTERESI_AMMISSIONE 0.10
+
+/**
+ * @brief Guadagno proporzionale: frazione dello scarto dall'obiettivo concessa ogni secondo.
+ */
+#define GUADAGNO_AMMISSIONE 0.5
+
+/**
+ * @struct controllore_ammissione_
+ * @brief Stato del controllore di ammissione, mantenuto dal processo che lo esegue.
+ */
+typedef struct controllore_ammissione_
+{
+    int obiettivo;
+    int capacita;
+    int chiuso;
+    int passi_al_secondo;
+    double credito;
+} controllore_ammissione;
+
+/**
+ * @brief Stima quanti processi possono ancora essere creati.
+ *
+ * Il limite è RLIMIT_NPROC (o `pid_max` se infinito), ridotto del 20% e dei processi già esistenti.
+ *
+ * @return Processi ancora disponibili, -1 se il limite non è noto
+ */
+long processi_disponibili();
+
+/**
+ * @brief Calcola il numero obiettivo di atomi attivi.
+ *
+ * Se `MAX_ATOMI_ATTIVI` è impostato viene usato direttamente, altrimenti l'obiettivo è
+ * `ATOMI_PER_CPU` per ogni CPU, limitato dai processi ancora disponibili secondo RLIMIT_NPROC
+ * (o `pid_max` se il limite è infinito).
+ *
+ * @param params Parametri della simulazione
+ * @return Numero obiettivo di atomi attivi (almeno 1)
+ */
+int calcola_obiettivo_atomi(const SimulationParams *params);
+
+/**
+ * @brief Inizializza il controllore di ammissione.
+ *
+ * @param controllore Controllore da inizializzare
+ * @param obiettivo Numero obiettivo di atomi attivi
+ * @param passi_al_secondo Frequenza con cui viene eseguito `passo_ammissione`
+ */
+void inizializza_ammissione(controllore_ammissione *controllore, int obiettivo, int passi_al_secondo);
+
+/**
+ * @brief Esegue un passo del controllore e aggiorna i permessi disponibili.
+ *
+ * Con il controllore aperto aggiunge al secchio una frazione dello scarto tra obiettivo e
+ * atomi attivi, divisa tra i passi di un secondo, senza superarne la capacità; oltre
+ * l'obiettivo il controllore si chiude e svuota il secchio, e si riapre solo sotto
+ * l'obiettivo meno l'isteresi. I permessi disponibili non superano `limite`, il numero di
+ * scissioni che secondo la previsione dell'inibitore restano sotto la soglia di esplosione.
+ *
+ * @param controllore Stato del controllore
+ * @param memoria Memoria condivisa degli identificatori
+ * @param memoria2 Memoria condivisa della simulazione
+ * @param atomi_attivi Atomi attivi al momento del passo
+ * @param limite Massimo di permessi disponibili, -1 per nessun limite oltre la capacità
+ * @return Il numero di permessi concessi in questo passo
+ */
+int passo_ammissione(controllore_ammissione *controllore, shmseg *memoria, shmseg2 *memoria2, int atomi_attivi, int limite);
+
+/**
+ * @brief Richiede un permesso per una scissione o per un nuovo atomo.
+ *
+ * Se il controllo di ammissione non è attivo il permesso è sempre concesso.
+ *
+ * @param memoria Memoria condivisa degli identificatori
+ * @param memoria2 Memoria condivisa della simulazione
+ * @return 1 se il permesso è concesso, 0 altrimenti
+ */
+int richiedi_permesso(shmseg *memoria, shmseg2 *memoria2);
+
+#endif
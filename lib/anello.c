@@ -0,0 +1,60 @@
+/**
+ * @file anello.c
+ * @brief Implementazione della coda circolare tra un produttore e un consumatore.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "anello.h"
+
+int crea_anello(anello_spsc *anello, unsigned capacita, size_t dimensione)
+{
+    unsigned potenza = 1;
+    while (potenza < capacita)
+    {
+        potenza <<= 1;
+    }
+    memset(anello, 0, sizeof(*anello));
+    anello->elementi = malloc(potenza * dimensione);
+    if (anello->elementi == NULL)
+    {
+        perror("malloc error");
+        return -1;
+    }
+    anello->capacita = potenza;
+    anello->dimensione = dimensione;
+    return 0;
+}
+
+int inserisci_anello(anello_spsc *anello, const void *elemento)
+{
+    unsigned long long testa = anello->testa;
+    // L'acquire sulla coda garantisce che il consumatore abbia finito di copiare lo slot liberato
+    if (testa - __atomic_load_n(&anello->coda, __ATOMIC_ACQUIRE) == anello->capacita)
+    {
+        __atomic_fetch_add(&anello->persi, 1, __ATOMIC_RELAXED);
+        return -1;
+    }
+    memcpy(anello->elementi + (testa & (anello->capacita - 1)) * anello->dimensione, elemento, anello->dimensione);
+    __atomic_store_n(&anello->testa, testa + 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+int estrai_anello(anello_spsc *anello, void *elemento)
+{
+    unsigned long long coda = anello->coda;
+    if (coda == __atomic_load_n(&anello->testa, __ATOMIC_ACQUIRE))
+    {
+        return 0;
+    }
+    memcpy(elemento, anello->elementi + (coda & (anello->capacita - 1)) * anello->dimensione, anello->dimensione);
+    __atomic_store_n(&anello->coda, coda + 1, __ATOMIC_RELEASE);
+    return 1;
+}
+
+void distruggi_anello(anello_spsc *anello)
+{
+    free(anello->elementi);
+    anello->elementi = NULL;
+}
@@ -0,0 +1,69 @@
+/**
+ * @file anello.h
+ * @brief Coda circolare senza lock tra un solo produttore e un solo consumatore.
+ *
+ * Il produttore scrive solo la testa e il consumatore solo la coda, ciascuno su una propria riga
+ * di cache: un inserimento o un'estrazione sono una copia e un'unica scrittura atomica, senza
+ * attese. Con la coda piena l'inserimento fallisce invece di bloccare il produttore.
+ */
+
+#ifndef ANELLO_H
+#define ANELLO_H
+
+#include <stddef.h>
+
+/**
+ * @brief Dimensione di una riga di cache, per separare gli indici dei due thread.
+ */
+#define RIGA_CACHE 64
+
+/**
+ * @struct anello_spsc_
+ * @brief Elementi di dimensione fissa in un vettore di capacità potenza di due.
+ */
+typedef struct anello_spsc_
+{
+    unsigned long long testa __attribute__((aligned(RIGA_CACHE)));
+    unsigned long long coda __attribute__((aligned(RIGA_CACHE)));
+    unsigned long long persi;
+    unsigned capacita;
+    size_t dimensione;
+    unsigned char *elementi;
+} anello_spsc;
+
+/**
+ * @brief Alloca la coda.
+ *
+ * @param anello Coda da inizializzare
+ * @param capacita Numero di elementi, arrotondato alla potenza di due successiva
+ * @param dimensione Dimensione in byte di un elemento
+ * @return 0 se la coda è stata allocata, -1 altrimenti
+ */
+int crea_anello(anello_spsc *anello, unsigned capacita, size_t dimensione);
+
+/**
+ * @brief Inserisce una copia dell'elemento; chiamata solo dal produttore.
+ *
+ * @param anello Coda
+ * @param elemento Elemento da copiare
+ * @return 0 se l'elemento è stato inserito, -1 se la coda era piena (l'elemento viene contato tra i persi)
+ */
+int inserisci_anello(anello_spsc *anello, const void *elemento);
+
+/**
+ * @brief Estrae l'elemento più vecchio; chiamata solo dal consumatore.
+ *
+ * @param anello Coda
+ * @param elemento Destinazione della copia
+ * @return 1 se un elemento è stato estratto, 0 se la coda era vuota
+ */
+int estrai_anello(anello_spsc *anello, void *elemento);
+
+/**
+ * @brief Libera il vettore degli elementi.
+ *
+ * @param anello Coda
+ */
+void distruggi_anello(anello_spsc *anello);
+
+#endif
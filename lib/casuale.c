@@ -0,0 +1,155 @@
+/**
+ * @file casuale.c
+ * @brief Implementazione del generatore casuale condiviso e dell'istogramma degli atomi vivi.
+ */
+
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "casuale.h"
+
+/**
+ * @brief Funzione di mescolamento di splitmix64.
+ */
+static unsigned long long mescola(unsigned long long x)
+{
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+unsigned long long inizializza_casuale(shmseg2 *memoria2, unsigned long long seme)
+{
+    if (seme == 0)
+    {
+        struct timespec adesso;
+        clock_gettime(CLOCK_REALTIME, &adesso);
+        seme = mescola((unsigned long long)adesso.tv_sec * 1000000000ULL + adesso.tv_nsec) ^ (unsigned long long)getpid();
+    }
+    memoria2->seme = seme;
+    memoria2->estrazioni = 0;
+    return seme;
+}
+
+int estrai_numero_atomico(shmseg2 *memoria2, int n_atomico_max)
+{
+    unsigned long long i = __atomic_fetch_add(&memoria2->estrazioni, 1, __ATOMIC_RELAXED);
+    unsigned long long x = mescola(memoria2->seme + i * 0x9e3779b97f4a7c15ULL);
+    return (int)(x % (unsigned long long)(n_atomico_max - 1)) + 1;
+}
+
+/**
+ * @brief Classe dell'istogramma di un numero atomico.
+ */
+static int classe_popolazione(int n_atomico)
+{
+    return n_atomico < N_ATOMICO_MAX ? n_atomico : N_ATOMICO_MAX - 1;
+}
+
+void aggiorna_popolazione(shmseg2 *memoria2, int da, int a)
+{
+    if (da == a)
+    {
+        return;
+    }
+    if (da > 0)
+    {
+        __atomic_fetch_sub(&memoria2->popolazione[classe_popolazione(da)], 1, __ATOMIC_RELAXED);
+    }
+    if (a > 0)
+    {
+        __atomic_fetch_add(&memoria2->popolazione[classe_popolazione(a)], 1, __ATOMIC_RELAXED);
+    }
+}
+
+int conta_atomi_vivi(shmseg2 *memoria2)
+{
+    int atomi = 0;
+    for (int n = 1; n < N_ATOMICO_MAX; n++)
+    {
+        atomi += __atomic_load_n(&memoria2->popolazione[n], __ATOMIC_RELAXED);
+    }
+    return atomi;
+}
+
+int energy(int n_atomico, int n_atomico_figlio)
+{
+    return n_atomico * n_atomico_figlio - (n_atomico > n_atomico_figlio ? n_atomico : n_atomico_figlio);
+}
+
+double energia_attesa_scissione(int n_atomico)
+{
+    if (n_atomico < 2)
+    {
+        return 0;
+    }
+    // Con figlio k il padre scende a n - k e l'energia è (n - k) * k - max(n - k, k):
+    // la somma dei prodotti è (n^3 - n) / 6, quella dei massimi 3h^2 - 2h (n = 2h) o 3h^2 + h (n = 2h + 1)
+    double n = n_atomico;
+    long long h = n_atomico / 2;
+    double massimi = n_atomico % 2 == 0 ? 3 * h * h - 2 * h : 3 * h * h + h;
+    return ((n * n * n - n) / 6 - massimi) / (n - 1);
+}
+
+void riassumi_popolazione(shmseg2 *memoria2, int min_n_atomico, riepilogo_popolazione *riepilogo)
+{
+    int classi[N_ATOMICO_MAX];
+    memset(riepilogo, 0, sizeof(riepilogo_popolazione));
+    for (int n = 1; n < N_ATOMICO_MAX; n++)
+    {
+        // Durante una scissione una classe può essere letta prima dell'incremento e dopo il decremento
+        classi[n] = __atomic_load_n(&memoria2->popolazione[n], __ATOMIC_RELAXED);
+        if (classi[n] < 0)
+        {
+            classi[n] = 0;
+        }
+        riepilogo->atomi += classi[n];
+    }
+    if (riepilogo->atomi == 0)
+    {
+        return;
+    }
+
+    // Posizioni (da 1) dei quantili nella popolazione ordinata per numero atomico
+    int posizione_p10 = (riepilogo->atomi + 9) / 10;
+    int posizione_mediana = (riepilogo->atomi + 1) / 2;
+    int posizione_p90 = (riepilogo->atomi * 9 + 9) / 10;
+    int cumulati = 0;
+    for (int n = 1; n < N_ATOMICO_MAX; n++)
+    {
+        if (classi[n] == 0)
+        {
+            continue;
+        }
+        if (riepilogo->minimo == 0)
+        {
+            riepilogo->minimo = n;
+        }
+        riepilogo->massimo = n;
+        int precedenti = cumulati;
+        cumulati += classi[n];
+        if (precedenti < posizione_p10 && cumulati >= posizione_p10)
+        {
+            riepilogo->p10 = n;
+        }
+        if (precedenti < posizione_mediana && cumulati >= posizione_mediana)
+        {
+            riepilogo->mediana = n;
+        }
+        if (precedenti < posizione_p90 && cumulati >= posizione_p90)
+        {
+            riepilogo->p90 = n;
+        }
+
+        if (n >= min_n_atomico)
+        {
+            riepilogo->fissili += classi[n];
+            riepilogo->potenziale += classi[n] * energia_attesa_scissione(n);
+            if (n < 2 * min_n_atomico)
+            {
+                riepilogo->vicini_scoria += classi[n];
+            }
+        }
+    }
+}
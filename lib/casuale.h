@@ -0,0 +1,99 @@
+/**
+ * @file casuale.h
+ * @brief Generatore casuale condiviso dal reattore e istogramma degli atomi vivi.
+ *
+ * Il generatore è basato su un contatore: ogni estrazione incrementa `estrazioni` in memoria
+ * condivisa e mescola il suo valore con `seme`. Lo stato dell'intero reattore è quindi dato
+ * da due interi, che il checkpoint salva e ripristina.
+ *
+ * L'istogramma `popolazione` conta gli atomi vivi per numero atomico ed è aggiornato con
+ * incrementi atomici alla nascita, alla scissione e all'uscita di ogni atomo; chiunque sia
+ * agganciato alla memoria condivisa può riassumerlo senza attendere il tick del master.
+ */
+
+#ifndef CASUALE_H
+#define CASUALE_H
+
+#include "shared_memory.h"
+
+/**
+ * @brief Inizializza il generatore condiviso.
+ *
+ * @param memoria2 Memoria condivisa della simulazione
+ * @param seme Seme del generatore, 0 per ricavarlo da orologio e PID
+ * @return Il seme usato
+ */
+unsigned long long inizializza_casuale(shmseg2 *memoria2, unsigned long long seme);
+
+/**
+ * @brief Estrae il numero atomico di un nuovo atomo, in [1, n_atomico_max - 1].
+ *
+ * @param memoria2 Memoria condivisa della simulazione
+ * @param n_atomico_max Estremo superiore escluso (almeno 2)
+ * @return Il numero atomico estratto
+ */
+int estrai_numero_atomico(shmseg2 *memoria2, int n_atomico_max);
+
+/**
+ * @brief Registra nell'istogramma il passaggio di un atomo da un numero atomico a un altro.
+ *
+ * @param memoria2 Memoria condivisa della simulazione
+ * @param da Numero atomico precedente, 0 per un atomo che nasce
+ * @param a Numero atomico nuovo, 0 per un atomo che termina
+ */
+void aggiorna_popolazione(shmseg2 *memoria2, int da, int a);
+
+/**
+ * @brief Conta gli atomi vivi sommando l'istogramma, senza attendere il tick del master.
+ *
+ * @param memoria2 Memoria condivisa della simulazione
+ * @return Il numero di atomi vivi
+ */
+int conta_atomi_vivi(shmseg2 *memoria2);
+
+/**
+ * @struct riepilogo_popolazione_
+ * @brief Quantili del numero atomico degli atomi vivi e potenziale energetico della popolazione.
+ */
+typedef struct riepilogo_popolazione_
+{
+    int atomi;
+    int fissili;        // Atomi con numero atomico almeno MIN_N_ATOMICO
+    int vicini_scoria;  // Fissili con numero atomico sotto 2 * MIN_N_ATOMICO
+    int minimo;
+    int p10;
+    int mediana;
+    int p90;
+    int massimo;
+    double potenziale;  // Energia attesa se ogni atomo fissile si scindesse una volta
+} riepilogo_popolazione;
+
+/**
+ * @brief Energia liberata da una scissione, la stessa per un processo atomo e per un ospite.
+ *
+ * @param n_atomico Numero atomico del padre dopo la scissione
+ * @param n_atomico_figlio Numero atomico del figlio
+ * @return Il prodotto dei due numeri atomici meno il maggiore dei due
+ */
+int energy(int n_atomico, int n_atomico_figlio);
+
+/**
+ * @brief Energia attesa dalla scissione di un atomo, con il figlio uniforme in [1, n_atomico - 1].
+ *
+ * @param n_atomico Numero atomico dell'atomo prima della scissione
+ * @return L'energia media, 0 se l'atomo non può scindersi
+ */
+double energia_attesa_scissione(int n_atomico);
+
+/**
+ * @brief Riassume l'istogramma degli atomi vivi in quantili e potenziale energetico.
+ *
+ * La lettura non è un'istantanea: le classi vengono lette una alla volta mentre gli atomi le aggiornano.
+ *
+ * @param memoria2 Memoria condivisa della simulazione
+ * @param min_n_atomico Numero atomico sotto il quale un atomo diventa scoria
+ * @param riepilogo Riepilogo da compilare
+ */
+void riassumi_popolazione(shmseg2 *memoria2, int min_n_atomico, riepilogo_popolazione *riepilogo);
+
+#endif
@@ -0,0 +1,264 @@
+/**
+ * @file cgroup.c
+ * @brief Implementazione del sottoalbero cgroup v2 della simulazione.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "cgroup.h"
+
+/**
+ * @brief Scrive un testo in un file di controllo del cgroup.
+ *
+ * @return 0 in caso di successo, -1 altrimenti con errno impostato
+ */
+static int scrivi_controllo(const char *directory, const char *file, const char *testo)
+{
+    char percorso[PATH_MAX + 64];
+    snprintf(percorso, sizeof(percorso), "%s/%s", directory, file);
+    int fd = open(percorso, O_WRONLY);
+    if (fd == -1)
+    {
+        return -1;
+    }
+    ssize_t scritti = write(fd, testo, strlen(testo));
+    int errore = errno;
+    close(fd);
+    errno = errore;
+    return scritti == (ssize_t)strlen(testo) ? 0 : -1;
+}
+
+/**
+ * @brief Legge un file di controllo del cgroup in un buffer terminato da zero.
+ *
+ * @return I byte letti, -1 se il file non esiste o non è leggibile
+ */
+static int leggi_controllo(const char *directory, const char *file, char *buffer, size_t dimensione)
+{
+    char percorso[PATH_MAX + 64];
+    snprintf(percorso, sizeof(percorso), "%s/%s", directory, file);
+    int fd = open(percorso, O_RDONLY);
+    if (fd == -1)
+    {
+        return -1;
+    }
+    ssize_t letti = read(fd, buffer, dimensione - 1);
+    close(fd);
+    if (letti < 0)
+    {
+        return -1;
+    }
+    buffer[letti] = '\0';
+    return letti;
+}
+
+/**
+ * @brief Trova il punto di montaggio della gerarchia cgroup v2.
+ *
+ * @return 0 se trovato, -1 altrimenti
+ */
+static int montaggio_cgroup2(char *montaggio, size_t dimensione)
+{
+    FILE *file = fopen("/proc/self/mountinfo", "r");
+    if (file == NULL)
+    {
+        return -1;
+    }
+    char line[1024];
+    int trovato = -1;
+    while (trovato == -1 && fgets(line, sizeof(line), file) != NULL)
+    {
+        char punto[PATH_MAX];
+        if (strstr(line, " - cgroup2 ") != NULL && sscanf(line, "%*d %*d %*s %*s %4095s", punto) == 1)
+        {
+            snprintf(montaggio, dimensione, "%s", punto);
+            trovato = 0;
+        }
+    }
+    fclose(file);
+    return trovato;
+}
+
+/**
+ * @brief Ricava il cgroup v2 corrente del processo dalla riga `0::` di /proc/self/cgroup.
+ *
+ * @return 0 se trovato, -1 altrimenti
+ */
+static int cgroup_corrente(const char *montaggio, char *percorso, size_t dimensione)
+{
+    FILE *file = fopen("/proc/self/cgroup", "r");
+    if (file == NULL)
+    {
+        return -1;
+    }
+    char line[PATH_MAX + 16];
+    int trovato = -1;
+    while (trovato == -1 && fgets(line, sizeof(line), file) != NULL)
+    {
+        if (strncmp(line, "0::", 3) == 0)
+        {
+            line[strcspn(line, "\n")] = '\0';
+            // Nella radice il percorso è "/": evita la doppia barra
+            snprintf(percorso, dimensione, "%s%s", montaggio, strcmp(line + 3, "/") == 0 ? "" : line + 3);
+            trovato = 0;
+        }
+    }
+    fclose(file);
+    return trovato;
+}
+
+int entra_cgroup(cgroup_reattore *cgroup, const char *padre, int istanza, long pids_max)
+{
+    char montaggio[PATH_MAX];
+    char base[PATH_MAX];
+    memset(cgroup, 0, sizeof(cgroup_reattore));
+    cgroup->pids_max = -1;
+
+    if (montaggio_cgroup2(montaggio, sizeof(montaggio)) == -1 ||
+        cgroup_corrente(montaggio, cgroup->origine, sizeof(cgroup->origine)) == -1)
+    {
+        fprintf(stderr, "cgroup: gerarchia cgroup v2 non trovata, telemetria disattivata\n");
+        return -1;
+    }
+    if (strcmp(padre, "1") == 0)
+    {
+        snprintf(base, sizeof(base), "%s", cgroup->origine);
+    }
+    else
+    {
+        snprintf(base, sizeof(base), "%s", padre);
+    }
+
+    snprintf(cgroup->percorso, sizeof(cgroup->percorso), "%.*s/reattore-%d-%d",
+             PATH_MAX - 32, base, istanza, (int)getpid());
+    if (mkdir(cgroup->percorso, 0755) == -1)
+    {
+        fprintf(stderr, "cgroup: impossibile creare %s: %s\n", cgroup->percorso, strerror(errno));
+        cgroup->percorso[0] = '\0';
+        return -1;
+    }
+    // Scrivere 0 in cgroup.procs sposta il processo chiamante
+    if (scrivi_controllo(cgroup->percorso, "cgroup.procs", "0") == -1)
+    {
+        fprintf(stderr, "cgroup: impossibile entrare in %s: %s\n", cgroup->percorso, strerror(errno));
+        rmdir(cgroup->percorso);
+        cgroup->percorso[0] = '\0';
+        return -1;
+    }
+
+    // Il padre può abilitare i controller solo se non contiene processi (o è la radice): con un
+    // cgroup delegato vuoto riesce, altrimenti restano disponibili solo cpu.stat e PSI
+    const char *controller[] = {"+cpu", "+memory", "+pids"};
+    for (size_t i = 0; i < sizeof(controller) / sizeof(controller[0]); i++)
+    {
+        scrivi_controllo(base, "cgroup.subtree_control", controller[i]);
+    }
+
+    if (pids_max > 0)
+    {
+        char limite[32];
+        snprintf(limite, sizeof(limite), "%ld", pids_max);
+        if (scrivi_controllo(cgroup->percorso, "pids.max", limite) == -1)
+        {
+            fprintf(stderr, "cgroup: impossibile impostare pids.max a %ld: %s\n", pids_max, strerror(errno));
+        }
+        else
+        {
+            cgroup->pids_max = pids_max;
+        }
+    }
+
+    char controllori[256];
+    if (leggi_controllo(cgroup->percorso, "cgroup.controllers", controllori, sizeof(controllori)) <= 0)
+    {
+        snprintf(controllori, sizeof(controllori), "nessuno\n");
+    }
+    dprintf(1, "Cgroup della simulazione: %s (controller: %.*s)\n", cgroup->percorso,
+            (int)strcspn(controllori, "\n"), controllori);
+    return 0;
+}
+
+/**
+ * @brief Legge la pressione "some" media sugli ultimi 10 secondi da un file PSI.
+ */
+static double leggi_pressione(const char *directory, const char *file)
+{
+    char buffer[256];
+    double media;
+    if (leggi_controllo(directory, file, buffer, sizeof(buffer)) <= 0 ||
+        sscanf(buffer, "some avg10=%lf", &media) != 1)
+    {
+        return -1;
+    }
+    return media;
+}
+
+/**
+ * @brief Legge un file con un solo valore numerico (`max` vale -1).
+ */
+static long long leggi_valore(const char *directory, const char *file)
+{
+    char buffer[64];
+    long long valore;
+    if (leggi_controllo(directory, file, buffer, sizeof(buffer)) <= 0 || sscanf(buffer, "%lld", &valore) != 1)
+    {
+        return -1;
+    }
+    return valore;
+}
+
+void campiona_cgroup(const cgroup_reattore *cgroup, campione_cgroup *campione)
+{
+    char buffer[1024];
+    campione->cpu_us = campione->utente_us = campione->sistema_us = -1;
+    if (leggi_controllo(cgroup->percorso, "cpu.stat", buffer, sizeof(buffer)) > 0)
+    {
+        for (char *riga = strtok(buffer, "\n"); riga != NULL; riga = strtok(NULL, "\n"))
+        {
+            sscanf(riga, "usage_usec %lld", &campione->cpu_us);
+            sscanf(riga, "user_usec %lld", &campione->utente_us);
+            sscanf(riga, "system_usec %lld", &campione->sistema_us);
+        }
+    }
+
+    campione->memoria_byte = leggi_valore(cgroup->percorso, "memory.current");
+    campione->processi = leggi_valore(cgroup->percorso, "pids.current");
+    campione->processi_rifiutati = -1;
+    if (leggi_controllo(cgroup->percorso, "pids.events", buffer, sizeof(buffer)) > 0)
+    {
+        sscanf(buffer, "max %lld", &campione->processi_rifiutati);
+    }
+
+    campione->pressione_cpu = leggi_pressione(cgroup->percorso, "cpu.pressure");
+    campione->pressione_memoria = leggi_pressione(cgroup->percorso, "memory.pressure");
+    campione->pressione_io = leggi_pressione(cgroup->percorso, "io.pressure");
+}
+
+void esci_cgroup(cgroup_reattore *cgroup)
+{
+    if (cgroup->percorso[0] == '\0')
+    {
+        return;
+    }
+    if (scrivi_controllo(cgroup->origine, "cgroup.procs", "0") == -1)
+    {
+        fprintf(stderr, "cgroup: impossibile tornare in %s: %s\n", cgroup->origine, strerror(errno));
+        return;
+    }
+    // Gli ultimi processi raccolti possono risultare nel cgroup ancora per un istante
+    for (int tentativi = 0; rmdir(cgroup->percorso) == -1; tentativi++)
+    {
+        if (errno != EBUSY || tentativi == 100)
+        {
+            fprintf(stderr, "cgroup: impossibile rimuovere %s: %s\n", cgroup->percorso, strerror(errno));
+            return;
+        }
+        usleep(10000);
+    }
+    cgroup->percorso[0] = '\0';
+}
@@ -0,0 +1,84 @@
+/**
+ * @file cgroup.h
+ * @brief Sottoalbero cgroup v2 della simulazione e lettura del suo consumo di risorse.
+ *
+ * Con la variabile d'ambiente `REATTORE_CGROUP` il master crea un cgroup figlio, vi si sposta
+ * prima di generare qualsiasi processo (così tutti i discendenti lo ereditano) e a ogni tick ne
+ * legge cpu.stat, memory.current, pids.current e la pressione (PSI). Il valore della variabile è
+ * il cgroup delegato in cui creare il sottoalbero, oppure `1` per usare quello corrente del
+ * master. I controller memory e pids sono abilitati nel padre solo se la delega lo consente:
+ * i file che mancano vengono riportati come non disponibili.
+ */
+
+#ifndef CGROUP_H
+#define CGROUP_H
+
+#include <limits.h>
+
+/**
+ * @brief Variabile d'ambiente che attiva il sottoalbero cgroup: `1` o il percorso di un cgroup delegato.
+ */
+#define VARIABILE_CGROUP "REATTORE_CGROUP"
+
+/**
+ * @brief Variabile d'ambiente con il limite rigido di processi (pids.max) del sottoalbero.
+ */
+#define VARIABILE_PIDS_MAX "REATTORE_PIDS_MAX"
+
+/**
+ * @struct cgroup_reattore_
+ * @brief Cgroup della simulazione e cgroup di partenza del master.
+ */
+typedef struct cgroup_reattore_
+{
+    char percorso[PATH_MAX];
+    char origine[PATH_MAX];
+    long pids_max; // -1 se senza limite
+} cgroup_reattore;
+
+/**
+ * @struct campione_cgroup_
+ * @brief Un campione dei contatori del cgroup; -1 per i valori non disponibili.
+ */
+typedef struct campione_cgroup_
+{
+    long long cpu_us;
+    long long utente_us;
+    long long sistema_us;
+    long long memoria_byte;
+    long long processi;
+    long long processi_rifiutati; // Fork rifiutate per pids.max (pids.events)
+    double pressione_cpu;         // Percentuale "some" media sugli ultimi 10 secondi
+    double pressione_memoria;
+    double pressione_io;
+} campione_cgroup;
+
+/**
+ * @brief Crea il cgroup della simulazione e vi sposta il processo chiamante.
+ *
+ * @param cgroup Cgroup da inizializzare
+ * @param padre Percorso del cgroup delegato, oppure `1` per il cgroup corrente
+ * @param istanza Istanza del reattore, usata nel nome del cgroup
+ * @param pids_max Limite di processi da impostare, -1 per nessuno
+ * @return 0 se il processo è nel nuovo cgroup, -1 altrimenti (il motivo è già stampato)
+ */
+int entra_cgroup(cgroup_reattore *cgroup, const char *padre, int istanza, long pids_max);
+
+/**
+ * @brief Legge i contatori correnti del cgroup.
+ *
+ * @param cgroup Cgroup della simulazione
+ * @param campione Campione da compilare
+ */
+void campiona_cgroup(const cgroup_reattore *cgroup, campione_cgroup *campione);
+
+/**
+ * @brief Riporta il processo chiamante nel cgroup di partenza e rimuove quello della simulazione.
+ *
+ * Va chiamata dopo aver raccolto tutti i discendenti: un cgroup con processi non può essere rimosso.
+ *
+ * @param cgroup Cgroup della simulazione
+ */
+void esci_cgroup(cgroup_reattore *cgroup);
+
+#endif
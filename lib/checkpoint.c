@@ -0,0 +1,139 @@
+/**
+ * @file checkpoint.c
+ * @brief Implementazione del salvataggio e del ripristino dello stato del reattore.
+ */
+
+#include <stdio.h>
+#include <stddef.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include "checkpoint.h"
+
+/**
+ * @brief Parte del segmento salvata così com'è: tutto tranne l'istogramma della popolazione.
+ */
+#define DIMENSIONE_SEGMENTO offsetof(shmseg2, popolazione)
+
+/**
+ * @brief Scrive tutto il buffer, ripetendo le scritture parziali.
+ */
+static int scrivi_tutto(int fd, const void *buffer, size_t dimensione)
+{
+    const char *p = buffer;
+    while (dimensione > 0)
+    {
+        ssize_t scritti = write(fd, p, dimensione);
+        if (scritti <= 0)
+        {
+            return -1;
+        }
+        p += scritti;
+        dimensione -= scritti;
+    }
+    return 0;
+}
+
+static int leggi_tutto(int fd, void *buffer, size_t dimensione)
+{
+    char *p = buffer;
+    while (dimensione > 0)
+    {
+        ssize_t letti = read(fd, p, dimensione);
+        if (letti <= 0)
+        {
+            return -1;
+        }
+        p += letti;
+        dimensione -= letti;
+    }
+    return 0;
+}
+
+int scrivi_checkpoint(const char *percorso, const contatori_master *contatori, const shmseg2 *memoria2)
+{
+    // Istantanea dell'istogramma: gli atomi continuano ad aggiornarlo durante la scrittura
+    int coppie[N_ATOMICO_MAX][2];
+    int n_coppie = 0, atomi = 0;
+    for (int n = 1; n < N_ATOMICO_MAX; n++)
+    {
+        int quanti = __atomic_load_n(&memoria2->popolazione[n], __ATOMIC_RELAXED);
+        if (quanti > 0)
+        {
+            coppie[n_coppie][0] = n;
+            coppie[n_coppie][1] = quanti;
+            n_coppie++;
+            atomi += quanti;
+        }
+    }
+
+    intestazione_checkpoint intestazione;
+    memset(&intestazione, 0, sizeof(intestazione));
+    intestazione.magic = CHECKPOINT_MAGIC;
+    intestazione.versione = CHECKPOINT_VERSIONE;
+    intestazione.dimensione_segmento = DIMENSIONE_SEGMENTO;
+    intestazione.n_coppie = n_coppie;
+    intestazione.contatori = *contatori;
+
+    int fd = open(percorso, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd == -1)
+    {
+        return -1;
+    }
+    int esito = scrivi_tutto(fd, &intestazione, sizeof(intestazione));
+    if (esito == 0)
+    {
+        esito = scrivi_tutto(fd, memoria2, DIMENSIONE_SEGMENTO);
+    }
+    if (esito == 0)
+    {
+        esito = scrivi_tutto(fd, coppie, sizeof(int) * 2 * n_coppie);
+    }
+    close(fd);
+    return esito == 0 ? atomi : -1;
+}
+
+int leggi_checkpoint(const char *percorso, contatori_master *contatori, shmseg2 *memoria2, int *popolazione)
+{
+    intestazione_checkpoint intestazione;
+    int fd = open(percorso, O_RDONLY);
+    if (fd == -1)
+    {
+        perror("Errore nell'aprire il checkpoint");
+        return -1;
+    }
+
+    if (leggi_tutto(fd, &intestazione, sizeof(intestazione)) == -1 ||
+        intestazione.magic != CHECKPOINT_MAGIC || intestazione.versione != CHECKPOINT_VERSIONE ||
+        intestazione.dimensione_segmento != DIMENSIONE_SEGMENTO || intestazione.n_coppie > N_ATOMICO_MAX)
+    {
+        fprintf(stderr, "%s non è un checkpoint compatibile con questa versione\n", percorso);
+        close(fd);
+        return -1;
+    }
+
+    if (leggi_tutto(fd, memoria2, DIMENSIONE_SEGMENTO) == -1)
+    {
+        fprintf(stderr, "Checkpoint %s troncato\n", percorso);
+        close(fd);
+        return -1;
+    }
+
+    memset(popolazione, 0, sizeof(int) * N_ATOMICO_MAX);
+    memset(memoria2->popolazione, 0, sizeof(memoria2->popolazione));
+    for (uint32_t i = 0; i < intestazione.n_coppie; i++)
+    {
+        int coppia[2];
+        if (leggi_tutto(fd, coppia, sizeof(coppia)) == -1 || coppia[0] <= 0 || coppia[0] >= N_ATOMICO_MAX)
+        {
+            fprintf(stderr, "Checkpoint %s troncato\n", percorso);
+            close(fd);
+            return -1;
+        }
+        popolazione[coppia[0]] = coppia[1];
+    }
+    close(fd);
+
+    *contatori = intestazione.contatori;
+    return 0;
+}
@@ -0,0 +1,82 @@
+/**
+ * @file checkpoint.h
+ * @brief Salvataggio e ripristino dello stato di un reattore in esecuzione.
+ *
+ * Il checkpoint contiene i contatori del master, il segmento `shmseg2` (con il seme e il
+ * numero di estrazioni del generatore casuale) e la popolazione di atomi vivi come coppie
+ * (numero atomico, quantità). Il ripristino ricrea gli atomi e riprende dal tick salvato.
+ */
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stdint.h>
+#include "shared_memory.h"
+
+/**
+ * @brief Variabile d'ambiente con il percorso del checkpoint; se assente si usa `build/checkpoint_<istanza>.bin`.
+ */
+#define VARIABILE_CHECKPOINT "REATTORE_CHECKPOINT"
+
+/**
+ * @brief Identifica i file di checkpoint ("RCKP").
+ */
+#define CHECKPOINT_MAGIC 0x504b4352u
+
+/**
+ * @brief Versione del formato: va incrementata a ogni modifica di `shmseg2` o dell'intestazione.
+ */
+#define CHECKPOINT_VERSIONE 2
+
+/**
+ * @struct contatori_master_
+ * @brief Contatori del master salvati nel checkpoint.
+ */
+typedef struct contatori_master_
+{
+    int tempo_passato;
+    int num_scissioni;
+    int num_scorie;
+    int num_attivazioni;
+} contatori_master;
+
+/**
+ * @struct intestazione_checkpoint_
+ * @brief Intestazione del file, seguita dal segmento e dalle coppie della popolazione.
+ */
+typedef struct intestazione_checkpoint_
+{
+    uint32_t magic;
+    uint32_t versione;
+    uint32_t dimensione_segmento;
+    uint32_t n_coppie;
+    contatori_master contatori;
+} intestazione_checkpoint;
+
+/**
+ * @brief Scrive un checkpoint.
+ *
+ * Usa solo chiamate sicure nei gestori dei segnali, così da poter essere eseguita dal tick del master.
+ *
+ * @param percorso File da scrivere
+ * @param contatori Contatori del master
+ * @param memoria2 Memoria condivisa della simulazione
+ * @return Il numero di atomi vivi salvati, -1 in caso di errore
+ */
+int scrivi_checkpoint(const char *percorso, const contatori_master *contatori, const shmseg2 *memoria2);
+
+/**
+ * @brief Legge un checkpoint.
+ *
+ * Il segmento letto sostituisce `memoria2`; l'istogramma della popolazione viene restituito a parte
+ * in `popolazione` e azzerato in `memoria2`, perché gli atomi ricreati si registrano da soli.
+ *
+ * @param percorso File da leggere
+ * @param contatori Contatori del master
+ * @param memoria2 Memoria condivisa della simulazione
+ * @param popolazione Vettore di N_ATOMICO_MAX elementi con il numero di atomi vivi per numero atomico
+ * @return 0 in caso di successo, -1 se il file manca o non è compatibile
+ */
+int leggi_checkpoint(const char *percorso, contatori_master *contatori, shmseg2 *memoria2, int *popolazione);
+
+#endif
@@ -15,6 +15,7 @@
 #include <sys/msg.h>
 #include <unistd.h>
 #include "code.h"
+#include "istanza.h"
 
 #define DEFAULT_TYPE 1
 /**
@@ -32,15 +33,36 @@ struct mymsg
 /**
  * @brief Crea una nuova coda di messaggi.
  *
- * Genera una coda di messaggi utilizzando il percorso specificato per ottenere una chiave IPC.
+ * Genera una coda di messaggi utilizzando il percorso e l'istanza specificati per ottenere una chiave IPC.
+ * Se la coda esiste già, un'altra istanza con lo stesso identificativo è in esecuzione (o è terminata
+ * senza rimuovere i propri oggetti IPC) e il programma termina.
  *
  * @param pathname Percorso utilizzato per ottenere la chiave della coda di messaggi
+ * @param istanza Identificativo dell'istanza del reattore
  * @return L'identificatore della coda in caso di successo, termina il programma in caso di errore
  */
-int create_queue(char *pathname)
+int create_queue(char *pathname, int istanza)
 {
-    key_t key = ftok(pathname, 'x');
-    int id = msgget(key, IPC_CREAT | 0666);
+    key_t key = chiave_ipc(pathname, istanza);
+    int id = msgget(key, IPC_CREAT | IPC_EXCL | 0666);
+    if (id == -1)
+    {
+        if (errno == EEXIST)
+        {
+            fprintf(stderr, "Coda di messaggi dell'istanza %d già esistente: istanza in uso o non rimossa (ipcrm)\n", istanza);
+        }
+        else
+        {
+            perror("msgget error");
+        }
+        exit(EXIT_FAILURE);
+    }
+    return id;
+}
+
+int create_private_queue()
+{
+    int id = msgget(IPC_PRIVATE, IPC_CREAT | 0600);
     if (id == -1)
     {
         perror("msgget error");
@@ -49,6 +71,70 @@ int create_queue(char *pathname)
     return id;
 }
 
+/**
+ * @brief Legge il limite di sistema `msgmnb`, 0 se non è leggibile.
+ */
+static unsigned long limite_msgmnb()
+{
+    unsigned long limite = 0;
+    FILE *file = fopen("/proc/sys/kernel/msgmnb", "r");
+    if (file != NULL)
+    {
+        if (fscanf(file, "%lu", &limite) != 1)
+        {
+            limite = 0;
+        }
+        fclose(file);
+    }
+    return limite;
+}
+
+unsigned long imposta_capacita_coda(int id, unsigned long byte)
+{
+    struct msqid_ds stato;
+    if (msgctl(id, IPC_STAT, &stato) == -1)
+    {
+        perror("msgctl error");
+        exit(EXIT_FAILURE);
+    }
+    if (stato.msg_qbytes == byte)
+    {
+        return byte;
+    }
+
+    stato.msg_qbytes = byte;
+    if (msgctl(id, IPC_SET, &stato) == -1)
+    {
+        // Oltre msgmnb serve CAP_SYS_RESOURCE: si ripiega sul massimo consentito
+        unsigned long limite = limite_msgmnb();
+        if (errno != EPERM || limite == 0 || limite >= byte)
+        {
+            perror("msgctl IPC_SET error");
+            exit(EXIT_FAILURE);
+        }
+        stato.msg_qbytes = limite;
+        if (msgctl(id, IPC_SET, &stato) == -1)
+        {
+            perror("msgctl IPC_SET error");
+            exit(EXIT_FAILURE);
+        }
+    }
+    return stato.msg_qbytes;
+}
+
+int leggi_stato_coda(int id, stato_coda *stato)
+{
+    struct msqid_ds ds;
+    if (msgctl(id, IPC_STAT, &ds) == -1)
+    {
+        return -1;
+    }
+    stato->messaggi = ds.msg_qnum;
+    stato->byte = ds.__msg_cbytes;
+    stato->capacita = ds.msg_qbytes;
+    return 0;
+}
+
 /**
  * @brief Legge un messaggio dalla coda con il tipo di default.
  *
@@ -9,15 +9,56 @@
 #ifndef QUEUE_H
 #define QUEUE_H
 
+/**
+ * @struct stato_coda_
+ * @brief Occupazione di una coda letta con IPC_STAT.
+ */
+typedef struct stato_coda_
+{
+    unsigned long messaggi;
+    unsigned long byte;
+    unsigned long capacita;
+} stato_coda;
+
 /**
  * @brief Crea una nuova coda di messaggi.
  *
- * Genera una coda di messaggi utilizzando il percorso specificato per ottenere una chiave IPC.
+ * Genera una coda di messaggi utilizzando il percorso e l'istanza specificati per ottenere una chiave IPC.
+ * La coda non deve esistere già.
  *
  * @param pathname Percorso utilizzato per ottenere la chiave della coda di messaggi
+ * @param istanza Identificativo dell'istanza del reattore
  * @return L'identificatore della coda in caso di successo, -1 in caso di errore
  */
-int create_queue(char *pathname);
+int create_queue(char *pathname, int istanza);
+
+/**
+ * @brief Crea una coda di messaggi privata, raggiungibile solo tramite il suo identificatore.
+ *
+ * @return L'identificatore della coda, termina il programma in caso di errore
+ */
+int create_private_queue();
+
+/**
+ * @brief Porta la capacità della coda (msg_qbytes) al valore richiesto, se consentito.
+ *
+ * Senza CAP_SYS_RESOURCE la capacità non può superare `msgmnb` (/proc/sys/kernel/msgmnb):
+ * in quel caso la richiesta viene ridotta a `msgmnb`.
+ *
+ * @param id Identificatore della coda di messaggi
+ * @param byte Capacità richiesta in byte
+ * @return La capacità effettiva della coda in byte
+ */
+unsigned long imposta_capacita_coda(int id, unsigned long byte);
+
+/**
+ * @brief Legge messaggi presenti, byte occupati e capacità di una coda.
+ *
+ * @param id Identificatore della coda di messaggi
+ * @param stato Stato da compilare
+ * @return 0 in caso di successo, -1 in caso di errore
+ */
+int leggi_stato_coda(int id, stato_coda *stato);
 
 /**
  * @brief Legge un messaggio dalla coda.
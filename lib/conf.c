@@ -1,7 +1,10 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sched.h>
+#include <unistd.h>
 #include "conf.h"
+#include "shared_memory.h"
 
 SimulationParams read_params_from_file(const char *filename)
 {
@@ -15,6 +18,7 @@ SimulationParams read_params_from_file(const char *filename)
     }
 
     char line[256];
+    char politica[16];
 
     while (fgets(line, sizeof(line), file))
     {
@@ -63,8 +67,174 @@ SimulationParams read_params_from_file(const char *filename)
         {
             continue;
         }
+        if (sscanf(line, "TEARDOWN_DEADLINE_MS = %ld", &params.teardown_deadline_ms) == 1)
+        {
+            continue;
+        }
+        if (sscanf(line, "TEARDOWN_GRAZIA_MS = %ld", &params.teardown_grazia_ms) == 1)
+        {
+            continue;
+        }
+        if (sscanf(line, "MAX_ATOMI_ATTIVI = %d", &params.max_atomi_attivi) == 1)
+        {
+            continue;
+        }
+        if (sscanf(line, "ATOMI_PER_CPU = %d", &params.atomi_per_cpu) == 1)
+        {
+            continue;
+        }
+        if (sscanf(line, "SOGLIA_MELTDOWN = %d", &params.soglia_meltdown) == 1)
+        {
+            continue;
+        }
+        if (sscanf(line, "CODA_RITENTATIVI = %d", &params.coda_ritentativi) == 1)
+        {
+            continue;
+        }
+        if (sscanf(line, "RITENTATIVO_BASE_MS = %ld", &params.ritentativo_base_ms) == 1)
+        {
+            continue;
+        }
+        if (sscanf(line, "CPU_MASTER = %63s", params.cpu_master) == 1)
+        {
+            continue;
+        }
+        if (sscanf(line, "CPU_ATTIVATORE = %63s", params.cpu_attivatore) == 1)
+        {
+            continue;
+        }
+        if (sscanf(line, "CPU_INIBITORE = %63s", params.cpu_inibitore) == 1)
+        {
+            continue;
+        }
+        if (sscanf(line, "CPU_ATOMI = %63s", params.cpu_atomi) == 1)
+        {
+            continue;
+        }
+        if (sscanf(line, "POLITICA_ATOMI = %15s", politica) == 1)
+        {
+            if (strcmp(politica, "BATCH") == 0)
+            {
+                params.politica_atomi = SCHED_BATCH;
+            }
+            else if (strcmp(politica, "IDLE") == 0)
+            {
+                params.politica_atomi = SCHED_IDLE;
+            }
+            else if (strcmp(politica, "NORMALE") == 0)
+            {
+                params.politica_atomi = SCHED_OTHER;
+            }
+            else
+            {
+                fprintf(stderr, "POLITICA_ATOMI non valida: %s (usa NORMALE, BATCH o IDLE)\n", politica);
+                exit(EXIT_FAILURE);
+            }
+            continue;
+        }
+        if (sscanf(line, "NICE_ATOMI = %d", &params.nice_atomi) == 1)
+        {
+            continue;
+        }
+        if (sscanf(line, "SEME = %llu", &params.seme) == 1)
+        {
+            continue;
+        }
+        if (sscanf(line, "CHECKPOINT_TEMPO = %d", &params.checkpoint_tempo) == 1)
+        {
+            continue;
+        }
+        if (sscanf(line, "FREQUENZA_INIBITORE = %d", &params.frequenza_inibitore) == 1)
+        {
+            continue;
+        }
+        if (sscanf(line, "BYTE_CODA = %d", &params.byte_coda) == 1)
+        {
+            continue;
+        }
+        if (sscanf(line, "ARENA_LIGNAGGI = %d", &params.arena_lignaggi) == 1)
+        {
+            continue;
+        }
+        if (sscanf(line, "N_OSPITI = %d", &params.n_ospiti) == 1)
+        {
+            continue;
+        }
     }
 
     fclose(file);
+
+    // L'istogramma della popolazione, il checkpoint e il ripristino hanno una classe per numero atomico
+    if (params.n_atom_max >= N_ATOMICO_MAX)
+    {
+        fprintf(stderr, "Errore: N_ATOM_MAX = %d, il massimo è %d\n", params.n_atom_max, N_ATOMICO_MAX - 1);
+        exit(EXIT_FAILURE);
+    }
+
+    // Parametri facoltativi: se assenti si usano i valori predefiniti
+    if (params.teardown_deadline_ms <= 0)
+    {
+        params.teardown_deadline_ms = TEARDOWN_DEADLINE_MS_DEFAULT;
+    }
+    if (params.teardown_grazia_ms < 0)
+    {
+        params.teardown_grazia_ms = 0;
+    }
+    if (params.atomi_per_cpu <= 0)
+    {
+        params.atomi_per_cpu = ATOMI_PER_CPU_DEFAULT;
+    }
+    if (params.soglia_meltdown <= 0)
+    {
+        params.soglia_meltdown = SOGLIA_MELTDOWN_DEFAULT;
+    }
+    if (params.coda_ritentativi <= 0)
+    {
+        params.coda_ritentativi = CODA_RITENTATIVI_DEFAULT;
+    }
+    if (params.ritentativo_base_ms <= 0)
+    {
+        params.ritentativo_base_ms = RITENTATIVO_BASE_MS_DEFAULT;
+    }
+    if (params.frequenza_inibitore <= 0)
+    {
+        params.frequenza_inibitore = FREQUENZA_INIBITORE_DEFAULT;
+    }
+    else if (params.frequenza_inibitore > FREQUENZA_INIBITORE_MAX)
+    {
+        params.frequenza_inibitore = FREQUENZA_INIBITORE_MAX;
+    }
+    if (params.byte_coda <= 0)
+    {
+        params.byte_coda = BYTE_CODA_DEFAULT;
+    }
+    if (params.arena_lignaggi <= 0)
+    {
+        params.arena_lignaggi = ARENA_LIGNAGGI_DEFAULT;
+    }
+    // 0 (predefinito) mantiene un processo per atomo
+    if (params.n_ospiti == OSPITI_PER_CPU)
+    {
+        long cpu = sysconf(_SC_NPROCESSORS_ONLN);
+        params.n_ospiti = cpu > 0 ? cpu : 1;
+    }
+    if (params.n_ospiti < 0)
+    {
+        params.n_ospiti = 0;
+    }
+    else if (params.n_ospiti > N_OSPITI_MAX)
+    {
+        params.n_ospiti = N_OSPITI_MAX;
+    }
     return params;
 }
+
+const char *percorso_configurazione()
+{
+    const char *percorso = getenv(VARIABILE_CONFIGURAZIONE);
+    if (percorso == NULL || percorso[0] == '\0')
+    {
+        return CONFIGURAZIONE_DEFAULT;
+    }
+    return percorso;
+}
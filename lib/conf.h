@@ -19,8 +19,92 @@ typedef struct
     int sim_duration;
     int energy_explode_threshold;
     long long step;
+    long teardown_deadline_ms;
+    long teardown_grazia_ms;
+    int max_atomi_attivi;
+    int atomi_per_cpu;
+    int soglia_meltdown;
+    int coda_ritentativi;
+    long ritentativo_base_ms;
+    char cpu_master[64];
+    char cpu_attivatore[64];
+    char cpu_inibitore[64];
+    char cpu_atomi[64];
+    int politica_atomi;
+    int nice_atomi;
+    unsigned long long seme;
+    int checkpoint_tempo;
+    int frequenza_inibitore;
+    int byte_coda;
+    int arena_lignaggi;
+    int n_ospiti;
 } SimulationParams;
 
+/**
+ * @brief Scadenza predefinita (in millisecondi) per l'arresto dei processi a fine simulazione.
+ */
+#define TEARDOWN_DEADLINE_MS_DEFAULT 2000
+
+/**
+ * @brief Atomi attivi ammessi per CPU quando MAX_ATOMI_ATTIVI non è impostato.
+ */
+#define ATOMI_PER_CPU_DEFAULT 1000
+
+/**
+ * @brief Fork fallite consecutive, in tutto il reattore, oltre le quali si dichiara MELTDOWN.
+ */
+#define SOGLIA_MELTDOWN_DEFAULT 50
+
+/**
+ * @brief Capacità della coda dei ritentativi dell'alimentazione.
+ */
+#define CODA_RITENTATIVI_DEFAULT 64
+
+/**
+ * @brief Attesa (in millisecondi) prima del primo ritentativo, raddoppiata a ogni fallimento.
+ */
+#define RITENTATIVO_BASE_MS_DEFAULT 10
+
+/**
+ * @brief Passi al secondo del ciclo di controllo dell'inibitore, e loro massimo.
+ */
+#define FREQUENZA_INIBITORE_DEFAULT 100
+#define FREQUENZA_INIBITORE_MAX 1000
+
+/**
+ * @brief Capacità in byte (msg_qbytes) richiesta per ogni coda di messaggi.
+ */
+#define BYTE_CODA_DEFAULT (1024 * 1024)
+
+/**
+ * @brief Archi dell'arena dei lignaggi di scissione (16 byte ciascuno, 16 MiB).
+ */
+#define ARENA_LIGNAGGI_DEFAULT (1 << 20)
+
+/**
+ * @brief Valore di N_OSPITI che chiede un processo ospite per CPU.
+ */
+#define OSPITI_PER_CPU -1
+
+/**
+ * @brief File di configurazione predefinito.
+ */
+#define CONFIGURAZIONE_DEFAULT "conf/config.txt"
+
+/**
+ * @brief Variabile d'ambiente che seleziona un file di configurazione diverso da quello predefinito.
+ *
+ * Viene ereditata da tutti i processi del reattore.
+ */
+#define VARIABILE_CONFIGURAZIONE "REATTORE_CONF"
+
 SimulationParams read_params_from_file(const char *filename);
 
+/**
+ * @brief Restituisce il percorso del file di configurazione da usare.
+ *
+ * @return Il valore di `REATTORE_CONF` se impostata, altrimenti `CONFIGURAZIONE_DEFAULT`
+ */
+const char *percorso_configurazione();
+
 #endif
@@ -0,0 +1,140 @@
+/**
+ * @file eventi.c
+ * @brief Implementazione dell'invio e dello smistamento dei record di evento.
+ */
+
+#include <sys/msg.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "eventi.h"
+
+// Byte del record dopo `mtype`, come richiesto da msgsnd e msgrcv
+#define DIMENSIONE_RECORD (sizeof(record_evento) - sizeof(long))
+
+record_evento nuovo_record(int tipo)
+{
+    record_evento record;
+    struct timespec adesso;
+    memset(&record, 0, sizeof(record));
+    clock_gettime(CLOCK_MONOTONIC, &adesso);
+
+    record.mtype = tipo;
+    record.versione = RECORD_VERSIONE;
+    record.tipo = tipo;
+    record.pid = getpid();
+    record.genitore = getppid();
+    record.tempo_ns = adesso.tv_sec * 1000000000LL + adesso.tv_nsec;
+    return record;
+}
+
+int invia_record(int queue, const record_evento *record)
+{
+    // Il primo tentativo non blocca, così un invio con la coda piena viene contato
+    if (msgsnd(queue, record, DIMENSIONE_RECORD, IPC_NOWAIT) == 0)
+    {
+        return 0;
+    }
+    if (errno != EAGAIN && errno != EINTR)
+    {
+        perror("msgsend error");
+        exit(EXIT_FAILURE);
+    }
+    int piena = errno == EAGAIN;
+    while (msgsnd(queue, record, DIMENSIONE_RECORD, 0) < 0)
+    {
+        if (errno != EINTR)
+        {
+            perror("msgsend error");
+            exit(EXIT_FAILURE);
+        }
+    }
+    return piena;
+}
+
+int coda_record(const record_evento *record)
+{
+    switch (record->tipo)
+    {
+    case RECORD_NASCITA:
+    case RECORD_ATTIVAZIONE:
+    case RECORD_TERMINAZIONE:
+        return CODA_CONTROLLO;
+    default:
+        return 1 + getpid() % N_CODE_ATOMI;
+    }
+}
+
+void pubblica_record(shmseg *memoria, shmseg2 *memoria2, const record_evento *record)
+{
+    int coda = coda_record(record);
+    int piena = invia_record(memoria->id_code[coda], record);
+    __atomic_fetch_add(&memoria2->code.inviati[coda], 1, __ATOMIC_RELAXED);
+    if (piena)
+    {
+        __atomic_fetch_add(&memoria2->code.bloccati[coda], 1, __ATOMIC_RELAXED);
+    }
+}
+
+int consuma_record(int queue, const gestore_evento gestori[N_TIPI_RECORD], int massimo, statistiche_record *statistiche)
+{
+    record_evento record;
+    int letti = 0;
+
+    while (massimo == 0 || letti < massimo)
+    {
+        // Tipo 0: il primo record in coda, di qualunque tipo
+        if (msgrcv(queue, &record, DIMENSIONE_RECORD, 0, IPC_NOWAIT) == -1)
+        {
+            if (errno == ENOMSG)
+            {
+                break;
+            }
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            perror("msgrcv error");
+            exit(EXIT_FAILURE);
+        }
+        letti++;
+
+        if (record.versione != RECORD_VERSIONE || record.tipo >= N_TIPI_RECORD || gestori[record.tipo] == NULL)
+        {
+            statistiche->scartati++;
+            continue;
+        }
+        statistiche->ricevuti[record.tipo]++;
+        statistiche->messaggi_equivalenti += messaggi_equivalenti(&record);
+        gestori[record.tipo](&record);
+    }
+    return letti;
+}
+
+const char *nome_record(int tipo)
+{
+    static const char *nomi[N_TIPI_RECORD] = {"SCONOSCIUTO", "NASCITA", "SCISSIONE", "SCORIA", "ATTIVAZIONE", "TERMINAZIONE"};
+    if (tipo <= 0 || tipo >= N_TIPI_RECORD)
+    {
+        return nomi[0];
+    }
+    return nomi[tipo];
+}
+
+int messaggi_equivalenti(const record_evento *record)
+{
+    switch (record->tipo)
+    {
+    case RECORD_SCISSIONE:
+        return record->valore == SCORIA_SENZA_PROCESSO ? 5 : 3;
+    case RECORD_SCORIA:
+        return record->valore == SCORIA_SENZA_PROCESSO ? 3 : 2;
+    case RECORD_TERMINAZIONE:
+        return record->delta_atomi != 0 ? 2 : 1;
+    default:
+        return 1;
+    }
+}
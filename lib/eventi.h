@@ -0,0 +1,148 @@
+/**
+ * @file eventi.h
+ * @brief Record di evento scambiati sulla coda di messaggi del reattore.
+ *
+ * Ogni record descrive un intero accadimento con un solo invio: tipo, processo che lo genera e
+ * suo genitore, numeri atomici, energia, variazione degli atomi attivi e istante. Una scissione,
+ * che prima richiedeva un messaggio per la scissione, uno per l'energia e uno per il +1 del
+ * figlio, è così un solo record. Il tipo del record è anche il tipo SysV del messaggio.
+ *
+ * Chi consuma la coda registra una tabella di gestori indicizzata per tipo di record invece di
+ * interrogare la coda tipo per tipo.
+ *
+ * I record viaggiano su più code (vedi `N_CODE`): i processi di controllo e le terminazioni usano
+ * la coda di controllo, che il master legge per prima, gli atomi una delle code degli atomi scelta
+ * in base al proprio PID. Una coda piena blocca così solo il proprio gruppo di produttori, e i
+ * record di uno stesso atomo restano ordinati.
+ */
+
+#ifndef EVENTI_H
+#define EVENTI_H
+
+#include <stdint.h>
+#include "shared_memory.h"
+
+/**
+ * @brief Versione del formato: i record con una versione diversa vengono scartati.
+ */
+#define RECORD_VERSIONE 1
+
+/**
+ * @brief Tipi di record.
+ */
+#define RECORD_NASCITA 1      // Un atomo creato dall'alimentazione
+#define RECORD_SCISSIONE 2    // Una scissione riuscita: figlio, energia e +1 atomo
+#define RECORD_SCORIA 3       // Un atomo diventato scoria, che termina
+#define RECORD_ATTIVAZIONE 4  // Un'attivazione dell'attivatore
+#define RECORD_TERMINAZIONE 5 // Causa di terminazione della simulazione in `valore`
+#define N_TIPI_RECORD 6
+
+/**
+ * @brief Valore di una scissione o di una scoria il cui atomo, già sotto MIN_N_ATOMICO, è stato
+ * contato come scoria da chi lo avrebbe generato, senza avviare un processo (`delta_atomi` è 0).
+ */
+#define SCORIA_SENZA_PROCESSO 1
+
+/**
+ * @struct record_evento_
+ * @brief Un record di evento. `mtype` precede il contenuto come richiesto da msgsnd.
+ */
+typedef struct record_evento_
+{
+    long mtype;
+    uint8_t versione;
+    uint8_t tipo;
+    int16_t delta_atomi;
+    int32_t pid;
+    int32_t genitore;
+    int32_t n_atomico;
+    int32_t n_atomico_figlio;
+    int32_t energia;
+    int32_t valore;
+    int64_t tempo_ns;
+} record_evento;
+
+/**
+ * @brief Gestore di un tipo di record nella tabella di chi consuma la coda.
+ */
+typedef void (*gestore_evento)(const record_evento *record);
+
+/**
+ * @struct statistiche_record_
+ * @brief Record ricevuti per tipo, record scartati perché di versione o tipo sconosciuti e
+ * messaggi che i record ricevuti avrebbero richiesto con un intero per messaggio.
+ */
+typedef struct statistiche_record_
+{
+    long long ricevuti[N_TIPI_RECORD];
+    long long scartati;
+    long long messaggi_equivalenti;
+} statistiche_record;
+
+/**
+ * @brief Prepara un record del tipo indicato per il processo chiamante.
+ *
+ * Imposta versione, tipo, PID, PID del genitore e istante (CLOCK_MONOTONIC); gli altri campi sono a zero.
+ *
+ * @param tipo Tipo di record
+ * @return Il record da completare e inviare
+ */
+record_evento nuovo_record(int tipo);
+
+/**
+ * @brief Invia un record alla coda, bloccando se la coda è piena.
+ *
+ * @param queue Identificatore della coda di messaggi
+ * @param record Record da inviare
+ * @return 1 se la coda era piena e l'invio ha dovuto attendere, 0 altrimenti
+ */
+int invia_record(int queue, const record_evento *record);
+
+/**
+ * @brief Coda del reattore su cui viaggia un record inviato dal processo chiamante.
+ *
+ * @param record Record da inviare
+ * @return `CODA_CONTROLLO` per nascite, attivazioni e terminazioni, altrimenti una coda degli atomi
+ */
+int coda_record(const record_evento *record);
+
+/**
+ * @brief Invia un record sulla sua coda del reattore e ne aggiorna le statistiche di invio.
+ *
+ * @param memoria Memoria condivisa degli identificatori
+ * @param memoria2 Memoria condivisa della simulazione
+ * @param record Record da inviare
+ */
+void pubblica_record(shmseg *memoria, shmseg2 *memoria2, const record_evento *record);
+
+/**
+ * @brief Legge e smista i record presenti nella coda senza bloccare.
+ *
+ * Ogni record viene passato al gestore del suo tipo; i tipi senza gestore vengono contati e ignorati.
+ *
+ * @param queue Identificatore della coda di messaggi
+ * @param gestori Tabella dei gestori, indicizzata per tipo di record
+ * @param massimo Numero massimo di record da leggere, 0 per svuotare la coda
+ * @param statistiche Contatori dei record ricevuti e scartati
+ * @return Il numero di record letti
+ */
+int consuma_record(int queue, const gestore_evento gestori[N_TIPI_RECORD], int massimo, statistiche_record *statistiche);
+
+/**
+ * @brief Nome leggibile di un tipo di record.
+ */
+const char *nome_record(int tipo);
+
+/**
+ * @brief Messaggi che un record sostituisce nel formato con un intero per messaggio.
+ *
+ * Una scissione valeva tre messaggi (scissione, energia e +1 del figlio), una scoria due
+ * (-1 atomo e scoria), una terminazione da un atomo due (-1 atomo e causa). Una scoria senza
+ * processo aggiunge il +1 e il -1 dell'atomo che sarebbe nato e la scoria che avrebbe inviato.
+ *
+ * @param record Record ricevuto
+ * @return Il numero di messaggi equivalenti
+ */
+int messaggi_equivalenti(const record_evento *record);
+
+#endif
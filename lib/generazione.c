@@ -0,0 +1,109 @@
+/**
+ * @file generazione.c
+ * @brief Implementazione della generazione dei processi atomo.
+ *
+ * Ogni processo che genera atomi (master, alimentazione, atomi in scissione) passa da qui:
+ * esiti, latenze e fallimenti consecutivi vengono aggiornati con operazioni atomiche in memoria
+ * condivisa, così che la soglia di MELTDOWN valga per l'intero reattore.
+ */
+
+#include <stdio.h>
+#include <time.h>
+#include "generazione.h"
+#include "processi.h"
+#include "ospiti.h"
+
+pid_t genera_atomo(int n_atomico, const lignaggio_atomo *lignaggio, pid_t pgid, shmseg *memoria, shmseg2 *memoria2)
+{
+    struct timespec inizio;
+    if (memoria->n_ospiti > 0)
+    {
+        clock_gettime(CLOCK_MONOTONIC, &inizio);
+        int esito = ospita_atomo(n_atomico, lignaggio, memoria, memoria2);
+        registra_generazione(memoria2, esito == 0, nanosecondi_da(&inizio) / 1000);
+        return esito;
+    }
+
+    char numero[16], lignaggio_arg[16], generazione[16], nodo[16];
+    char *argomenti[] = {numero, NULL, NULL, NULL, NULL};
+    sprintf(numero, "%d", n_atomico);
+    if (lignaggio != NULL)
+    {
+        sprintf(lignaggio_arg, "%u", lignaggio->lignaggio);
+        sprintf(generazione, "%u", lignaggio->generazione);
+        sprintf(nodo, "%u", lignaggio->nodo);
+        argomenti[1] = lignaggio_arg;
+        argomenti[2] = generazione;
+        argomenti[3] = nodo;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &inizio);
+    pid_t pid = avvia_processo_argomenti("bin/atomo", argomenti, pgid);
+    registra_generazione(memoria2, pid != -1, nanosecondi_da(&inizio) / 1000);
+    return pid;
+}
+
+void registra_generazione(shmseg2 *memoria2, int riuscita, long long latenza_us)
+{
+    if (!riuscita)
+    {
+        __atomic_fetch_add(&memoria2->generazione.falliti, 1, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&memoria2->generazione.fallimenti_consecutivi, 1, __ATOMIC_RELAXED);
+        return;
+    }
+    __atomic_fetch_add(&memoria2->generazione.riusciti, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&memoria2->generazione.latenza_us_totale, latenza_us, __ATOMIC_RELAXED);
+    // Più processi generano atomi: la media mobile si aggiorna con un confronto e scambio
+    long long recente = __atomic_load_n(&memoria2->generazione.latenza_us_recente, __ATOMIC_RELAXED);
+    long long nuova;
+    do
+    {
+        nuova = recente == 0 ? latenza_us : recente + (latenza_us - recente) / (1 << PESO_LATENZA_RECENTE);
+        if (nuova < 1)
+        {
+            nuova = 1;
+        }
+    } while (!__atomic_compare_exchange_n(&memoria2->generazione.latenza_us_recente, &recente, nuova, 0,
+                                          __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+    __atomic_store_n(&memoria2->generazione.fallimenti_consecutivi, 0, __ATOMIC_RELAXED);
+}
+
+int meltdown_sostenuto(shmseg2 *memoria2, const SimulationParams *params)
+{
+    return __atomic_load_n(&memoria2->generazione.fallimenti_consecutivi, __ATOMIC_RELAXED) >= params->soglia_meltdown;
+}
+
+void registra_ritentativo(shmseg2 *memoria2)
+{
+    __atomic_fetch_add(&memoria2->generazione.ritentati, 1, __ATOMIC_RELAXED);
+}
+
+void registra_scartato(shmseg2 *memoria2)
+{
+    __atomic_fetch_add(&memoria2->generazione.scartati, 1, __ATOMIC_RELAXED);
+}
+
+int scoria_senza_processo(int n_atomico, const SimulationParams *params, shmseg2 *memoria2)
+{
+    if (n_atomico >= params->min_n_atomico)
+    {
+        return 0;
+    }
+    __atomic_fetch_add(&memoria2->generazione.risparmiati, 1, __ATOMIC_RELAXED);
+    return 1;
+}
+
+long long latenza_media_generazione_us(shmseg2 *memoria2)
+{
+    long long riusciti = __atomic_load_n(&memoria2->generazione.riusciti, __ATOMIC_RELAXED);
+    if (riusciti == 0)
+    {
+        return 0;
+    }
+    return __atomic_load_n(&memoria2->generazione.latenza_us_totale, __ATOMIC_RELAXED) / riusciti;
+}
+
+long long latenza_recente_generazione_us(shmseg2 *memoria2)
+{
+    return __atomic_load_n(&memoria2->generazione.latenza_us_recente, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,100 @@
+/**
+ * @file generazione.h
+ * @brief Generazione dei processi atomo e politica sui fallimenti della fork.
+ *
+ * Questo file contiene le dichiarazioni delle funzioni che avviano un atomo registrando esito e
+ * latenza della generazione, e che stabiliscono quando i fallimenti sono tali da dichiarare MELTDOWN.
+ */
+
+#ifndef GENERAZIONE_H
+#define GENERAZIONE_H
+
+#include <sys/types.h>
+#include "conf.h"
+#include "shared_memory.h"
+#include "lignaggio.h"
+
+/**
+ * @brief Avvia un processo atomo registrando esito e latenza della generazione.
+ *
+ * Con i processi ospite attivi l'atomo viene invece affidato all'ospite meno carico.
+ *
+ * @param n_atomico Numero atomico del nuovo atomo
+ * @param lignaggio Lignaggio, generazione e nodo del nuovo atomo, passati come argomenti (NULL se nessuno)
+ * @param pgid Gruppo di processi del figlio (negativo per ereditarlo)
+ * @param memoria Memoria condivisa degli identificatori, con la coda degli ospiti
+ * @param memoria2 Memoria condivisa della simulazione, dove vengono esportate le metriche
+ * @return Il PID dell'atomo (0 se affidato a un ospite), -1 se la generazione è fallita
+ */
+pid_t genera_atomo(int n_atomico, const lignaggio_atomo *lignaggio, pid_t pgid, shmseg *memoria, shmseg2 *memoria2);
+
+/**
+ * @brief Registra l'esito di una generazione, anche quando avviene senza fork in un processo ospite.
+ *
+ * @param memoria2 Memoria condivisa della simulazione
+ * @param riuscita 1 se l'atomo è nato, 0 altrimenti
+ * @param latenza_us Durata della generazione riuscita, in microsecondi
+ */
+void registra_generazione(shmseg2 *memoria2, int riuscita, long long latenza_us);
+
+/**
+ * @brief Indica se i fallimenti della fork giustificano la dichiarazione di MELTDOWN.
+ *
+ * @param memoria2 Memoria condivisa della simulazione
+ * @param params Parametri della simulazione
+ * @return 1 se i fallimenti consecutivi hanno raggiunto `SOGLIA_MELTDOWN`, 0 altrimenti
+ */
+int meltdown_sostenuto(shmseg2 *memoria2, const SimulationParams *params);
+
+/**
+ * @brief Registra che una generazione fallita è stata rimessa in coda per un nuovo tentativo.
+ *
+ * @param memoria2 Memoria condivisa della simulazione
+ */
+void registra_ritentativo(shmseg2 *memoria2);
+
+/**
+ * @brief Registra che una generazione fallita è stata abbandonata.
+ *
+ * @param memoria2 Memoria condivisa della simulazione
+ */
+void registra_scartato(shmseg2 *memoria2);
+
+/**
+ * @brief Indica se un atomo nascerebbe già scoria e in tal caso conta la fork evitata.
+ *
+ * Un atomo sotto `MIN_N_ATOMICO` diventerebbe scoria appena avviato: chi lo genera lo conta
+ * direttamente come scoria invece di avviare un processo.
+ *
+ * @param n_atomico Numero atomico del nuovo atomo
+ * @param params Parametri della simulazione
+ * @param memoria2 Memoria condivisa della simulazione
+ * @return 1 se l'atomo è una scoria e la fork è stata evitata, 0 altrimenti
+ */
+int scoria_senza_processo(int n_atomico, const SimulationParams *params, shmseg2 *memoria2);
+
+/**
+ * @brief Peso dell'ultima generazione nella media mobile della latenza (1/2^PESO_LATENZA_RECENTE).
+ */
+#define PESO_LATENZA_RECENTE 3
+
+/**
+ * @brief Latenza media della fork in microsecondi.
+ *
+ * @param memoria2 Memoria condivisa della simulazione
+ * @return Latenza media, 0 se non è stato generato alcun atomo
+ */
+long long latenza_media_generazione_us(shmseg2 *memoria2);
+
+/**
+ * @brief Latenza recente della fork in microsecondi, media mobile esponenziale delle ultime generazioni.
+ *
+ * A differenza della media dall'avvio segue le variazioni della latenza anche in una simulazione lunga:
+ * è il valore da usare per regolare la quota dell'alimentazione.
+ *
+ * @param memoria2 Memoria condivisa della simulazione
+ * @return Latenza recente, 0 se non è stato generato alcun atomo
+ */
+long long latenza_recente_generazione_us(shmseg2 *memoria2);
+
+#endif
@@ -0,0 +1,177 @@
+/**
+ * @file inibizione.c
+ * @brief Implementazione della logica di assorbimento dell'energia.
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include "inibizione.h"
+#include "casuale.h"
+
+void inizia_aggiornamento_energia(shmseg2 *memoria2)
+{
+    __atomic_fetch_add(&memoria2->sequenza_energia, 1, __ATOMIC_RELAXED);
+    // La sequenza dispari deve essere visibile prima delle scritture sull'energia
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+void termina_aggiornamento_energia(shmseg2 *memoria2)
+{
+    __atomic_fetch_add(&memoria2->sequenza_energia, 1, __ATOMIC_RELEASE);
+}
+
+int energia_corrente(shmseg2 *memoria2)
+{
+    unsigned int prima, dopo;
+    int energia;
+    do
+    {
+        prima = __atomic_load_n(&memoria2->sequenza_energia, __ATOMIC_ACQUIRE);
+        energia = __atomic_load_n(&memoria2->energia_totale, __ATOMIC_RELAXED) +
+                  __atomic_load_n(&memoria2->energia_totale_ultimo_secondo, __ATOMIC_RELAXED) -
+                  __atomic_load_n(&memoria2->energia_da_assorbire, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        dopo = __atomic_load_n(&memoria2->sequenza_energia, __ATOMIC_RELAXED);
+    } while ((prima & 1) || prima != dopo);
+    return energia;
+}
+
+void conta_produzione(shmseg2 *memoria2, int scissioni, int energia)
+{
+    __atomic_fetch_add(&memoria2->previsione.scissioni, scissioni, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&memoria2->previsione.energia_prodotta, energia, __ATOMIC_RELAXED);
+}
+
+// Aggiunge alla finestra l'intervallo trascorso dall'ultimo passo e prevede il successivo
+static void aggiorna_previsione(previsione_energia *p)
+{
+    long long prodotta = __atomic_load_n(&p->energia_prodotta, __ATOMIC_RELAXED);
+    long long scissioni = __atomic_load_n(&p->scissioni, __ATOMIC_RELAXED);
+    int energia = prodotta - p->energia_prodotta_letta;
+    p->energia_prodotta_letta = prodotta;
+    p->scissioni_intervallo[p->posizione] = scissioni - p->scissioni_lette;
+    p->scissioni_lette = scissioni;
+
+    // L'errore è quello della previsione fatta al passo precedente per questo intervallo
+    int errore = 0;
+    if (p->riempimento > 0)
+    {
+        errore = energia - p->previsione;
+        __atomic_fetch_add(&p->errore_tick, errore, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&p->errore_assoluto_tick, abs(errore), __ATOMIC_RELAXED);
+        __atomic_fetch_add(&p->intervalli_tick, 1, __ATOMIC_RELAXED);
+    }
+    p->energia[p->posizione] = energia;
+    p->errore[p->posizione] = errore;
+    p->posizione = (p->posizione + 1) % FINESTRA_PREVISIONE;
+    if (p->riempimento < FINESTRA_PREVISIONE)
+    {
+        p->riempimento++;
+    }
+
+    if (p->riempimento == 1)
+    {
+        p->livello = energia;
+        p->tendenza = 0;
+    }
+    else
+    {
+        double precedente = p->livello;
+        p->livello = ALFA_PREVISIONE * energia + (1 - ALFA_PREVISIONE) * (p->livello + p->tendenza);
+        p->tendenza = BETA_PREVISIONE * (p->livello - precedente) + (1 - BETA_PREVISIONE) * p->tendenza;
+    }
+    double prevista = p->livello + p->tendenza;
+    p->previsione = prevista > 0 ? (int)(prevista + 0.5) : 0;
+
+    double quadrati = 0;
+    for (int i = 0; i < p->riempimento; i++)
+    {
+        quadrati += (double)p->errore[i] * p->errore[i];
+    }
+    p->margine = (int)(MARGINE_PREVISIONE * sqrt(quadrati / p->riempimento) + 0.5);
+}
+
+// Permessi di scissione che lo spazio sotto la soglia può ancora accogliere, -1 se senza limite.
+// L'energia per scissione è quella osservata nella finestra o, senza scissioni recenti, quella
+// attesa dalla popolazione viva
+static int limite_permessi(const previsione_energia *p, const riepilogo_popolazione *popolazione, int spazio)
+{
+    long long energia = 0, scissioni = 0;
+    for (int i = 0; i < p->riempimento; i++)
+    {
+        energia += p->energia[i];
+        scissioni += p->scissioni_intervallo[i];
+    }
+    double per_scissione = scissioni > 0 && energia > 0 ? (double)energia / scissioni : 0;
+    if (per_scissione == 0 && popolazione->fissili > 0)
+    {
+        per_scissione = popolazione->potenziale / popolazione->fissili;
+    }
+    if (per_scissione <= 0)
+    {
+        return -1;
+    }
+    if (spazio <= 0)
+    {
+        return 0;
+    }
+    return (int)(spazio / per_scissione);
+}
+
+int passo_inibitore(const SimulationParams *params, shmseg2 *memoria2, int con_previsione)
+{
+    previsione_energia *p = &memoria2->previsione;
+    __atomic_fetch_add(&memoria2->passi_inibitore, 1, __ATOMIC_RELAXED);
+    if (con_previsione)
+    {
+        aggiorna_previsione(p);
+    }
+    int previsione_pronta = con_previsione && p->riempimento >= AVVIO_PREVISIONE;
+
+    int soglia = params->energy_explode_threshold;
+    int energia = energia_corrente(memoria2);
+    int assorbita = 0;
+    if (!previsione_pronta)
+    {
+        // Senza abbastanza storia la previsione non è affidabile: regola fissa prudente
+        if (energia > soglia * 0.75)
+        {
+            assorbita = energia - soglia / 2;
+        }
+    }
+    else if (energia + p->previsione + p->margine > soglia)
+    {
+        // Si tiene tutta l'energia compatibile con la produzione prevista
+        assorbita = energia + p->previsione + p->margine - soglia;
+        if (assorbita > energia)
+        {
+            assorbita = energia > 0 ? energia : 0;
+        }
+    }
+
+    int limite = -1;
+    if (previsione_pronta)
+    {
+        riepilogo_popolazione popolazione;
+        riassumi_popolazione(memoria2, params->min_n_atomico, &popolazione);
+        limite = limite_permessi(p, &popolazione, soglia - (energia - assorbita));
+    }
+    __atomic_store_n(&p->limite_permessi, limite, __ATOMIC_RELAXED);
+    if (assorbita == 0)
+    {
+        return 0;
+    }
+
+    __atomic_fetch_add(&memoria2->energia_da_assorbire, assorbita, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&memoria2->energia_assorbita_ultimo_sec, assorbita, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&memoria2->interventi_inibitore, 1, __ATOMIC_RELAXED);
+    return assorbita;
+}
+
+int applica_assorbimento(shmseg2 *memoria2)
+{
+    int assorbita = __atomic_exchange_n(&memoria2->energia_da_assorbire, 0, __ATOMIC_RELAXED);
+    memoria2->energia_totale -= assorbita;
+    memoria2->energia_assorbita += assorbita;
+    return assorbita;
+}
@@ -0,0 +1,111 @@
+/**
+ * @file inibizione.h
+ * @brief Logica di assorbimento dell'energia dell'inibitore.
+ *
+ * Separata dal processo inibitore così che il master possa applicarla anche durante la
+ * riproduzione di un registro di eventi, senza processi.
+ *
+ * L'inibitore esegue il proprio ciclo di controllo indipendente dal tick del master e non
+ * prende lock: legge l'energia con un seqlock (il master la aggiorna al tick tra
+ * `inizia_aggiornamento_energia` e `termina_aggiornamento_energia`, e il lettore ripete la
+ * lettura se la sequenza è dispari o è cambiata) e pubblica l'energia assorbita in
+ * `energia_da_assorbire`, che il master sottrae al totale al tick successivo.
+ *
+ * L'assorbimento è dimensionato su una previsione: a ogni passo l'inibitore aggiunge alla
+ * finestra scorrevole in `memoria2->previsione` l'energia prodotta e le scissioni dell'ultimo
+ * intervallo, prevede l'energia dell'intervallo successivo con un livellamento esponenziale
+ * doppio (livello e tendenza) e assorbe solo quanto serve perché energia, previsione e margine
+ * restino entro la soglia di esplosione. Il margine è un multiplo dello scarto quadratico medio
+ * degli errori di previsione nella finestra: stretto con una produzione regolare, ampio con una
+ * produzione a raffiche.
+ */
+
+#ifndef INIBIZIONE_H
+#define INIBIZIONE_H
+
+#include "conf.h"
+#include "shared_memory.h"
+
+/**
+ * @brief Peso dell'ultimo intervallo nel livello della previsione.
+ */
+#define ALFA_PREVISIONE 0.3
+
+/**
+ * @brief Peso dell'ultima variazione del livello nella tendenza della previsione.
+ */
+#define BETA_PREVISIONE 0.1
+
+/**
+ * @brief Scarti quadratici medi dell'errore di previsione tenuti come margine sotto la soglia.
+ */
+#define MARGINE_PREVISIONE 3.0
+
+/**
+ * @brief Intervalli osservati prima di usare la previsione; fino ad allora vale la regola fissa.
+ */
+#define AVVIO_PREVISIONE (FINESTRA_PREVISIONE / 4)
+
+/**
+ * @brief Apre l'aggiornamento dell'energia da parte del master: la sequenza diventa dispari.
+ *
+ * @param memoria2 Memoria condivisa della simulazione
+ */
+void inizia_aggiornamento_energia(shmseg2 *memoria2);
+
+/**
+ * @brief Chiude l'aggiornamento dell'energia: la sequenza torna pari.
+ *
+ * @param memoria2 Memoria condivisa della simulazione
+ */
+void termina_aggiornamento_energia(shmseg2 *memoria2);
+
+/**
+ * @brief Legge senza lock l'energia corrente: totale, più quella dell'ultimo secondo, meno quella già assorbita.
+ *
+ * @param memoria2 Memoria condivisa della simulazione
+ * @return L'energia corrente
+ */
+int energia_corrente(shmseg2 *memoria2);
+
+/**
+ * @brief Esegue un passo di assorbimento dell'energia.
+ *
+ * Aggiorna la previsione con l'intervallo appena trascorso e assorbe l'energia che, sommata a
+ * previsione e margine, supererebbe la soglia di esplosione. Finché la finestra ha meno di
+ * `AVVIO_PREVISIONE` intervalli, oltre il 75% della soglia l'energia viene riportata a metà soglia.
+ * L'energia assorbita viene pubblicata in `energia_da_assorbire` e in `energia_assorbita_ultimo_sec`;
+ * lo spazio che resta sotto la soglia, diviso per l'energia media di una scissione (osservata
+ * nella finestra o, senza scissioni recenti, attesa dall'istogramma degli atomi vivi), diventa
+ * il limite dei permessi di scissione in `previsione.limite_permessi` (-1 se senza limite).
+ *
+ * Senza previsione (la riproduzione di un registro, che esegue un passo per tick invece che alla
+ * frequenza dell'inibitore) la finestra non viene aggiornata e vale sempre la regola fissa.
+ *
+ * @param params Parametri della simulazione
+ * @param memoria2 Memoria condivisa della simulazione
+ * @param con_previsione 1 per aggiornare e usare la previsione, 0 per la sola regola fissa
+ * @return L'energia assorbita in questo passo
+ */
+int passo_inibitore(const SimulationParams *params, shmseg2 *memoria2, int con_previsione);
+
+/**
+ * @brief Accumula scissioni ed energia prodotta nei totali letti dalla previsione dell'inibitore.
+ *
+ * @param memoria2 Memoria condivisa della simulazione
+ * @param scissioni Scissioni avvenute
+ * @param energia Energia prodotta
+ */
+void conta_produzione(shmseg2 *memoria2, int scissioni, int energia);
+
+/**
+ * @brief Sottrae al totale l'energia assorbita dall'inibitore dall'ultimo tick.
+ *
+ * Va chiamata dal master tra `inizia_aggiornamento_energia` e `termina_aggiornamento_energia`.
+ *
+ * @param memoria2 Memoria condivisa della simulazione
+ * @return L'energia sottratta
+ */
+int applica_assorbimento(shmseg2 *memoria2);
+
+#endif
@@ -0,0 +1,98 @@
+/**
+ * @file istanza.c
+ * @brief Implementazione delle funzioni per le istanze indipendenti del reattore.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/ipc.h>
+#include "istanza.h"
+#include "conf.h"
+#include "report.h"
+
+int istanza_corrente()
+{
+    const char *valore = getenv(VARIABILE_ISTANZA);
+    if (valore == NULL || valore[0] == '\0')
+    {
+        return 0;
+    }
+
+    char *fine;
+    long istanza = strtol(valore, &fine, 10);
+    if (*fine != '\0' || istanza < 0 || istanza >= ISTANZE_MAX)
+    {
+        fprintf(stderr, "%s non valida: %s (valori ammessi da 0 a %d)\n", VARIABILE_ISTANZA, valore, ISTANZE_MAX - 1);
+        exit(EXIT_FAILURE);
+    }
+    return (int)istanza;
+}
+
+key_t chiave_ipc(char *pathname, int istanza)
+{
+    // Identificativi di progetto da 1 a 255, a partire da 'x' per l'istanza 0
+    int progetto = ('x' - 1 + istanza) % ISTANZE_MAX + 1;
+    key_t key = ftok(pathname, progetto);
+    if (key == -1)
+    {
+        perror("ftok error");
+        exit(EXIT_FAILURE);
+    }
+    return key;
+}
+
+pid_t avvia_istanza(int istanza, int inibitore, const char *configurazione,
+                    const char *percorso_log, const char *percorso_report)
+{
+    char valore[16];
+    int risposta[2];
+
+    sprintf(valore, "%d", istanza);
+    unlink(percorso_report);
+
+    if (pipe(risposta) == -1)
+    {
+        perror("pipe error");
+        return -1;
+    }
+
+    pid_t pid = fork();
+    switch (pid)
+    {
+    case -1:
+        perror("Error starting the process");
+        close(risposta[0]);
+        close(risposta[1]);
+        return -1;
+    case 0:
+    {
+        int log = open(percorso_log, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (log == -1)
+        {
+            perror("Errore nell'aprire il file di log");
+            exit(EXIT_FAILURE);
+        }
+        dup2(risposta[0], STDIN_FILENO);
+        dup2(log, STDOUT_FILENO);
+        close(risposta[0]);
+        close(risposta[1]);
+        close(log);
+        setenv(VARIABILE_ISTANZA, valore, 1);
+        setenv(VARIABILE_REPORT, percorso_report, 1);
+        if (configurazione != NULL)
+        {
+            setenv(VARIABILE_CONFIGURAZIONE, configurazione, 1);
+        }
+        execl("bin/master", "bin/master", NULL);
+        perror("Exec fallito");
+        exit(EXIT_FAILURE);
+    }
+    default:
+        close(risposta[0]);
+        dprintf(risposta[1], "%d\n", inibitore);
+        close(risposta[1]);
+        return pid;
+    }
+}
@@ -0,0 +1,62 @@
+/**
+ * @file istanza.h
+ * @brief Istanze indipendenti del reattore sullo stesso host.
+ *
+ * Questo file contiene le dichiarazioni delle funzioni che leggono l'identificativo dell'istanza
+ * e ne ricavano le chiavi IPC, così che più reattori possano essere eseguiti contemporaneamente.
+ */
+
+#ifndef ISTANZA_H
+#define ISTANZA_H
+
+#include <sys/types.h>
+
+/**
+ * @brief Variabile d'ambiente con l'identificativo dell'istanza, ereditata da tutti i processi del reattore.
+ */
+#define VARIABILE_ISTANZA "REATTORE_ISTANZA"
+
+/**
+ * @brief Numero massimo di istanze: `ftok` usa solo gli 8 bit bassi dell'identificativo di progetto.
+ */
+#define ISTANZE_MAX 255
+
+/**
+ * @brief Restituisce l'identificativo dell'istanza corrente.
+ *
+ * Legge `REATTORE_ISTANZA`; se assente l'istanza è 0. Termina il programma se il valore
+ * non è compreso tra 0 e ISTANZE_MAX - 1.
+ *
+ * @return Identificativo dell'istanza
+ */
+int istanza_corrente();
+
+/**
+ * @brief Genera la chiave IPC di un oggetto per una data istanza.
+ *
+ * La chiave è ottenuta con `ftok` dal percorso e da un identificativo di progetto che dipende
+ * dall'istanza; l'istanza 0 usa lo stesso identificativo ('x') delle versioni precedenti.
+ *
+ * @param pathname Percorso di un file esistente che identifica l'oggetto
+ * @param istanza Identificativo dell'istanza
+ * @return La chiave IPC, termina il programma in caso di errore
+ */
+key_t chiave_ipc(char *pathname, int istanza);
+
+/**
+ * @brief Avvia un master come istanza indipendente del reattore.
+ *
+ * La risposta alla domanda sull'inibitore viene fornita tramite una pipe sullo standard input,
+ * lo standard output del master viene scritto nel file di log.
+ *
+ * @param istanza Identificativo dell'istanza
+ * @param inibitore 1 per avviare l'inibitore, 0 altrimenti
+ * @param configurazione File di configurazione, NULL per ereditare `REATTORE_CONF`
+ * @param percorso_log File in cui scrivere l'output del master
+ * @param percorso_report File in cui il master scrive il resoconto finale
+ * @return Il PID del master, -1 in caso di errore
+ */
+pid_t avvia_istanza(int istanza, int inibitore, const char *configurazione,
+                    const char *percorso_log, const char *percorso_report);
+
+#endif
@@ -0,0 +1,89 @@
+/**
+ * @file latenza.c
+ * @brief Implementazione dell'istogramma delle latenze.
+ */
+
+#include "latenza.h"
+
+/**
+ * @brief Classe di un valore: l'esponente della potenza di due e i bit che lo seguono.
+ */
+static int classe_latenza(unsigned long long valore)
+{
+    if (valore < SOTTOCLASSI_LATENZA)
+    {
+        return (int)valore;
+    }
+    int esponente = 63 - __builtin_clzll(valore);
+    int sottoclasse = (valore >> (esponente - BIT_SOTTOCLASSI_LATENZA)) & (SOTTOCLASSI_LATENZA - 1);
+    return (esponente - BIT_SOTTOCLASSI_LATENZA + 1) * SOTTOCLASSI_LATENZA + sottoclasse;
+}
+
+/**
+ * @brief Valore più alto compreso nella classe.
+ */
+static long long limite_classe(int classe)
+{
+    if (classe < SOTTOCLASSI_LATENZA)
+    {
+        return classe;
+    }
+    int esponente = classe / SOTTOCLASSI_LATENZA + BIT_SOTTOCLASSI_LATENZA - 1;
+    int sottoclasse = classe % SOTTOCLASSI_LATENZA;
+    unsigned long long ampiezza = 1ULL << (esponente - BIT_SOTTOCLASSI_LATENZA);
+    unsigned long long inizio = (unsigned long long)(SOTTOCLASSI_LATENZA + sottoclasse) * ampiezza;
+    unsigned long long limite = inizio + ampiezza - 1;
+    return limite > (unsigned long long)__LONG_LONG_MAX__ ? __LONG_LONG_MAX__ : (long long)limite;
+}
+
+void registra_latenza(istogramma_latenza *istogramma, long long latenza_ns)
+{
+    if (latenza_ns < 0)
+    {
+        latenza_ns = 0;
+    }
+    istogramma->conteggi[classe_latenza(latenza_ns)]++;
+    istogramma->campioni++;
+    if (latenza_ns > istogramma->massimo_ns)
+    {
+        istogramma->massimo_ns = latenza_ns;
+    }
+}
+
+long long percentile_latenza(const istogramma_latenza *istogramma, double percentile)
+{
+    if (istogramma->campioni == 0)
+    {
+        return 0;
+    }
+    // Rango del campione cercato, da 1
+    long long rango = (long long)(percentile / 100.0 * istogramma->campioni + 0.5);
+    if (rango < 1)
+    {
+        rango = 1;
+    }
+    long long cumulati = 0;
+    for (int i = 0; i < N_CLASSI_LATENZA; i++)
+    {
+        cumulati += istogramma->conteggi[i];
+        if (cumulati >= rango)
+        {
+            long long limite = limite_classe(i);
+            return limite < istogramma->massimo_ns ? limite : istogramma->massimo_ns;
+        }
+    }
+    return istogramma->massimo_ns;
+}
+
+void somma_latenze(istogramma_latenza *totale, const istogramma_latenza *parziale)
+{
+    for (int i = 0; i < N_CLASSI_LATENZA; i++)
+    {
+        totale->conteggi[i] += parziale->conteggi[i];
+    }
+    totale->campioni += parziale->campioni;
+    if (parziale->massimo_ns > totale->massimo_ns)
+    {
+        totale->massimo_ns = parziale->massimo_ns;
+    }
+}
@@ -0,0 +1,62 @@
+/**
+ * @file latenza.h
+ * @brief Istogramma delle latenze in nanosecondi con classi a precisione relativa costante.
+ *
+ * Ogni potenza di due è divisa in `SOTTOCLASSI_LATENZA` classi di uguale ampiezza, così che un
+ * percentile sia stimato con un errore relativo inferiore al 12.5% su tutto l'intervallo, da
+ * pochi nanosecondi a secondi, con un vettore di dimensione fissa e una registrazione in tempo
+ * costante.
+ */
+
+#ifndef LATENZA_H
+#define LATENZA_H
+
+/**
+ * @brief Classi per potenza di due (potenza di due anch'esse).
+ */
+#define BIT_SOTTOCLASSI_LATENZA 3
+#define SOTTOCLASSI_LATENZA (1 << BIT_SOTTOCLASSI_LATENZA)
+
+/**
+ * @brief Numero di classi: i valori sotto SOTTOCLASSI_LATENZA hanno una classe ciascuno, poi
+ * SOTTOCLASSI_LATENZA classi per ogni potenza di due fino a 2^63.
+ */
+#define N_CLASSI_LATENZA ((64 - BIT_SOTTOCLASSI_LATENZA + 1) * SOTTOCLASSI_LATENZA)
+
+/**
+ * @struct istogramma_latenza_
+ * @brief Conteggi per classe, numero di campioni e massimo esatto.
+ */
+typedef struct istogramma_latenza_
+{
+    long long conteggi[N_CLASSI_LATENZA];
+    long long campioni;
+    long long massimo_ns;
+} istogramma_latenza;
+
+/**
+ * @brief Registra un campione (le latenze negative, da orologi diversi, contano come zero).
+ *
+ * @param istogramma Istogramma da aggiornare
+ * @param latenza_ns Latenza in nanosecondi
+ */
+void registra_latenza(istogramma_latenza *istogramma, long long latenza_ns);
+
+/**
+ * @brief Stima un percentile con il limite superiore della sua classe, non oltre il massimo osservato.
+ *
+ * @param istogramma Istogramma da leggere
+ * @param percentile Percentile tra 0 e 100
+ * @return La latenza in nanosecondi, 0 se l'istogramma è vuoto
+ */
+long long percentile_latenza(const istogramma_latenza *istogramma, double percentile);
+
+/**
+ * @brief Aggiunge i campioni di un istogramma a un altro.
+ *
+ * @param totale Istogramma che accumula
+ * @param parziale Istogramma da aggiungere
+ */
+void somma_latenze(istogramma_latenza *totale, const istogramma_latenza *parziale);
+
+#endif
@@ -0,0 +1,179 @@
+/**
+ * @file lignaggio.c
+ * @brief Implementazione dell'arena dei lignaggi di scissione.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/shm.h>
+#include "lignaggio.h"
+#include "shared_memory.h"
+
+size_t dimensione_arena(int capacita)
+{
+    return sizeof(arena_lignaggi) + (size_t)capacita * sizeof(arco_lignaggio);
+}
+
+arena_lignaggi *crea_arena(int istanza, int capacita, int *id)
+{
+    *id = create_shared_memory("lib/lignaggio.c", istanza, dimensione_arena(capacita));
+    arena_lignaggi *arena = collega_arena(*id);
+    if (arena == NULL)
+    {
+        perror("shmat");
+        exit(EXIT_FAILURE);
+    }
+    // Solo l'intestazione: le pagine degli archi restano non toccate finché non servono
+    memset(arena, 0, sizeof(arena_lignaggi));
+    arena->capacita = capacita;
+    return arena;
+}
+
+arena_lignaggi *collega_arena(int id)
+{
+    arena_lignaggi *arena = shmat(id, NULL, 0);
+    return arena == (void *)-1 ? NULL : arena;
+}
+
+lignaggio_atomo lignaggio_da_argomenti(int argc, char *argv[])
+{
+    lignaggio_atomo lignaggio = {NESSUN_NODO, NESSUN_NODO, 0};
+    if (argc >= 5)
+    {
+        lignaggio.lignaggio = strtoul(argv[2], NULL, 10);
+        lignaggio.generazione = atoi(argv[3]);
+        lignaggio.nodo = strtoul(argv[4], NULL, 10);
+    }
+    return lignaggio;
+}
+
+/**
+ * @brief Alloca un arco nell'arena, NESSUN_NODO se è piena.
+ */
+static uint32_t alloca_arco(arena_lignaggi *arena)
+{
+    uint32_t nodo = __atomic_fetch_add(&arena->n_archi, 1, __ATOMIC_RELAXED);
+    return nodo < arena->capacita ? nodo : NESSUN_NODO;
+}
+
+lignaggio_atomo nuova_radice(arena_lignaggi *arena, int lotto)
+{
+    lignaggio_atomo radice = {NESSUN_NODO, NESSUN_NODO, 0};
+    if (arena == NULL)
+    {
+        return radice;
+    }
+    radice.lignaggio = __atomic_fetch_add(&arena->n_lignaggi, 1, __ATOMIC_RELAXED);
+    radice.generazione = 0;
+    radice.nodo = alloca_arco(arena);
+    if (radice.nodo != NESSUN_NODO)
+    {
+        arco_lignaggio *arco = &arena->archi[radice.nodo];
+        arco->genitore = NODO_RADICE;
+        arco->lignaggio = radice.lignaggio;
+        arco->energia = lotto;
+        arco->generazione = 0;
+        arco->figli = 0;
+    }
+    return radice;
+}
+
+lignaggio_atomo nuovo_figlio(arena_lignaggi *arena, const lignaggio_atomo *genitore, int energia)
+{
+    lignaggio_atomo figlio;
+    figlio.lignaggio = genitore->lignaggio;
+    figlio.generazione = genitore->generazione < UINT16_MAX ? genitore->generazione + 1 : UINT16_MAX;
+    figlio.nodo = NESSUN_NODO;
+    // Un atomo senza lignaggio (avviato senza argomenti) o senza arena non lascia archi
+    if (arena == NULL || genitore->lignaggio == NESSUN_NODO)
+    {
+        return figlio;
+    }
+
+    figlio.nodo = alloca_arco(arena);
+    if (figlio.nodo != NESSUN_NODO)
+    {
+        arco_lignaggio *arco = &arena->archi[figlio.nodo];
+        arco->genitore = genitore->nodo;
+        arco->lignaggio = figlio.lignaggio;
+        arco->energia = energia;
+        arco->generazione = figlio.generazione;
+        arco->figli = 0;
+    }
+    // Solo il processo del genitore scrive i propri figli, ma lo fa mentre altri leggono l'arena
+    if (genitore->nodo != NESSUN_NODO && arena->archi[genitore->nodo].figli < UINT16_MAX)
+    {
+        __atomic_fetch_add(&arena->archi[genitore->nodo].figli, 1, __ATOMIC_RELAXED);
+    }
+    return figlio;
+}
+
+void annulla_figlio(arena_lignaggi *arena, const lignaggio_atomo *genitore, const lignaggio_atomo *figlio)
+{
+    if (arena == NULL || figlio->lignaggio == NESSUN_NODO)
+    {
+        return;
+    }
+    if (figlio->nodo != NESSUN_NODO)
+    {
+        arena->archi[figlio->nodo].lignaggio = LIGNAGGIO_ANNULLATO;
+    }
+    if (genitore != NULL && genitore->nodo != NESSUN_NODO)
+    {
+        __atomic_fetch_sub(&arena->archi[genitore->nodo].figli, 1, __ATOMIC_RELAXED);
+    }
+}
+
+aggregato_lignaggio *aggrega_lignaggi(const arena_lignaggi *arena, int *n_lignaggi)
+{
+    *n_lignaggi = arena->n_lignaggi;
+    if (*n_lignaggi == 0)
+    {
+        return NULL;
+    }
+    aggregato_lignaggio *aggregati = calloc(*n_lignaggi, sizeof(aggregato_lignaggio));
+    if (aggregati == NULL)
+    {
+        perror("calloc error");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < *n_lignaggi; i++)
+    {
+        aggregati[i].lotto = -1;
+    }
+
+    uint32_t n_archi = arena->n_archi < arena->capacita ? arena->n_archi : arena->capacita;
+    for (uint32_t i = 0; i < n_archi; i++)
+    {
+        const arco_lignaggio *arco = &arena->archi[i];
+        if (arco->lignaggio >= (uint32_t)*n_lignaggi)
+        {
+            continue;
+        }
+        aggregato_lignaggio *a = &aggregati[arco->lignaggio];
+        a->atomi++;
+        if (arco->genitore == NODO_RADICE)
+        {
+            a->lotto = arco->energia;
+        }
+        else
+        {
+            a->energia += arco->energia;
+        }
+        if (arco->generazione > a->profondita)
+        {
+            a->profondita = arco->generazione;
+        }
+        if (arco->figli > 0)
+        {
+            a->genitori++;
+            a->figli += arco->figli;
+        }
+        if (arco->figli > a->ventaglio)
+        {
+            a->ventaglio = arco->figli;
+        }
+    }
+    return aggregati;
+}
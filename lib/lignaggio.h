@@ -0,0 +1,167 @@
+/**
+ * @file lignaggio.h
+ * @brief Lignaggi di scissione registrati in un'arena di memoria condivisa.
+ *
+ * Ogni atomo porta un lignaggio (l'atomo iniziale o dell'alimentazione da cui discende), la
+ * propria generazione e il proprio nodo, ricevuti come argomenti da chi lo genera. Ogni nascita
+ * aggiunge un arco di 16 byte a un'arena allocata per incremento: l'indice dell'arco è il nodo
+ * del nuovo atomo. Le radici (generazione 0) ricevono un nuovo lignaggio; le scissioni
+ * aggiungono un arco genitore→figlio con l'energia prodotta e incrementano il numero di figli
+ * del genitore. Quando l'arena è piena gli archi successivi vengono solo contati, ma gli atomi
+ * continuano a ereditare lignaggio e generazione.
+ *
+ * A fine simulazione gli aggregati per lignaggio (energia, profondità, ventaglio) si calcolano
+ * con una sola scansione dell'arena e un accumulatore per lignaggio.
+ */
+
+#ifndef LIGNAGGIO_H
+#define LIGNAGGIO_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Nodo e lignaggio di un atomo non registrato (arena piena o atomo avviato senza lignaggio).
+ */
+#define NESSUN_NODO UINT32_MAX
+
+/**
+ * @brief Genitore degli archi radice.
+ */
+#define NODO_RADICE UINT32_MAX
+
+/**
+ * @brief Lignaggio di un arco annullato perché la fork del figlio è fallita.
+ */
+#define LIGNAGGIO_ANNULLATO UINT32_MAX
+
+/**
+ * @brief Lotto delle radici create dal master (atomi iniziali o ricreati da un checkpoint);
+ * quelle dell'alimentazione hanno il numero del passo, da 1.
+ */
+#define LOTTO_MASTER 0
+
+/**
+ * @struct arco_lignaggio_
+ * @brief Un nodo dell'albero di scissione, con l'arco che lo collega al genitore.
+ *
+ * Per le radici `genitore` vale `NODO_RADICE` ed `energia` contiene il lotto di origine.
+ */
+typedef struct arco_lignaggio_
+{
+    uint32_t genitore;
+    uint32_t lignaggio;
+    int32_t energia;
+    uint16_t generazione;
+    uint16_t figli;
+} arco_lignaggio;
+
+/**
+ * @struct arena_lignaggi_
+ * @brief Intestazione dell'arena, seguita dagli archi.
+ */
+typedef struct arena_lignaggi_
+{
+    uint32_t capacita;
+    uint32_t n_archi;    // Archi allocati, può superare la capacità
+    uint32_t n_lignaggi;
+    uint32_t riservato;
+    arco_lignaggio archi[];
+} arena_lignaggi;
+
+/**
+ * @struct lignaggio_atomo_
+ * @brief Posizione di un atomo nei lignaggi, passata come argomento al processo atomo.
+ */
+typedef struct lignaggio_atomo_
+{
+    uint32_t lignaggio;
+    uint32_t nodo;
+    uint16_t generazione;
+} lignaggio_atomo;
+
+/**
+ * @struct aggregato_lignaggio_
+ * @brief Aggregati di un lignaggio calcolati a fine simulazione.
+ */
+typedef struct aggregato_lignaggio_
+{
+    long long energia;
+    int atomi;
+    int genitori;         // Atomi con almeno un figlio
+    int figli;            // Figli dei genitori registrati, anche quelli rimasti senza arco
+    int lotto;
+    uint16_t profondita;  // Generazione massima
+    uint16_t ventaglio;   // Massimo numero di figli di un atomo
+} aggregato_lignaggio;
+
+/**
+ * @brief Dimensione in byte di un'arena con la capacità indicata.
+ */
+size_t dimensione_arena(int capacita);
+
+/**
+ * @brief Crea (o azzera) l'arena dei lignaggi dell'istanza e la collega al processo.
+ *
+ * @param istanza Istanza del reattore
+ * @param capacita Numero di archi dell'arena
+ * @param id Identificatore del segmento creato
+ * @return L'arena collegata
+ */
+arena_lignaggi *crea_arena(int istanza, int capacita, int *id);
+
+/**
+ * @brief Collega il processo a un'arena esistente.
+ *
+ * @param id Identificatore del segmento dell'arena
+ * @return L'arena collegata, NULL in caso di errore
+ */
+arena_lignaggi *collega_arena(int id);
+
+/**
+ * @brief Lignaggio di un atomo letto dagli argomenti del processo, o nessuno se assenti.
+ *
+ * @param argc Numero di argomenti
+ * @param argv Argomenti: numero atomico, lignaggio, generazione, nodo
+ * @return Il lignaggio dell'atomo
+ */
+lignaggio_atomo lignaggio_da_argomenti(int argc, char *argv[]);
+
+/**
+ * @brief Registra un atomo radice e gli assegna un nuovo lignaggio.
+ *
+ * @param arena Arena dei lignaggi (NULL se non disponibile: nessun lignaggio)
+ * @param lotto Lotto di origine: `LOTTO_MASTER` o il passo dell'alimentazione
+ * @return Il lignaggio del nuovo atomo
+ */
+lignaggio_atomo nuova_radice(arena_lignaggi *arena, int lotto);
+
+/**
+ * @brief Registra il figlio di una scissione.
+ *
+ * @param arena Arena dei lignaggi (NULL se non disponibile: il figlio eredita solo lignaggio e generazione)
+ * @param genitore Lignaggio dell'atomo che si scinde
+ * @param energia Energia prodotta dalla scissione
+ * @return Il lignaggio del figlio, con nodo `NESSUN_NODO` se l'arena è piena
+ */
+lignaggio_atomo nuovo_figlio(arena_lignaggi *arena, const lignaggio_atomo *genitore, int energia);
+
+/**
+ * @brief Annulla l'arco di un atomo la cui fork è fallita.
+ *
+ * @param arena Arena dei lignaggi
+ * @param genitore Lignaggio dell'atomo che si scinde, NULL per una radice
+ * @param figlio Lignaggio restituito da `nuovo_figlio` o `nuova_radice`
+ */
+void annulla_figlio(arena_lignaggi *arena, const lignaggio_atomo *genitore, const lignaggio_atomo *figlio);
+
+/**
+ * @brief Calcola gli aggregati di ogni lignaggio con una scansione dell'arena.
+ *
+ * @param arena Arena dei lignaggi, da leggere quando nessun atomo è più in vita
+ * @param n_lignaggi Numero di lignaggi restituiti
+ * @return Vettore di aggregati indicizzato per lignaggio (da liberare), NULL se non ci sono lignaggi
+ */
+aggregato_lignaggio *aggrega_lignaggi(const arena_lignaggi *arena, int *n_lignaggi);
+
+#endif
@@ -0,0 +1,291 @@
+/**
+ * @file metriche.c
+ * @brief Implementazione dell'esposizione delle metriche in formato Prometheus.
+ */
+
+#include <errno.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include "metriche.h"
+
+/**
+ * @brief Apre il socket in ascolto: UNIX per un percorso, TCP su 127.0.0.1 per una porta.
+ *
+ * @return Il descrittore del socket, -1 in caso di errore con errno impostato
+ */
+static int apri_socket(esposizione_metriche *esposizione, const char *indirizzo)
+{
+    int fd;
+    if (indirizzo[0] == '/' || indirizzo[0] == '.')
+    {
+        struct sockaddr_un unix_addr;
+        memset(&unix_addr, 0, sizeof(unix_addr));
+        unix_addr.sun_family = AF_UNIX;
+        if (strlen(indirizzo) >= sizeof(unix_addr.sun_path))
+        {
+            errno = ENAMETOOLONG;
+            return -1;
+        }
+        strcpy(unix_addr.sun_path, indirizzo);
+        fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        // Un socket rimasto da un'esecuzione interrotta impedirebbe il bind
+        unlink(indirizzo);
+        if (fd == -1 || bind(fd, (struct sockaddr *)&unix_addr, sizeof(unix_addr)) == -1)
+        {
+            goto errore;
+        }
+        strcpy(esposizione->percorso, indirizzo);
+    }
+    else
+    {
+        int porta = atoi(indirizzo);
+        if (porta <= 0 || porta > 65535)
+        {
+            errno = EINVAL;
+            return -1;
+        }
+        struct sockaddr_in tcp_addr;
+        memset(&tcp_addr, 0, sizeof(tcp_addr));
+        tcp_addr.sin_family = AF_INET;
+        tcp_addr.sin_port = htons(porta);
+        tcp_addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        int riuso = 1;
+        if (fd == -1 || setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &riuso, sizeof(riuso)) == -1 ||
+            bind(fd, (struct sockaddr *)&tcp_addr, sizeof(tcp_addr)) == -1)
+        {
+            goto errore;
+        }
+    }
+    if (listen(fd, 8) == -1)
+    {
+        goto errore;
+    }
+    return fd;
+
+errore:
+    if (fd != -1)
+    {
+        int errore = errno;
+        close(fd);
+        errno = errore;
+    }
+    return -1;
+}
+
+/**
+ * @brief Copia l'ultimo campione pubblicato, ripetendo la lettura se il master lo sta aggiornando.
+ */
+static void leggi_campione(esposizione_metriche *esposizione, campione_metriche *campione)
+{
+    unsigned int prima, dopo;
+    do
+    {
+        prima = __atomic_load_n(&esposizione->sequenza, __ATOMIC_ACQUIRE);
+        memcpy(campione, &esposizione->campione, sizeof(campione_metriche));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        dopo = __atomic_load_n(&esposizione->sequenza, __ATOMIC_RELAXED);
+    } while ((prima & 1) || prima != dopo);
+}
+
+/**
+ * @brief Scrive il campione nel formato testuale di Prometheus.
+ *
+ * @return I byte scritti nel buffer
+ */
+static int formatta_metriche(const campione_metriche *c, long long richieste, char *buffer, size_t dimensione)
+{
+    // Una riga per metrica: nome, tipo, valore e descrizione
+    const struct
+    {
+        const char *nome;
+        const char *tipo;
+        double valore;
+        const char *aiuto;
+    } metriche[] = {
+        {"reattore_tick_total", "counter", c->tick, "Tick eseguiti dal master"},
+        {"reattore_energia", "gauge", c->energia, "Energia disponibile nel reattore"},
+        {"reattore_energia_prelevata_total", "counter", c->energia_prelevata, "Energia prelevata dalla domanda"},
+        {"reattore_energia_assorbita_total", "counter", c->energia_assorbita, "Energia assorbita dall'inibitore"},
+        {"reattore_scissioni_total", "counter", c->scissioni, "Scissioni avvenute"},
+        {"reattore_scorie_total", "counter", c->scorie, "Atomi diventati scoria"},
+        {"reattore_attivazioni_total", "counter", c->attivazioni, "Attivazioni dell'attivatore"},
+        {"reattore_atomi_attivi", "gauge", c->atomi_attivi, "Atomi vivi"},
+        {"reattore_inibitore_attivo", "gauge", c->inibitore_attivo, "1 se l'inibitore è attivo"},
+        {"reattore_interventi_inibitore_total", "counter", c->interventi_inibitore, "Passi dell'inibitore che hanno assorbito energia"},
+        {"reattore_generazioni_riuscite_total", "counter", c->generazioni_riuscite, "Fork di atomi riuscite"},
+        {"reattore_generazioni_fallite_total", "counter", c->generazioni_fallite, "Fork di atomi fallite"},
+        {"reattore_generazioni_scartate_total", "counter", c->generazioni_scartate, "Atomi scartati dopo i ritentativi"},
+        {"reattore_ritardo_tick_secondi", "gauge", c->ritardo_tick_us / 1e6, "Ritardo dell'ultimo tick"},
+        {"reattore_ritardo_tick_massimo_secondi", "gauge", c->ritardo_tick_massimo_us / 1e6, "Ritardo massimo di un tick"},
+        {"reattore_ritardo_tick_secondi_total", "counter", c->ritardo_tick_totale_us / 1e6, "Ritardo accumulato dai tick"},
+        {"reattore_richieste_metriche_total", "counter", richieste, "Richieste servite da questo endpoint"},
+    };
+
+    int scritti = 0;
+    for (size_t i = 0; i < sizeof(metriche) / sizeof(metriche[0]); i++)
+    {
+        int n = snprintf(buffer + scritti, dimensione - scritti, "# HELP %s %s\n# TYPE %s %s\n%s %.15g\n",
+                         metriche[i].nome, metriche[i].aiuto, metriche[i].nome, metriche[i].tipo,
+                         metriche[i].nome, metriche[i].valore);
+        if (n < 0 || (size_t)n >= dimensione - scritti)
+        {
+            break;
+        }
+        scritti += n;
+    }
+    return scritti;
+}
+
+/**
+ * @brief Scrive tutto il buffer sul socket, fermandosi al primo errore.
+ */
+static void scrivi_tutto(int fd, const char *buffer, size_t lunghezza)
+{
+    while (lunghezza > 0)
+    {
+        ssize_t n = send(fd, buffer, lunghezza, MSG_NOSIGNAL);
+        if (n <= 0)
+        {
+            return;
+        }
+        buffer += n;
+        lunghezza -= n;
+    }
+}
+
+/**
+ * @brief Risponde a una richiesta: legge l'intestazione HTTP e invia il campione corrente.
+ */
+static void servi_richiesta(esposizione_metriche *esposizione, int fd)
+{
+    // Un client lento non può trattenere il thread oltre un secondo
+    struct timeval scadenza = {1, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &scadenza, sizeof(scadenza));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &scadenza, sizeof(scadenza));
+
+    char richiesta[2048];
+    size_t letti = 0;
+    while (letti < sizeof(richiesta) - 1)
+    {
+        ssize_t n = recv(fd, richiesta + letti, sizeof(richiesta) - 1 - letti, 0);
+        if (n <= 0)
+        {
+            break;
+        }
+        letti += n;
+        richiesta[letti] = '\0';
+        if (strstr(richiesta, "\r\n\r\n") != NULL || strstr(richiesta, "\n\n") != NULL)
+        {
+            break;
+        }
+    }
+    richiesta[letti] = '\0';
+
+    char corpo[4096];
+    char intestazione[256];
+    int lunghezza_corpo = 0;
+    const char *stato;
+    if (strncmp(richiesta, "GET ", 4) == 0)
+    {
+        campione_metriche campione;
+        leggi_campione(esposizione, &campione);
+        esposizione->richieste++;
+        lunghezza_corpo = formatta_metriche(&campione, esposizione->richieste, corpo, sizeof(corpo));
+        stato = "200 OK";
+    }
+    else
+    {
+        stato = "405 Method Not Allowed";
+    }
+    int lunghezza = snprintf(intestazione, sizeof(intestazione),
+                             "HTTP/1.0 %s\r\nContent-Type: text/plain; version=0.0.4\r\n"
+                             "Content-Length: %d\r\nConnection: close\r\n\r\n",
+                             stato, lunghezza_corpo);
+    scrivi_tutto(fd, intestazione, lunghezza);
+    scrivi_tutto(fd, corpo, lunghezza_corpo);
+}
+
+/**
+ * @brief Ciclo del thread: accetta una connessione alla volta finché l'esposizione è attiva.
+ */
+static void *ciclo_esposizione(void *argomento)
+{
+    esposizione_metriche *esposizione = argomento;
+    struct pollfd attesa = {esposizione->socket, POLLIN, 0};
+    while (__atomic_load_n(&esposizione->attiva, __ATOMIC_ACQUIRE))
+    {
+        if (poll(&attesa, 1, ATTESA_METRICHE_MS) <= 0)
+        {
+            continue;
+        }
+        int fd = accept4(esposizione->socket, NULL, NULL, SOCK_CLOEXEC);
+        if (fd == -1)
+        {
+            continue;
+        }
+        servi_richiesta(esposizione, fd);
+        close(fd);
+    }
+    return NULL;
+}
+
+int avvia_esposizione(esposizione_metriche *esposizione, const char *indirizzo)
+{
+    memset(esposizione, 0, sizeof(esposizione_metriche));
+    esposizione->socket = apri_socket(esposizione, indirizzo);
+    if (esposizione->socket == -1)
+    {
+        fprintf(stderr, "metriche: impossibile ascoltare su %s: %s\n", indirizzo, strerror(errno));
+        return -1;
+    }
+    esposizione->attiva = 1;
+
+    // Il thread eredita la maschera: con tutti i segnali bloccati, come i thread del tick e della
+    // stampa, SIGINT e SIGUSR1 arrivano solo al ciclo eventi
+    sigset_t tutti, precedente;
+    sigfillset(&tutti);
+    pthread_sigmask(SIG_BLOCK, &tutti, &precedente);
+    int errore = pthread_create(&esposizione->thread, NULL, ciclo_esposizione, esposizione);
+    pthread_sigmask(SIG_SETMASK, &precedente, NULL);
+    if (errore != 0)
+    {
+        fprintf(stderr, "metriche: impossibile avviare il thread: %s\n", strerror(errore));
+        close(esposizione->socket);
+        if (esposizione->percorso[0] != '\0')
+        {
+            unlink(esposizione->percorso);
+        }
+        esposizione->attiva = 0;
+        return -1;
+    }
+    dprintf(1, "Metriche esposte su %s%s\n", esposizione->percorso[0] != '\0' ? "" : "127.0.0.1:", indirizzo);
+    return 0;
+}
+
+void pubblica_metriche(esposizione_metriche *esposizione, const campione_metriche *campione)
+{
+    __atomic_fetch_add(&esposizione->sequenza, 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    esposizione->campione = *campione;
+    __atomic_fetch_add(&esposizione->sequenza, 1, __ATOMIC_RELEASE);
+}
+
+void termina_esposizione(esposizione_metriche *esposizione)
+{
+    __atomic_store_n(&esposizione->attiva, 0, __ATOMIC_RELEASE);
+    pthread_join(esposizione->thread, NULL);
+    close(esposizione->socket);
+    if (esposizione->percorso[0] != '\0')
+    {
+        unlink(esposizione->percorso);
+    }
+    dprintf(1, "Metriche: %lld richieste servite\n", esposizione->richieste);
+}
@@ -0,0 +1,95 @@
+/**
+ * @file metriche.h
+ * @brief Esposizione delle metriche della simulazione nel formato testuale di Prometheus.
+ *
+ * Con la variabile d'ambiente `REATTORE_METRICHE` il master avvia un thread che risponde alle
+ * richieste HTTP su un socket locale: un percorso (che inizia con `/` o `.`) indica un socket
+ * UNIX, un numero una porta TCP su 127.0.0.1. A ogni tick il master pubblica un campione dei
+ * contatori con un numero di sequenza (come l'energia letta dall'inibitore); il thread ne legge
+ * una copia coerente senza lock, così una richiesta non ritarda mai il tick.
+ */
+
+#ifndef METRICHE_H
+#define METRICHE_H
+
+#include <pthread.h>
+#include <sys/un.h>
+
+/**
+ * @brief Variabile d'ambiente con l'indirizzo di esposizione: percorso di un socket UNIX o porta TCP locale.
+ */
+#define VARIABILE_METRICHE "REATTORE_METRICHE"
+
+/**
+ * @brief Attesa massima in millisecondi tra due controlli della richiesta di arresto del thread.
+ */
+#define ATTESA_METRICHE_MS 250
+
+/**
+ * @struct campione_metriche_
+ * @brief Contatori e valori correnti della simulazione pubblicati dal master a ogni tick.
+ */
+typedef struct campione_metriche_
+{
+    long long tick;
+    long long energia;
+    long long energia_prelevata;
+    long long energia_assorbita;
+    long long scissioni;
+    long long scorie;
+    long long attivazioni;
+    long long atomi_attivi;
+    long long inibitore_attivo;
+    long long interventi_inibitore;
+    long long generazioni_riuscite;
+    long long generazioni_fallite;
+    long long generazioni_scartate;
+    long long ritardo_tick_us;         // Ritardo dell'ultimo tick rispetto al secondo atteso
+    long long ritardo_tick_massimo_us;
+    long long ritardo_tick_totale_us;
+} campione_metriche;
+
+/**
+ * @struct esposizione_metriche_
+ * @brief Socket in ascolto, thread che lo serve e ultimo campione pubblicato.
+ */
+typedef struct esposizione_metriche_
+{
+    int socket;
+    char percorso[sizeof(((struct sockaddr_un *)0)->sun_path)]; // Socket UNIX da rimuovere, vuoto per TCP
+    int attiva;
+    unsigned int sequenza;
+    campione_metriche campione;
+    long long richieste;
+    pthread_t thread;
+} esposizione_metriche;
+
+/**
+ * @brief Apre il socket di esposizione e avvia il thread che risponde alle richieste.
+ *
+ * Il thread blocca tutti i segnali: i gestori del master continuano a essere eseguiti dal ciclo principale.
+ *
+ * @param esposizione Esposizione da inizializzare
+ * @param indirizzo Percorso del socket UNIX o porta TCP locale
+ * @return 0 se il thread è avviato, -1 altrimenti (il motivo è già stampato)
+ */
+int avvia_esposizione(esposizione_metriche *esposizione, const char *indirizzo);
+
+/**
+ * @brief Pubblica un nuovo campione, letto dal thread alla richiesta successiva.
+ *
+ * Usa solo scritture in memoria e può essere chiamata da un gestore di segnale; un solo scrittore.
+ *
+ * @param esposizione Esposizione avviata
+ * @param campione Campione da copiare
+ */
+void pubblica_metriche(esposizione_metriche *esposizione, const campione_metriche *campione);
+
+/**
+ * @brief Ferma il thread, chiude il socket e rimuove il socket UNIX.
+ *
+ * @param esposizione Esposizione avviata
+ */
+void termina_esposizione(esposizione_metriche *esposizione);
+
+#endif
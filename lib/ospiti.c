@@ -0,0 +1,74 @@
+/**
+ * @file ospiti.c
+ * @brief Implementazione dell'assegnazione degli atomi ai processi ospite.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/msg.h>
+#include <unistd.h>
+#include "ospiti.h"
+
+int scegli_ospite(shmseg *memoria, shmseg2 *memoria2)
+{
+    int scelto = 0;
+    int minimo = __atomic_load_n(&memoria2->atomi_ospitati[0], __ATOMIC_RELAXED);
+    for (int i = 1; i < memoria->n_ospiti; i++)
+    {
+        int atomi = __atomic_load_n(&memoria2->atomi_ospitati[i], __ATOMIC_RELAXED);
+        if (atomi < minimo)
+        {
+            minimo = atomi;
+            scelto = i;
+        }
+    }
+    return scelto;
+}
+
+int ospita_atomo(int n_atomico, const lignaggio_atomo *lignaggio, shmseg *memoria, shmseg2 *memoria2)
+{
+    messaggio_ospite messaggio;
+    int ospite = scegli_ospite(memoria, memoria2);
+    messaggio.mtype = ospite + 1;
+    messaggio.n_atomico = n_atomico;
+    if (lignaggio != NULL)
+    {
+        messaggio.lignaggio = *lignaggio;
+    }
+    else
+    {
+        messaggio.lignaggio = (lignaggio_atomo){NESSUN_NODO, NESSUN_NODO, 0};
+    }
+
+    int tentativi = 0;
+    while (msgsnd(memoria->id_coda_ospiti, &messaggio, sizeof(messaggio) - sizeof(long), IPC_NOWAIT) == -1)
+    {
+        if (errno != EAGAIN)
+        {
+            perror("msgsnd error");
+            return -1;
+        }
+        if (++tentativi == TENTATIVI_OSPITE)
+        {
+            return -1;
+        }
+        usleep(1000);
+    }
+    // Conta l'atomo subito: i nuovi atomi di questo passo vanno agli altri ospiti
+    __atomic_fetch_add(&memoria2->atomi_ospitati[ospite], 1, __ATOMIC_RELAXED);
+    return 0;
+}
+
+int ricevi_atomo(shmseg *memoria, int ospite, messaggio_ospite *messaggio)
+{
+    if (msgrcv(memoria->id_coda_ospiti, messaggio, sizeof(messaggio_ospite) - sizeof(long), ospite + 1, IPC_NOWAIT) == -1)
+    {
+        if (errno != ENOMSG && errno != EIDRM && errno != EINVAL)
+        {
+            perror("msgrcv error");
+        }
+        return 0;
+    }
+    return 1;
+}
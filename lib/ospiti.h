@@ -0,0 +1,72 @@
+/**
+ * @file ospiti.h
+ * @brief Processi ospite che eseguono molti atomi ciascuno (modello M:N).
+ *
+ * Con N_OSPITI > 0 il master avvia un numero fisso di processi ospite invece di un processo per
+ * atomo. Ogni ospite tiene i propri atomi in un vettore di macchine a stati: un'attivazione presa
+ * dal semaforo dell'attivatore fa scindere uno di essi, e il figlio della scissione nasce nello
+ * stesso ospite senza fork. Gli atomi creati dal master e dall'alimentazione arrivano con un
+ * messaggio sulla coda degli ospiti, indirizzato (con il tipo) all'ospite meno carico.
+ */
+
+#ifndef OSPITI_H
+#define OSPITI_H
+
+#include "shared_memory.h"
+#include "lignaggio.h"
+
+/**
+ * @brief Attesa massima in millisecondi di un'attivazione prima di ricontrollare la coda dell'ospite.
+ */
+#define ATTESA_OSPITE_MS 10
+
+/**
+ * @brief Tentativi, a un millisecondo l'uno dall'altro, di inviare un atomo a una coda degli ospiti piena.
+ */
+#define TENTATIVI_OSPITE 50
+
+/**
+ * @struct messaggio_ospite_
+ * @brief Un nuovo atomo da eseguire nell'ospite `mtype - 1`.
+ */
+typedef struct messaggio_ospite_
+{
+    long mtype;
+    int n_atomico;
+    lignaggio_atomo lignaggio;
+} messaggio_ospite;
+
+/**
+ * @brief Sceglie l'ospite con meno atomi vivi.
+ *
+ * @param memoria Memoria condivisa degli identificatori
+ * @param memoria2 Memoria condivisa della simulazione, con gli atomi di ogni ospite
+ * @return L'indice dell'ospite
+ */
+int scegli_ospite(shmseg *memoria, shmseg2 *memoria2);
+
+/**
+ * @brief Affida un nuovo atomo all'ospite meno carico.
+ *
+ * Con la coda piena si riprova per TENTATIVI_OSPITE millisecondi, il tempo che gli ospiti la
+ * svuotino; poi l'atomo non nasce, come per una fork fallita.
+ *
+ * @param n_atomico Numero atomico del nuovo atomo
+ * @param lignaggio Lignaggio del nuovo atomo (NULL se nessuno)
+ * @param memoria Memoria condivisa degli identificatori
+ * @param memoria2 Memoria condivisa della simulazione
+ * @return 0 se il messaggio è stato inviato, -1 altrimenti
+ */
+int ospita_atomo(int n_atomico, const lignaggio_atomo *lignaggio, shmseg *memoria, shmseg2 *memoria2);
+
+/**
+ * @brief Riceve senza attendere un atomo destinato all'ospite.
+ *
+ * @param memoria Memoria condivisa degli identificatori
+ * @param ospite Indice dell'ospite
+ * @param messaggio Messaggio ricevuto
+ * @return 1 se un atomo è stato ricevuto, 0 se la coda dell'ospite è vuota
+ */
+int ricevi_atomo(shmseg *memoria, int ospite, messaggio_ospite *messaggio);
+
+#endif
@@ -0,0 +1,155 @@
+/**
+ * @file pianificazione.c
+ * @brief Implementazione dei profili di affinità e di scheduling.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/resource.h>
+#include "pianificazione.h"
+
+static const char *nomi_componenti[N_COMPONENTI] = {"master", "attivatore", "alimentazione", "inibitore", "atomi"};
+
+const char *nome_componente(int componente)
+{
+    if (componente < 0 || componente >= N_COMPONENTI)
+    {
+        return "sconosciuto";
+    }
+    return nomi_componenti[componente];
+}
+
+int leggi_insieme_cpu(const char *elenco, cpu_set_t *insieme)
+{
+    CPU_ZERO(insieme);
+    const char *cursore = elenco;
+
+    while (*cursore != '\0')
+    {
+        char *fine;
+        long primo = strtol(cursore, &fine, 10);
+        long ultimo = primo;
+        if (fine == cursore)
+        {
+            return -1;
+        }
+        if (*fine == '-')
+        {
+            cursore = fine + 1;
+            ultimo = strtol(cursore, &fine, 10);
+            if (fine == cursore)
+            {
+                return -1;
+            }
+        }
+        if (primo < 0 || ultimo < primo || ultimo >= CPU_SETSIZE)
+        {
+            return -1;
+        }
+        for (long cpu = primo; cpu <= ultimo; cpu++)
+        {
+            CPU_SET(cpu, insieme);
+        }
+        if (*fine == ',')
+        {
+            fine++;
+        }
+        else if (*fine != '\0')
+        {
+            return -1;
+        }
+        cursore = fine;
+    }
+    return CPU_COUNT(insieme);
+}
+
+/**
+ * @brief Restituisce l'elenco di CPU configurato per un componente.
+ *
+ * L'alimentazione condivide le CPU degli atomi che genera.
+ *
+ * @param params Parametri della simulazione
+ * @param componente Componente
+ * @return L'elenco di CPU, stringa vuota se non configurato
+ */
+static const char *cpu_componente(const SimulationParams *params, int componente)
+{
+    switch (componente)
+    {
+    case COMPONENTE_MASTER:
+        return params->cpu_master;
+    case COMPONENTE_ATTIVATORE:
+        return params->cpu_attivatore;
+    case COMPONENTE_INIBITORE:
+        return params->cpu_inibitore;
+    default:
+        return params->cpu_atomi;
+    }
+}
+
+void applica_profilo(const SimulationParams *params, int componente)
+{
+    const char *elenco = cpu_componente(params, componente);
+    if (elenco[0] != '\0')
+    {
+        cpu_set_t insieme;
+        if (leggi_insieme_cpu(elenco, &insieme) <= 0)
+        {
+            fprintf(stderr, "Elenco di CPU non valido per %s: %s\n", nome_componente(componente), elenco);
+        }
+        else if (sched_setaffinity(0, sizeof(insieme), &insieme) == -1)
+        {
+            perror("sched_setaffinity error");
+        }
+    }
+
+    if (componente != COMPONENTE_ATOMO)
+    {
+        return;
+    }
+
+    // Politica e nice vengono ereditati dai figli, ma impostarli di nuovo non ha effetti
+    if (params->politica_atomi != SCHED_OTHER)
+    {
+        struct sched_param priorita = {.sched_priority = 0};
+        if (sched_setscheduler(0, params->politica_atomi, &priorita) == -1)
+        {
+            perror("sched_setscheduler error");
+        }
+    }
+    if (params->nice_atomi != 0 && setpriority(PRIO_PROCESS, 0, params->nice_atomi) == -1)
+    {
+        perror("setpriority error");
+    }
+}
+
+int leggi_uso_scheduler(pid_t pid, uso_scheduler *uso)
+{
+    char percorso[64];
+    if (pid == 0)
+    {
+        strcpy(percorso, "/proc/self/schedstat");
+    }
+    else
+    {
+        sprintf(percorso, "/proc/%d/schedstat", pid);
+    }
+
+    char buffer[128];
+    int fd = open(percorso, O_RDONLY);
+    if (fd == -1)
+    {
+        return -1;
+    }
+    ssize_t letti = read(fd, buffer, sizeof(buffer) - 1);
+    close(fd);
+    if (letti <= 0)
+    {
+        return -1;
+    }
+    buffer[letti] = '\0';
+    return sscanf(buffer, "%lld %lld %lld", &uso->esecuzione_ns, &uso->attesa_ns, &uso->fette) == 3 ? 0 : -1;
+}
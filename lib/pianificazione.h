@@ -0,0 +1,79 @@
+/**
+ * @file pianificazione.h
+ * @brief Profili di affinità e di scheduling dei processi del reattore.
+ *
+ * Questo file contiene le dichiarazioni delle funzioni con cui ogni processo, all'avvio, si
+ * colloca sulle CPU indicate dalla configurazione (`CPU_MASTER`, `CPU_ATTIVATORE`,
+ * `CPU_INIBITORE`, `CPU_ATOMI`) e, per gli atomi, adotta la politica `POLITICA_ATOMI`
+ * e il valore di nice `NICE_ATOMI`. Contiene inoltre la lettura della latenza di scheduling
+ * da `/proc/<pid>/schedstat`.
+ */
+
+#ifndef PIANIFICAZIONE_H
+#define PIANIFICAZIONE_H
+
+#include <sched.h>
+#include <sys/types.h>
+#include "conf.h"
+
+/**
+ * @brief Componenti del reattore con un proprio profilo di scheduling.
+ */
+#define COMPONENTE_MASTER 0
+#define COMPONENTE_ATTIVATORE 1
+#define COMPONENTE_ALIMENTAZIONE 2
+#define COMPONENTE_INIBITORE 3
+#define COMPONENTE_ATOMO 4
+#define N_COMPONENTI 5
+
+/**
+ * @struct uso_scheduler_
+ * @brief Valori di `/proc/<pid>/schedstat`.
+ */
+typedef struct uso_scheduler_
+{
+    long long esecuzione_ns;
+    long long attesa_ns;
+    long long fette;
+} uso_scheduler;
+
+/**
+ * @brief Restituisce il nome di un componente.
+ *
+ * @param componente Uno dei valori COMPONENTE_*
+ * @return Il nome del componente
+ */
+const char *nome_componente(int componente);
+
+/**
+ * @brief Converte un elenco di CPU (es. "0-3,6") in un insieme.
+ *
+ * @param elenco Elenco di CPU e intervalli separati da virgole
+ * @param insieme Insieme da riempire
+ * @return Il numero di CPU dell'insieme, -1 se l'elenco non è valido
+ */
+int leggi_insieme_cpu(const char *elenco, cpu_set_t *insieme);
+
+/**
+ * @brief Applica al processo chiamante il profilo del suo componente.
+ *
+ * Le impostazioni assenti dalla configurazione vengono ignorate. Un errore nell'applicarle
+ * viene segnalato ma non interrompe il processo, che resta con le impostazioni ereditate.
+ *
+ * @param params Parametri della simulazione
+ * @param componente Componente del processo chiamante
+ */
+void applica_profilo(const SimulationParams *params, int componente);
+
+/**
+ * @brief Legge tempo di esecuzione, attesa in coda e numero di fette di un processo.
+ *
+ * Funziona anche sui processi zombie, quindi può essere usata prima di raccoglierli.
+ *
+ * @param pid PID del processo (0 per il chiamante)
+ * @param uso Valori letti
+ * @return 0 in caso di successo, -1 se non disponibile
+ */
+int leggi_uso_scheduler(pid_t pid, uso_scheduler *uso);
+
+#endif
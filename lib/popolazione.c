@@ -0,0 +1,240 @@
+/**
+ * @file popolazione.c
+ * @brief Implementazione della popolazione di atomi organizzata per colonne.
+ *
+ * I nuclei di calcolo non hanno salti dipendenti dai dati e lavorano su puntatori `restrict`,
+ * così che con le ottimizzazioni attive (`make release`) vengano vettorizzati. Il generatore
+ * casuale è uno xorshift a 32 bit per atomo e l'estrazione in [1, n - 1] usa moltiplicazione
+ * e scorrimento al posto del modulo, che non ha un'istruzione vettoriale.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "popolazione.h"
+
+/**
+ * @brief Avanza un generatore xorshift a 32 bit.
+ *
+ * @param x Stato del generatore (diverso da 0)
+ * @return Il nuovo stato
+ */
+static inline uint32_t xorshift32(uint32_t x)
+{
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return x;
+}
+
+/**
+ * @brief Estrae un intero uniforme in [0, limite) da un valore casuale a 32 bit.
+ */
+static inline int riduci(uint32_t casuale, uint32_t limite)
+{
+    return (int)(((uint64_t)casuale * limite) >> 32);
+}
+
+static void alloca_colonne(colonne_atomi *colonne, int capacita)
+{
+    colonne->n_atomico = malloc(sizeof(int) * capacita);
+    colonne->stato = malloc(capacita);
+    colonne->tick_nascita = malloc(sizeof(int) * capacita);
+    colonne->casuale = malloc(sizeof(uint32_t) * capacita);
+    if (colonne->n_atomico == NULL || colonne->stato == NULL || colonne->tick_nascita == NULL || colonne->casuale == NULL)
+    {
+        perror("malloc error");
+        exit(EXIT_FAILURE);
+    }
+}
+
+static void libera_colonne(colonne_atomi *colonne)
+{
+    free(colonne->n_atomico);
+    free(colonne->stato);
+    free(colonne->tick_nascita);
+    free(colonne->casuale);
+}
+
+void crea_popolazione(popolazione_atomi *popolazione, int capacita, uint32_t seme)
+{
+    alloca_colonne(&popolazione->atomi, capacita);
+    alloca_colonne(&popolazione->appoggio, capacita);
+    popolazione->figli = malloc(sizeof(int) * capacita);
+    if (popolazione->figli == NULL)
+    {
+        perror("malloc error");
+        exit(EXIT_FAILURE);
+    }
+    popolazione->dimensione = 0;
+    popolazione->capacita = capacita;
+    popolazione->tick = 0;
+    popolazione->seme = seme != 0 ? seme : 1;
+}
+
+void distruggi_popolazione(popolazione_atomi *popolazione)
+{
+    libera_colonne(&popolazione->atomi);
+    libera_colonne(&popolazione->appoggio);
+    free(popolazione->figli);
+}
+
+int aggiungi_atomi(popolazione_atomi *popolazione, int quanti, const SimulationParams *params, esito_tick *esito)
+{
+    colonne_atomi *atomi = &popolazione->atomi;
+    int aggiunti = 0;
+
+    for (int i = 0; i < quanti && popolazione->dimensione < popolazione->capacita; i++)
+    {
+        popolazione->seme = xorshift32(popolazione->seme);
+        int n_atomico = riduci(popolazione->seme, (uint32_t)params->n_atom_max) + 1;
+        if (n_atomico < params->min_n_atomico)
+        {
+            esito->scorie++;
+            continue;
+        }
+        int j = popolazione->dimensione++;
+        atomi->n_atomico[j] = n_atomico;
+        atomi->stato[j] = ATOMO_ATTIVO;
+        atomi->tick_nascita[j] = popolazione->tick;
+        // Ogni atomo ha il proprio generatore, inizializzato da quello della popolazione
+        popolazione->seme = xorshift32(popolazione->seme);
+        atomi->casuale[j] = popolazione->seme | 1;
+        aggiunti++;
+    }
+    return aggiunti;
+}
+
+/**
+ * @brief Estrae il numero atomico del figlio di ogni atomo attivato, in [1, n - 1].
+ */
+static void estrai_figli(const int *restrict n_atomico, uint32_t *restrict casuale, int *restrict figli, int k)
+{
+    for (int i = 0; i < k; i++)
+    {
+        uint32_t x = casuale[i];
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        casuale[i] = x;
+        figli[i] = riduci(x, (uint32_t)(n_atomico[i] - 1)) + 1;
+    }
+}
+
+/**
+ * @brief Riduce i padri e somma l'energia delle scissioni permesse.
+ *
+ * Solo i primi `permessi` atomi ottengono il permesso: gli altri perdono comunque la massa del
+ * figlio e il loro figlio viene azzerato.
+ *
+ * @return L'energia prodotta nel tick
+ */
+static long long scindi(int *restrict n_atomico, int *restrict figli, int k, int permessi)
+{
+    long long energia = 0;
+    for (int i = 0; i < k; i++)
+    {
+        int padre = n_atomico[i] - figli[i];
+        int figlio = figli[i];
+        int maggiore = padre > figlio ? padre : figlio;
+        int permesso = i < permessi;
+        n_atomico[i] = padre;
+        figli[i] = figlio * permesso;
+        energia += (padre * figlio - maggiore) * permesso;
+    }
+    return energia;
+}
+
+/**
+ * @brief Marca come scorie gli atomi sotto MIN_N_ATOMICO.
+ *
+ * @return Il numero di nuove scorie
+ */
+static int marca_scorie(const int *restrict n_atomico, unsigned char *restrict stato, int k, int minimo)
+{
+    int scorie = 0;
+    for (int i = 0; i < k; i++)
+    {
+        unsigned char scoria = n_atomico[i] < minimo;
+        stato[i] = scoria;
+        scorie += scoria;
+    }
+    return scorie;
+}
+
+/**
+ * @brief Conta i figli generati e quelli che nascono già scorie.
+ */
+static void conta_figli(const int *restrict figli, int k, int minimo, int *generati, int *scorie)
+{
+    int g = 0, s = 0;
+    for (int i = 0; i < k; i++)
+    {
+        g += figli[i] > 0;
+        s += figli[i] > 0 && figli[i] < minimo;
+    }
+    *generati = g;
+    *scorie = s;
+}
+
+void passo_popolazione(popolazione_atomi *popolazione, int attivazioni, const SimulationParams *params, esito_tick *esito)
+{
+    colonne_atomi *atomi = &popolazione->atomi;
+    colonne_atomi *nuovi = &popolazione->appoggio;
+    int dimensione = popolazione->dimensione;
+    int k = attivazioni > 0 && attivazioni < dimensione ? attivazioni : dimensione;
+    int minimo = params->min_n_atomico;
+
+    // I permessi sono i posti liberi nella popolazione, come nel controllo di ammissione
+    int permessi = popolazione->capacita - dimensione;
+
+    estrai_figli(atomi->n_atomico, atomi->casuale, popolazione->figli, k);
+    long long energia = scindi(atomi->n_atomico, popolazione->figli, k, permessi);
+    int scorie_padri = marca_scorie(atomi->n_atomico, atomi->stato, k, minimo);
+    int generati, scorie_figli;
+    conta_figli(popolazione->figli, k, minimo, &generati, &scorie_figli);
+
+    esito->attivazioni += k;
+    esito->scissioni += generati;
+    esito->scorie += scorie_padri + scorie_figli;
+    esito->energia += energia;
+
+    // Compattazione: prima gli atomi non attivati, poi i padri sopravvissuti, infine i figli
+    int m = dimensione - k;
+    memcpy(nuovi->n_atomico, atomi->n_atomico + k, sizeof(int) * m);
+    memcpy(nuovi->stato, atomi->stato + k, m);
+    memcpy(nuovi->tick_nascita, atomi->tick_nascita + k, sizeof(int) * m);
+    memcpy(nuovi->casuale, atomi->casuale + k, sizeof(uint32_t) * m);
+
+    for (int i = 0; i < k; i++)
+    {
+        if (atomi->stato[i] == ATOMO_SCORIA)
+        {
+            continue;
+        }
+        nuovi->n_atomico[m] = atomi->n_atomico[i];
+        nuovi->stato[m] = ATOMO_ATTIVO;
+        nuovi->tick_nascita[m] = atomi->tick_nascita[i];
+        nuovi->casuale[m] = atomi->casuale[i];
+        m++;
+    }
+    for (int i = 0; i < k; i++)
+    {
+        int figlio = popolazione->figli[i];
+        if (figlio < minimo || m == popolazione->capacita)
+        {
+            continue;
+        }
+        nuovi->n_atomico[m] = figlio;
+        nuovi->stato[m] = ATOMO_ATTIVO;
+        nuovi->tick_nascita[m] = popolazione->tick;
+        nuovi->casuale[m] = xorshift32(atomi->casuale[i] ^ 0x9e3779b9u) | 1;
+        m++;
+    }
+
+    colonne_atomi precedenti = *atomi;
+    popolazione->atomi = *nuovi;
+    popolazione->appoggio = precedenti;
+    popolazione->dimensione = m;
+    popolazione->tick++;
+}
@@ -0,0 +1,114 @@
+/**
+ * @file popolazione.h
+ * @brief Popolazione di atomi in memoria, organizzata per colonne.
+ *
+ * Questo file contiene le dichiarazioni del motore che simula gli atomi senza un processo per
+ * atomo: numero atomico, stato, tick di nascita e stato del generatore casuale sono vettori
+ * contigui, e ogni tick esegue tutte le attivazioni con pochi passaggi sui vettori (estrazione
+ * del figlio, energia, controllo delle scorie) che il compilatore può vettorizzare.
+ *
+ * Le regole sono quelle del modello a processi: il figlio ha numero atomico in [1, n - 1], il
+ * padre scende a n - figlio, l'energia è `n * figlio - max(n, figlio)` calcolata sul padre già
+ * ridotto, una scissione senza permesso riduce comunque il padre ma non produce né figlio né
+ * energia, e gli atomi sotto MIN_N_ATOMICO diventano scorie.
+ */
+
+#ifndef POPOLAZIONE_H
+#define POPOLAZIONE_H
+
+#include <stdint.h>
+#include "conf.h"
+
+/**
+ * @brief Stato di un atomo nella colonna `stato`.
+ */
+#define ATOMO_ATTIVO 0
+#define ATOMO_SCORIA 1
+
+/**
+ * @brief Capacità della popolazione quando MAX_ATOMI_ATTIVI non è impostato.
+ */
+#define POPOLAZIONE_MAX_DEFAULT (1 << 20)
+
+/**
+ * @struct colonne_atomi_
+ * @brief Un vettore per ogni attributo degli atomi.
+ */
+typedef struct colonne_atomi_
+{
+    int *n_atomico;
+    unsigned char *stato;
+    int *tick_nascita;
+    uint32_t *casuale;
+} colonne_atomi;
+
+/**
+ * @struct popolazione_atomi_
+ * @brief Popolazione di atomi: colonne correnti, colonne di appoggio per la compattazione e figli del tick.
+ */
+typedef struct popolazione_atomi_
+{
+    colonne_atomi atomi;
+    colonne_atomi appoggio;
+    int *figli;
+    int dimensione;
+    int capacita;
+    int tick;
+    uint32_t seme;
+} popolazione_atomi;
+
+/**
+ * @struct esito_tick_
+ * @brief Contatori di un tick, con lo stesso significato dei messaggi del modello a processi.
+ */
+typedef struct esito_tick_
+{
+    long long attivazioni;
+    long long scissioni;
+    long long scorie;
+    long long energia;
+} esito_tick;
+
+/**
+ * @brief Alloca una popolazione vuota.
+ *
+ * @param popolazione Popolazione da inizializzare
+ * @param capacita Numero massimo di atomi attivi
+ * @param seme Seme del generatore casuale
+ */
+void crea_popolazione(popolazione_atomi *popolazione, int capacita, uint32_t seme);
+
+/**
+ * @brief Libera la memoria della popolazione.
+ *
+ * @param popolazione Popolazione da distruggere
+ */
+void distruggi_popolazione(popolazione_atomi *popolazione);
+
+/**
+ * @brief Aggiunge atomi con numero atomico casuale in [1, n_atom_max], come l'alimentazione.
+ *
+ * Gli atomi sotto MIN_N_ATOMICO diventano subito scorie; oltre la capacità non vengono aggiunti.
+ *
+ * @param popolazione Popolazione
+ * @param quanti Atomi da aggiungere
+ * @param params Parametri della simulazione
+ * @param esito Contatori del tick, dove vengono registrate le scorie
+ * @return Il numero di atomi aggiunti
+ */
+int aggiungi_atomi(popolazione_atomi *popolazione, int quanti, const SimulationParams *params, esito_tick *esito);
+
+/**
+ * @brief Esegue un tick: attiva i primi `attivazioni` atomi (tutti se 0) e compatta la popolazione.
+ *
+ * Gli atomi attivati finiscono in coda alla popolazione, seguiti dai figli, così che i tick
+ * successivi attivino per primi quelli rimasti in attesa.
+ *
+ * @param popolazione Popolazione
+ * @param attivazioni Numero di atomi da attivare, 0 per attivarli tutti
+ * @param params Parametri della simulazione
+ * @param esito Contatori del tick, da azzerare a cura del chiamante
+ */
+void passo_popolazione(popolazione_atomi *popolazione, int attivazioni, const SimulationParams *params, esito_tick *esito);
+
+#endif
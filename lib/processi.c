@@ -0,0 +1,450 @@
+/**
+ * @file processi.c
+ * @brief Implementazione delle funzioni per il ciclo di vita dei processi del reattore.
+ *
+ * Tutti i processi del reattore appartengono a un unico gruppo di processi, così che il master
+ * possa terminarli con un solo segnale. Lo stato di esecuzione è una parola in memoria condivisa
+ * che ogni attesa bloccante ricontrolla entro `ATTESA_STATO_MS` millisecondi.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <string.h>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+#include "processi.h"
+#include "semaphore.h"
+#include "pianificazione.h"
+
+/**
+ * @brief Indica se il reattore è ancora in esecuzione.
+ *
+ * @param memoria Puntatore alla memoria condivisa degli identificatori
+ * @return 1 se la simulazione è in corso, 0 se è stato richiesto l'arresto
+ */
+int reattore_in_corso(shmseg *memoria)
+{
+    return __atomic_load_n(&memoria->stato_reattore, __ATOMIC_ACQUIRE) == REATTORE_IN_CORSO;
+}
+
+/**
+ * @brief Richiede l'arresto di tutti i processi del reattore.
+ *
+ * @param memoria Puntatore alla memoria condivisa degli identificatori
+ */
+void arresta_reattore(shmseg *memoria)
+{
+    __atomic_store_n(&memoria->stato_reattore, REATTORE_IN_ARRESTO, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Attende l'avvio della simulazione.
+ *
+ * Attende che il semaforo di avvio raggiunga lo zero ricontrollando periodicamente lo stato del reattore.
+ *
+ * @param memoria Puntatore alla memoria condivisa degli identificatori
+ * @return 1 se la simulazione è partita, 0 se nel frattempo è stato richiesto l'arresto
+ */
+int attendi_avvio(shmseg *memoria)
+{
+    while (reattore_in_corso(memoria))
+    {
+        int esito = wait_for_zero_sem_timed(memoria->id_start, ATTESA_STATO_MS);
+        if (esito == 0)
+        {
+            return 1;
+        }
+        if (esito == -1)
+        {
+            return 0;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Attende che l'attivatore conceda un'attivazione.
+ *
+ * @param memoria Puntatore alla memoria condivisa degli identificatori
+ * @return 1 se l'attivazione è stata concessa, 0 se è stato richiesto l'arresto
+ */
+int attendi_attivazione(shmseg *memoria)
+{
+    while (reattore_in_corso(memoria))
+    {
+        int esito = decrease_sem_timed(memoria->id_attivatore_sem, ATTESA_STATO_MS);
+        if (esito == 0)
+        {
+            return reattore_in_corso(memoria);
+        }
+        if (esito == -1)
+        {
+            return 0;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Lancia un eseguibile in un processo figlio, nel gruppo di processi richiesto.
+ *
+ * Il gruppo viene impostato sia nel figlio sia nel padre, così che sia già valido quando
+ * uno dei due prosegue.
+ *
+ * @param pathname Percorso dell'eseguibile
+ * @param arg Argomento da passare all'eseguibile (può essere NULL)
+ * @param pgid Gruppo di processi del figlio (0 nuovo gruppo, negativo ereditato)
+ * @return Il PID del figlio, -1 se la fork fallisce
+ */
+pid_t avvia_processo(char *pathname, char *arg, pid_t pgid)
+{
+    char *argomenti[] = {arg, NULL};
+    return avvia_processo_argomenti(pathname, argomenti, pgid);
+}
+
+pid_t avvia_processo_argomenti(char *pathname, char *const argomenti[], pid_t pgid)
+{
+    // argv viene preparato prima della fork: nel figlio resta solo l'exec
+    char *argv[8] = {pathname};
+    for (int i = 0; i < 6 && argomenti[i] != NULL; i++)
+    {
+        argv[i + 1] = argomenti[i];
+    }
+
+    pid_t pid = fork();
+
+    switch (pid)
+    {
+    case -1:
+        perror("Error starting the process");
+        return -1;
+    case 0:
+        if (pgid >= 0)
+        {
+            setpgid(0, pgid);
+        }
+        execvp(pathname, argv);
+        perror("Exec fallito");
+        exit(EXIT_FAILURE);
+    default:
+        if (pgid >= 0)
+        {
+            setpgid(pid, pgid == 0 ? pid : pgid);
+        }
+        return pid;
+    }
+}
+
+/**
+ * @brief Millisecondi trascorsi da un istante di riferimento (CLOCK_MONOTONIC).
+ *
+ * @param inizio Istante di riferimento
+ * @return Millisecondi trascorsi
+ */
+long millisecondi_da(const struct timespec *inizio)
+{
+    return (long)(nanosecondi_da(inizio) / 1000000);
+}
+
+/**
+ * @brief Nanosecondi trascorsi da un istante di riferimento (CLOCK_MONOTONIC).
+ *
+ * @param inizio Istante di riferimento
+ * @return Nanosecondi trascorsi
+ */
+long long nanosecondi_da(const struct timespec *inizio)
+{
+    struct timespec adesso;
+    clock_gettime(CLOCK_MONOTONIC, &adesso);
+    return (adesso.tv_sec - inizio->tv_sec) * 1000000000LL + (adesso.tv_nsec - inizio->tv_nsec);
+}
+
+/**
+ * @brief Calcola da quanti millisecondi esiste un processo.
+ *
+ * Legge l'istante di avvio (campo 22 di `/proc/<pid>/stat`); va chiamata prima di raccogliere
+ * il processo, finché è ancora uno zombie.
+ *
+ * @param pid PID del processo
+ * @return Durata di vita in millisecondi, -1 se non disponibile
+ */
+static long long durata_vita_ms(pid_t pid)
+{
+    char percorso[64];
+    char buffer[512];
+    sprintf(percorso, "/proc/%d/stat", pid);
+
+    int fd = open(percorso, O_RDONLY);
+    if (fd == -1)
+    {
+        return -1;
+    }
+    ssize_t letti = read(fd, buffer, sizeof(buffer) - 1);
+    close(fd);
+    if (letti <= 0)
+    {
+        return -1;
+    }
+    buffer[letti] = '\0';
+
+    // Il nome del comando può contenere spazi: i campi si contano dall'ultima parentesi
+    char *campo = strrchr(buffer, ')');
+    if (campo == NULL)
+    {
+        return -1;
+    }
+    for (int i = 0; i < 20 && campo != NULL; i++)
+    {
+        campo = strchr(campo + 1, ' ');
+    }
+    if (campo == NULL)
+    {
+        return -1;
+    }
+
+    unsigned long long avvio_tick = strtoull(campo + 1, NULL, 10);
+    struct timespec adesso;
+    clock_gettime(CLOCK_BOOTTIME, &adesso);
+    long long adesso_ms = adesso.tv_sec * 1000LL + adesso.tv_nsec / 1000000;
+    long long avvio_ms = (long long)(avvio_tick * 1000ULL / sysconf(_SC_CLK_TCK));
+    return adesso_ms > avvio_ms ? adesso_ms - avvio_ms : 0;
+}
+
+/**
+ * @brief Aggiunge alle statistiche condivise il consumo di risorse di un atomo.
+ *
+ * @param statistiche Statistiche condivise da aggiornare
+ * @param uso Consumo di risorse restituito da `wait4`
+ * @param vita_ms Durata di vita dell'atomo in millisecondi (-1 se non disponibile)
+ * @param scheduler Attesa in coda e fette dell'atomo (NULL se non disponibili)
+ */
+static void registra_atomo(statistiche_atomi *statistiche, const struct rusage *uso, long long vita_ms,
+                           const uso_scheduler *scheduler)
+{
+    __atomic_fetch_add(&statistiche->raccolti, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&statistiche->utime_us, uso->ru_utime.tv_sec * 1000000LL + uso->ru_utime.tv_usec, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&statistiche->stime_us, uso->ru_stime.tv_sec * 1000000LL + uso->ru_stime.tv_usec, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&statistiche->nvcsw, uso->ru_nvcsw, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&statistiche->nivcsw, uso->ru_nivcsw, __ATOMIC_RELAXED);
+
+    long long massimo = __atomic_load_n(&statistiche->max_rss_kb, __ATOMIC_RELAXED);
+    while (uso->ru_maxrss > massimo &&
+           !__atomic_compare_exchange_n(&statistiche->max_rss_kb, &massimo, (long long)uso->ru_maxrss, 0,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        ;
+
+    if (scheduler != NULL)
+    {
+        __atomic_fetch_add(&statistiche->attesa_cpu_us, scheduler->attesa_ns / 1000, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&statistiche->fette, scheduler->fette, __ATOMIC_RELAXED);
+    }
+
+    if (vita_ms >= 0)
+    {
+        int classe = vita_ms < 2 ? 0 : 63 - __builtin_clzll((unsigned long long)vita_ms);
+        if (classe >= N_CLASSI_VITA)
+        {
+            classe = N_CLASSI_VITA - 1;
+        }
+        __atomic_fetch_add(&statistiche->vita_ms_totale, vita_ms, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&statistiche->vita_ms[classe], 1, __ATOMIC_RELAXED);
+    }
+}
+
+/**
+ * @brief Raccoglie un figlio terminato, se presente.
+ *
+ * Il figlio viene prima osservato con `WNOWAIT` per leggerne l'istante di avvio e l'attesa in coda,
+ * poi raccolto con `wait4`.
+ *
+ * @param statistiche Statistiche condivise da aggiornare
+ * @param esclusi PID da non conteggiare (può essere NULL)
+ * @param n_esclusi Numero di elementi di `esclusi`
+ * @return Il PID raccolto, 0 se nessun figlio è terminato, -1 se non esistono figli
+ */
+static pid_t raccogli_uno(statistiche_atomi *statistiche, const pid_t *esclusi, int n_esclusi)
+{
+    siginfo_t info;
+    struct rusage uso;
+    int status;
+
+    info.si_pid = 0;
+    if (waitid(P_ALL, 0, &info, WEXITED | WNOHANG | WNOWAIT) == -1)
+    {
+        if (errno == EINTR)
+        {
+            return 0;
+        }
+        if (errno != ECHILD)
+        {
+            perror("waitid error");
+        }
+        return -1;
+    }
+    if (info.si_pid == 0)
+    {
+        return 0;
+    }
+
+    pid_t pid = info.si_pid;
+    long long vita_ms = durata_vita_ms(pid);
+    uso_scheduler scheduler;
+    int scheduler_letto = leggi_uso_scheduler(pid, &scheduler) == 0;
+    if (wait4(pid, &status, 0, &uso) == -1)
+    {
+        return 0;
+    }
+
+    for (int i = 0; i < n_esclusi; i++)
+    {
+        if (esclusi[i] == pid)
+        {
+            return pid;
+        }
+    }
+    if (statistiche != NULL)
+    {
+        registra_atomo(statistiche, &uso, vita_ms, scheduler_letto ? &scheduler : NULL);
+    }
+    return pid;
+}
+
+/**
+ * @brief Raccoglie senza bloccare i figli terminati registrandone il consumo di risorse.
+ *
+ * @param statistiche Statistiche condivise da aggiornare
+ * @param esclusi PID da non conteggiare (può essere NULL)
+ * @param n_esclusi Numero di elementi di `esclusi`
+ * @return Il numero di figli raccolti
+ */
+int raccogli_figli(statistiche_atomi *statistiche, const pid_t *esclusi, int n_esclusi)
+{
+    int raccolti = 0;
+    while (raccogli_uno(statistiche, esclusi, n_esclusi) > 0)
+    {
+        raccolti++;
+    }
+    return raccolti;
+}
+
+/**
+ * @brief Termina e raccoglie tutti i processi discendenti.
+ *
+ * Il chiamante deve essere subreaper (`PR_SET_CHILD_SUBREAPER`): gli atomi rimasti orfani vengono
+ * riassegnati a lui, quindi quando non ci sono più figli non esiste più alcun discendente.
+ * Durante il periodo di grazia i processi possono terminare da soli osservando la parola di stato,
+ * poi il gruppo riceve SIGTERM. Se alla scadenza restano processi vivi il gruppo viene terminato
+ * con SIGKILL; dopo il doppio della scadenza la raccolta viene comunque interrotta.
+ *
+ * @param pgid Gruppo di processi del reattore
+ * @param grazia_ms Tempo concesso per la terminazione spontanea prima di SIGTERM
+ * @param scadenza_ms Tempo massimo concesso prima della terminazione forzata
+ * @param forzato Impostato a 1 se è stato necessario SIGKILL
+ * @param statistiche Statistiche condivise da aggiornare
+ * @param esclusi PID da non conteggiare tra gli atomi (può essere NULL)
+ * @param n_esclusi Numero di elementi di `esclusi`
+ * @return Il numero di processi raccolti
+ */
+int arresto_processi(pid_t pgid, long grazia_ms, long scadenza_ms, int *forzato,
+                     statistiche_atomi *statistiche, const pid_t *esclusi, int n_esclusi)
+{
+    struct timespec inizio;
+    struct timespec pausa = {0, 1000000};
+    int raccolti = 0;
+    int terminato = 0;
+
+    clock_gettime(CLOCK_MONOTONIC, &inizio);
+    *forzato = 0;
+
+    while (1)
+    {
+        pid_t pid = raccogli_uno(statistiche, esclusi, n_esclusi);
+        if (pid > 0)
+        {
+            raccolti++;
+            continue;
+        }
+        if (pid == -1)
+        {
+            break;
+        }
+
+        long trascorsi = millisecondi_da(&inizio);
+        if (!terminato && trascorsi >= grazia_ms)
+        {
+            if (pgid > 0)
+            {
+                kill(-pgid, SIGTERM);
+            }
+            terminato = 1;
+        }
+        if (!*forzato && trascorsi >= scadenza_ms)
+        {
+            if (pgid > 0)
+            {
+                kill(-pgid, SIGKILL);
+            }
+            *forzato = 1;
+        }
+        else if (trascorsi >= 2 * scadenza_ms)
+        {
+            fprintf(stderr, "Arresto: processi non raccolti dopo %ld ms\n", trascorsi);
+            break;
+        }
+        nanosleep(&pausa, NULL);
+    }
+
+    return raccolti;
+}
+
+/**
+ * @brief Stampa il consumo di risorse aggregato degli atomi raccolti.
+ *
+ * @param statistiche Statistiche da stampare
+ */
+void stampa_statistiche_atomi(const statistiche_atomi *statistiche)
+{
+    long long n = statistiche->raccolti;
+
+    dprintf(1, "\nRISORSE ATOMI: %lld atomi raccolti\n", n);
+    if (n == 0)
+    {
+        return;
+    }
+    dprintf(1, "Tempo CPU: utente %lld ms, sistema %lld ms, medio per atomo %lld us\n",
+            statistiche->utime_us / 1000, statistiche->stime_us / 1000,
+            (statistiche->utime_us + statistiche->stime_us) / n);
+    dprintf(1, "RSS massimo: %lld kB\n", statistiche->max_rss_kb);
+    dprintf(1, "Cambi di contesto volontari: %lld (%.1f per atomo), involontari: %lld (%.1f per atomo)\n",
+            statistiche->nvcsw, (double)statistiche->nvcsw / n,
+            statistiche->nivcsw, (double)statistiche->nivcsw / n);
+    dprintf(1, "Attesa in coda: totale %lld ms, media per atomo %lld us, per fetta %lld us\n",
+            statistiche->attesa_cpu_us / 1000, statistiche->attesa_cpu_us / n,
+            statistiche->fette > 0 ? statistiche->attesa_cpu_us / statistiche->fette : 0);
+    dprintf(1, "Durata di vita media: %lld ms\n", statistiche->vita_ms_totale / n);
+    dprintf(1, "Distribuzione durata di vita:\n");
+    for (int i = 0; i < N_CLASSI_VITA; i++)
+    {
+        if (statistiche->vita_ms[i] == 0)
+        {
+            continue;
+        }
+        if (i == 0)
+        {
+            dprintf(1, "  < 2 ms: %lld\n", statistiche->vita_ms[i]);
+        }
+        else if (i == N_CLASSI_VITA - 1)
+        {
+            dprintf(1, "  >= %lld ms: %lld\n", 1LL << i, statistiche->vita_ms[i]);
+        }
+        else
+        {
+            dprintf(1, "  %lld-%lld ms: %lld\n", 1LL << i, 1LL << (i + 1), statistiche->vita_ms[i]);
+        }
+    }
+}
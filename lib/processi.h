@@ -0,0 +1,135 @@
+/**
+ * @file processi.h
+ * @brief Ciclo di vita dei processi del reattore.
+ *
+ * Questo file contiene le dichiarazioni delle funzioni per avviare i processi del reattore
+ * in un gruppo comune, osservare lo stato di esecuzione condiviso e arrestare tutti i processi
+ * entro una scadenza.
+ */
+
+#ifndef PROCESSI_H
+#define PROCESSI_H
+
+#include <sys/types.h>
+#include <time.h>
+#include "shared_memory.h"
+
+/**
+ * @brief Intervallo massimo (in millisecondi) tra due controlli dello stato del reattore
+ *        durante un'attesa bloccante.
+ */
+#define ATTESA_STATO_MS 100
+
+/**
+ * @brief Indica se il reattore è ancora in esecuzione.
+ *
+ * @param memoria Puntatore alla memoria condivisa degli identificatori
+ * @return 1 se la simulazione è in corso, 0 se è stato richiesto l'arresto
+ */
+int reattore_in_corso(shmseg *memoria);
+
+/**
+ * @brief Richiede l'arresto di tutti i processi del reattore.
+ *
+ * Scrive lo stato di arresto nella parola condivisa osservata da ogni attesa bloccante.
+ *
+ * @param memoria Puntatore alla memoria condivisa degli identificatori
+ */
+void arresta_reattore(shmseg *memoria);
+
+/**
+ * @brief Attende l'avvio della simulazione.
+ *
+ * @param memoria Puntatore alla memoria condivisa degli identificatori
+ * @return 1 se la simulazione è partita, 0 se nel frattempo è stato richiesto l'arresto
+ */
+int attendi_avvio(shmseg *memoria);
+
+/**
+ * @brief Attende che l'attivatore conceda un'attivazione.
+ *
+ * L'attesa viene interrotta periodicamente per osservare lo stato del reattore.
+ *
+ * @param memoria Puntatore alla memoria condivisa degli identificatori
+ * @return 1 se l'attivazione è stata concessa, 0 se è stato richiesto l'arresto
+ */
+int attendi_attivazione(shmseg *memoria);
+
+/**
+ * @brief Lancia un eseguibile in un processo figlio.
+ *
+ * Se `pgid` è 0 il figlio diventa capo di un nuovo gruppo di processi, se è positivo
+ * il figlio entra nel gruppo indicato, se è negativo il gruppo viene ereditato.
+ *
+ * @param pathname Percorso dell'eseguibile
+ * @param arg Argomento da passare all'eseguibile (può essere NULL)
+ * @param pgid Gruppo di processi del figlio
+ * @return Il PID del figlio, -1 se la fork fallisce
+ */
+pid_t avvia_processo(char *pathname, char *arg, pid_t pgid);
+
+/**
+ * @brief Lancia un eseguibile in un processo figlio con più argomenti.
+ *
+ * @param pathname Percorso dell'eseguibile
+ * @param argomenti Argomenti da passare dopo il nome del programma, terminati da NULL
+ * @param pgid Gruppo di processi del figlio, come in `avvia_processo`
+ * @return Il PID del figlio, -1 se la fork fallisce
+ */
+pid_t avvia_processo_argomenti(char *pathname, char *const argomenti[], pid_t pgid);
+
+/**
+ * @brief Raccoglie senza bloccare i figli terminati registrandone il consumo di risorse.
+ *
+ * I figli il cui PID compare in `esclusi` (i processi di controllo) vengono raccolti senza
+ * essere conteggiati tra gli atomi.
+ *
+ * @param statistiche Statistiche condivise da aggiornare
+ * @param esclusi PID da non conteggiare (può essere NULL)
+ * @param n_esclusi Numero di elementi di `esclusi`
+ * @return Il numero di figli raccolti
+ */
+int raccogli_figli(statistiche_atomi *statistiche, const pid_t *esclusi, int n_esclusi);
+
+/**
+ * @brief Termina e raccoglie tutti i processi discendenti.
+ *
+ * Dopo il periodo di grazia invia SIGTERM al gruppo `pgid` e raccoglie i figli registrandone
+ * il consumo di risorse; se alla scadenza restano processi vivi, il gruppo viene terminato con SIGKILL.
+ *
+ * @param pgid Gruppo di processi del reattore
+ * @param grazia_ms Tempo concesso per la terminazione spontanea prima di SIGTERM
+ * @param scadenza_ms Tempo massimo concesso prima della terminazione forzata
+ * @param forzato Impostato a 1 se è stato necessario SIGKILL
+ * @param statistiche Statistiche condivise da aggiornare
+ * @param esclusi PID da non conteggiare tra gli atomi (può essere NULL)
+ * @param n_esclusi Numero di elementi di `esclusi`
+ * @return Il numero di processi raccolti
+ */
+int arresto_processi(pid_t pgid, long grazia_ms, long scadenza_ms, int *forzato,
+                     statistiche_atomi *statistiche, const pid_t *esclusi, int n_esclusi);
+
+/**
+ * @brief Stampa il consumo di risorse aggregato degli atomi raccolti.
+ *
+ * @param statistiche Statistiche da stampare
+ */
+void stampa_statistiche_atomi(const statistiche_atomi *statistiche);
+
+/**
+ * @brief Millisecondi trascorsi da un istante di riferimento (CLOCK_MONOTONIC).
+ *
+ * @param inizio Istante di riferimento
+ * @return Millisecondi trascorsi
+ */
+long millisecondi_da(const struct timespec *inizio);
+
+/**
+ * @brief Nanosecondi trascorsi da un istante di riferimento (CLOCK_MONOTONIC).
+ *
+ * @param inizio Istante di riferimento
+ * @return Nanosecondi trascorsi
+ */
+long long nanosecondi_da(const struct timespec *inizio);
+
+#endif
@@ -0,0 +1,129 @@
+/**
+ * @file registro.c
+ * @brief Implementazione del registro binario degli eventi.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "registro.h"
+#include "processi.h"
+
+int apri_registro(registro_eventi *registro, const char *percorso, const stato_iniziale *iniziale)
+{
+    registro->capacita = REGISTRO_MAX_EVENTI;
+    registro->dimensione_mappa = sizeof(intestazione_registro) + sizeof(evento) * registro->capacita;
+    registro->fd = open(percorso, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (registro->fd == -1)
+    {
+        perror("Errore nel creare il registro");
+        return -1;
+    }
+    // Il file resta sparso: occupa spazio solo per gli eventi effettivamente scritti
+    if (ftruncate(registro->fd, registro->dimensione_mappa) == -1)
+    {
+        perror("ftruncate error");
+        close(registro->fd);
+        return -1;
+    }
+    void *mappa = mmap(NULL, registro->dimensione_mappa, PROT_READ | PROT_WRITE, MAP_SHARED, registro->fd, 0);
+    if (mappa == MAP_FAILED)
+    {
+        perror("mmap error");
+        close(registro->fd);
+        return -1;
+    }
+
+    registro->intestazione = mappa;
+    registro->eventi = (evento *)((char *)mappa + sizeof(intestazione_registro));
+    registro->intestazione->magic = REGISTRO_MAGIC;
+    registro->intestazione->versione = REGISTRO_VERSIONE;
+    registro->intestazione->n_eventi = 0;
+    registro->intestazione->eventi_persi = 0;
+    registro->intestazione->iniziale = *iniziale;
+    clock_gettime(CLOCK_MONOTONIC, &registro->inizio);
+    return 0;
+}
+
+void registra_evento(registro_eventi *registro, uint8_t tipo, int32_t valore)
+{
+    if (registro->intestazione == NULL)
+    {
+        return;
+    }
+    uint64_t i = __atomic_fetch_add(&registro->intestazione->n_eventi, 1, __ATOMIC_RELAXED);
+    if (i >= registro->capacita)
+    {
+        __atomic_fetch_sub(&registro->intestazione->n_eventi, 1, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&registro->intestazione->eventi_persi, 1, __ATOMIC_RELAXED);
+        return;
+    }
+    evento *e = &registro->eventi[i];
+    e->tempo_us = (uint32_t)(nanosecondi_da(&registro->inizio) / 1000);
+    e->valore = valore;
+    e->tipo = tipo;
+}
+
+void chiudi_registro(registro_eventi *registro)
+{
+    if (registro->intestazione == NULL)
+    {
+        return;
+    }
+    uint64_t n_eventi = registro->intestazione->n_eventi;
+    munmap(registro->intestazione, registro->dimensione_mappa);
+    if (ftruncate(registro->fd, sizeof(intestazione_registro) + sizeof(evento) * n_eventi) == -1)
+    {
+        perror("ftruncate error");
+    }
+    close(registro->fd);
+    registro->intestazione = NULL;
+}
+
+int leggi_registro(registro_eventi *registro, const char *percorso)
+{
+    struct stat info;
+    registro->fd = open(percorso, O_RDONLY);
+    if (registro->fd == -1 || fstat(registro->fd, &info) == -1)
+    {
+        perror("Errore nell'aprire il registro");
+        return -1;
+    }
+    if ((size_t)info.st_size < sizeof(intestazione_registro))
+    {
+        fprintf(stderr, "%s non è un registro di eventi\n", percorso);
+        close(registro->fd);
+        return -1;
+    }
+
+    registro->dimensione_mappa = info.st_size;
+    void *mappa = mmap(NULL, registro->dimensione_mappa, PROT_READ, MAP_PRIVATE, registro->fd, 0);
+    if (mappa == MAP_FAILED)
+    {
+        perror("mmap error");
+        close(registro->fd);
+        return -1;
+    }
+    registro->intestazione = mappa;
+    registro->eventi = (evento *)((char *)mappa + sizeof(intestazione_registro));
+    registro->capacita = (info.st_size - sizeof(intestazione_registro)) / sizeof(evento);
+
+    if (registro->intestazione->magic != REGISTRO_MAGIC || registro->intestazione->versione != REGISTRO_VERSIONE ||
+        registro->intestazione->n_eventi > registro->capacita)
+    {
+        fprintf(stderr, "%s non è un registro compatibile con questa versione\n", percorso);
+        rilascia_registro(registro);
+        return -1;
+    }
+    return 0;
+}
+
+void rilascia_registro(registro_eventi *registro)
+{
+    munmap(registro->intestazione, registro->dimensione_mappa);
+    close(registro->fd);
+    registro->intestazione = NULL;
+}
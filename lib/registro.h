@@ -0,0 +1,150 @@
+/**
+ * @file registro.h
+ * @brief Registro binario degli eventi consumati dal master.
+ *
+ * Questo file contiene le dichiarazioni del registro su file mappato in memoria in cui il master
+ * accoda ogni evento letto dalla coda (energia, scissione, scoria, attivazione, variazione degli
+ * atomi attivi, causa di terminazione) insieme ai tick e ai cambi di stato dell'inibitore, con
+ * l'istante in microsecondi dall'inizio della simulazione. Il registro può poi essere riprodotto
+ * dal master senza generare atomi (`bin/master --replay <file>`).
+ */
+
+#ifndef REGISTRO_H
+#define REGISTRO_H
+
+#include <stdint.h>
+#include <time.h>
+
+/**
+ * @brief Variabile d'ambiente con il percorso del registro: se impostata il master registra gli eventi.
+ */
+#define VARIABILE_REGISTRO "REATTORE_REGISTRO"
+
+/**
+ * @brief Identifica i file di registro ("RREG").
+ */
+#define REGISTRO_MAGIC 0x47455252u
+
+#define REGISTRO_VERSIONE 1
+
+/**
+ * @brief Numero massimo di eventi: il file viene creato sparso con questa capacità e ridotto alla chiusura.
+ */
+#define REGISTRO_MAX_EVENTI (16 * 1024 * 1024)
+
+/**
+ * @brief Tipi di evento. I primi riprendono i tipi dei messaggi a intero che precedevano i record
+ * di evento: un record di scissione viene registrato come scissione più energia.
+ */
+#define EVENTO_ATOMI 4
+#define EVENTO_ENERGIA 5
+#define EVENTO_SCISSIONE 9
+#define EVENTO_SCORIA 10
+#define EVENTO_ATTIVAZIONE 12
+#define EVENTO_TERMINAZIONE 15
+#define EVENTO_TICK 100
+#define EVENTO_INIBITORE 101
+
+/**
+ * @struct evento_
+ * @brief Un evento del registro (9 byte).
+ */
+typedef struct __attribute__((packed)) evento_
+{
+    uint32_t tempo_us;
+    int32_t valore;
+    uint8_t tipo;
+} evento;
+
+/**
+ * @struct stato_iniziale_
+ * @brief Valori della simulazione all'apertura del registro, diversi da zero dopo un ripristino.
+ */
+typedef struct stato_iniziale_
+{
+    int32_t tempo_passato;
+    int32_t energia_totale;
+    int32_t energia_prelevata;
+    int32_t energia_assorbita;
+    int32_t atomi_attivi;
+    int32_t num_scissioni;
+    int32_t num_scorie;
+    int32_t num_attivazioni;
+    int32_t inibitore_avviato;
+    int32_t inibitore_attivo;
+} stato_iniziale;
+
+/**
+ * @struct intestazione_registro_
+ * @brief Intestazione del file, seguita dagli eventi.
+ */
+typedef struct intestazione_registro_
+{
+    uint32_t magic;
+    uint32_t versione;
+    uint64_t n_eventi;
+    uint64_t eventi_persi;
+    stato_iniziale iniziale;
+} intestazione_registro;
+
+/**
+ * @struct registro_eventi_
+ * @brief Registro aperto, in scrittura o in lettura.
+ */
+typedef struct registro_eventi_
+{
+    intestazione_registro *intestazione;
+    evento *eventi;
+    uint64_t capacita;
+    size_t dimensione_mappa;
+    int fd;
+    struct timespec inizio;
+} registro_eventi;
+
+/**
+ * @brief Crea un registro vuoto e lo mappa in memoria.
+ *
+ * @param registro Registro da inizializzare
+ * @param percorso File da creare
+ * @param iniziale Stato della simulazione all'apertura
+ * @return 0 in caso di successo, -1 in caso di errore
+ */
+int apri_registro(registro_eventi *registro, const char *percorso, const stato_iniziale *iniziale);
+
+/**
+ * @brief Accoda un evento.
+ *
+ * Può essere chiamata anche da un gestore di segnale che interrompe un'altra chiamata: ogni
+ * chiamata riserva il proprio posto con un'operazione atomica. A registro pieno l'evento viene
+ * contato come perso.
+ *
+ * @param registro Registro aperto in scrittura
+ * @param tipo Tipo dell'evento
+ * @param valore Valore dell'evento
+ */
+void registra_evento(registro_eventi *registro, uint8_t tipo, int32_t valore);
+
+/**
+ * @brief Chiude il registro riducendo il file agli eventi scritti.
+ *
+ * @param registro Registro aperto in scrittura
+ */
+void chiudi_registro(registro_eventi *registro);
+
+/**
+ * @brief Mappa in lettura un registro esistente.
+ *
+ * @param registro Registro da inizializzare
+ * @param percorso File da leggere
+ * @return 0 in caso di successo, -1 se il file manca o non è compatibile
+ */
+int leggi_registro(registro_eventi *registro, const char *percorso);
+
+/**
+ * @brief Rilascia un registro aperto in lettura.
+ *
+ * @param registro Registro da rilasciare
+ */
+void rilascia_registro(registro_eventi *registro);
+
+#endif
@@ -0,0 +1,118 @@
+/**
+ * @file report.c
+ * @brief Implementazione della scrittura e lettura del resoconto finale.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "report.h"
+
+const char *nome_esito(int causa)
+{
+    static const char *nomi[N_ESITI] = {"TIMEOUT", "EXPLODE", "BLACKOUT", "MELTDOWN"};
+    if (causa < 0 || causa >= N_ESITI)
+    {
+        return "SCONOSCIUTO";
+    }
+    return nomi[causa];
+}
+
+int scrivi_report(const char *percorso, const report_simulazione *report)
+{
+    FILE *file = fopen(percorso, "w");
+    if (file == NULL)
+    {
+        perror("Errore nell'aprire il file del resoconto");
+        return -1;
+    }
+
+    fprintf(file, "ISTANZA = %d\n", report->istanza);
+    fprintf(file, "CAUSA_TERMINAZIONE = %d // %s\n", report->causa_terminazione, nome_esito(report->causa_terminazione));
+    fprintf(file, "TEMPO_PASSATO = %d\n", report->tempo_passato);
+    fprintf(file, "ENERGIA_TOTALE = %lld\n", report->energia_totale);
+    fprintf(file, "ENERGIA_PRELEVATA = %lld\n", report->energia_prelevata);
+    fprintf(file, "ENERGIA_ASSORBITA = %lld\n", report->energia_assorbita);
+    fprintf(file, "SCISSIONI = %lld\n", report->scissioni);
+    fprintf(file, "SCORIE = %lld\n", report->scorie);
+    fprintf(file, "ATTIVAZIONI = %lld\n", report->attivazioni);
+    fprintf(file, "ATOMI_RACCOLTI = %lld\n", report->atomi_raccolti);
+    fprintf(file, "FORK_EVITATE = %lld\n", report->fork_evitate);
+    fprintf(file, "TEMPO_CPU_MS = %lld\n", report->tempo_cpu_ms);
+    fprintf(file, "DURATA_ARRESTO_MS = %ld\n", report->durata_arresto_ms);
+
+    fclose(file);
+    return 0;
+}
+
+int leggi_report(const char *percorso, report_simulazione *report)
+{
+    FILE *file = fopen(percorso, "r");
+    if (file == NULL)
+    {
+        return -1;
+    }
+
+    memset(report, 0, sizeof(report_simulazione));
+    report->causa_terminazione = -1;
+
+    char line[256];
+    while (fgets(line, sizeof(line), file))
+    {
+        if (sscanf(line, "ISTANZA = %d", &report->istanza) == 1)
+        {
+            continue;
+        }
+        if (sscanf(line, "CAUSA_TERMINAZIONE = %d", &report->causa_terminazione) == 1)
+        {
+            continue;
+        }
+        if (sscanf(line, "TEMPO_PASSATO = %d", &report->tempo_passato) == 1)
+        {
+            continue;
+        }
+        if (sscanf(line, "ENERGIA_TOTALE = %lld", &report->energia_totale) == 1)
+        {
+            continue;
+        }
+        if (sscanf(line, "ENERGIA_PRELEVATA = %lld", &report->energia_prelevata) == 1)
+        {
+            continue;
+        }
+        if (sscanf(line, "ENERGIA_ASSORBITA = %lld", &report->energia_assorbita) == 1)
+        {
+            continue;
+        }
+        if (sscanf(line, "SCISSIONI = %lld", &report->scissioni) == 1)
+        {
+            continue;
+        }
+        if (sscanf(line, "SCORIE = %lld", &report->scorie) == 1)
+        {
+            continue;
+        }
+        if (sscanf(line, "ATTIVAZIONI = %lld", &report->attivazioni) == 1)
+        {
+            continue;
+        }
+        if (sscanf(line, "TEMPO_CPU_MS = %lld", &report->tempo_cpu_ms) == 1)
+        {
+            continue;
+        }
+        if (sscanf(line, "ATOMI_RACCOLTI = %lld", &report->atomi_raccolti) == 1)
+        {
+            continue;
+        }
+        if (sscanf(line, "FORK_EVITATE = %lld", &report->fork_evitate) == 1)
+        {
+            continue;
+        }
+        if (sscanf(line, "DURATA_ARRESTO_MS = %ld", &report->durata_arresto_ms) == 1)
+        {
+            continue;
+        }
+    }
+
+    fclose(file);
+    // Una causa fuori dall'intervallo (file corrotto o di una versione successiva) non è un esito valido
+    return report->causa_terminazione >= 0 && report->causa_terminazione < N_ESITI ? 0 : -1;
+}
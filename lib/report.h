@@ -0,0 +1,71 @@
+/**
+ * @file report.h
+ * @brief Resoconto finale di una simulazione in formato leggibile da altri programmi.
+ *
+ * Questo file contiene la struttura del resoconto scritto dal master a fine simulazione e le
+ * dichiarazioni delle funzioni per scriverlo e rileggerlo. Il formato è quello dei file di
+ * configurazione: una riga `CHIAVE = valore` per ogni campo.
+ */
+
+#ifndef REPORT_H
+#define REPORT_H
+
+/**
+ * @brief Variabile d'ambiente con il percorso in cui il master scrive il resoconto finale.
+ */
+#define VARIABILE_REPORT "REATTORE_REPORT"
+
+/**
+ * @brief Numero di cause di terminazione (TIMEOUT, EXPLODE, BLACKOUT, MELTDOWN).
+ */
+#define N_ESITI 4
+
+/**
+ * @struct report_simulazione_
+ * @brief Valori finali di una simulazione.
+ */
+typedef struct report_simulazione_
+{
+    int istanza;
+    int causa_terminazione;
+    int tempo_passato;
+    long long energia_totale;
+    long long energia_prelevata;
+    long long energia_assorbita;
+    long long scissioni;
+    long long scorie;
+    long long attivazioni;
+    long long atomi_raccolti;
+    long long fork_evitate;
+    long long tempo_cpu_ms;
+    long durata_arresto_ms;
+} report_simulazione;
+
+/**
+ * @brief Restituisce il nome di una causa di terminazione.
+ *
+ * @param causa Causa di terminazione (0 TIMEOUT, 1 EXPLODE, 2 BLACKOUT, 3 MELTDOWN)
+ * @return Il nome della causa, "SCONOSCIUTO" se non valida
+ */
+const char *nome_esito(int causa);
+
+/**
+ * @brief Scrive il resoconto nel file indicato.
+ *
+ * @param percorso Percorso del file
+ * @param report Resoconto da scrivere
+ * @return 0 in caso di successo, -1 in caso di errore
+ */
+int scrivi_report(const char *percorso, const report_simulazione *report);
+
+/**
+ * @brief Legge un resoconto scritto da `scrivi_report`.
+ *
+ * @param percorso Percorso del file
+ * @param report Resoconto da riempire
+ * @return 0 in caso di successo, -1 se il file non esiste, non è leggibile o la causa di
+ *         terminazione manca o non è tra le N_ESITI note
+ */
+int leggi_report(const char *percorso, report_simulazione *report);
+
+#endif
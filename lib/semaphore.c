@@ -16,7 +16,9 @@
 #include <errno.h>
 #include <sys/ipc.h>
 #include <sys/sem.h>
+#include <time.h>
 #include "semaphore.h"
+#include "istanza.h"
 
 /**
  * @union semun
@@ -35,37 +37,41 @@ union semun
 /**
  * @brief Crea un nuovo semaforo.
  *
- * Genera una chiave unica con `ftok` utilizzando il percorso specificato, quindi crea
+ * Genera una chiave unica con `ftok` utilizzando il percorso e l'istanza specificati, quindi crea
  * un semaforo con `semget`. Inizializza il valore del semaforo a 0.
- * Se la creazione fallisce, stampa un errore e termina il programma.
+ * Se il semaforo esiste già, un'altra istanza con lo stesso identificativo è in esecuzione
+ * (o non ha rimosso i propri oggetti IPC): invece di riutilizzarlo il programma termina.
  *
  * @param pathname Percorso per generare la chiave unica del semaforo
+ * @param istanza Identificativo dell'istanza del reattore
  * @return Identificatore del semaforo creato (int)
  */
-int create_sem(char *pathname)
+int create_sem(char *pathname, int istanza)
 {
     int semid;
     union semun arg;
     arg.val = 0;
-    key_t key = ftok(pathname, 'x');
+    key_t key = chiave_ipc(pathname, istanza);
 
-    semid = semget(key, 1, 0666);
+    semid = semget(key, 1, IPC_CREAT | IPC_EXCL | 0666);
 
     if (semid == -1)
     {
-        semid = semget(key, 1, IPC_CREAT | 0666);
-
-        if (semid == -1)
+        if (errno == EEXIST)
         {
-            perror("Error creating the semaphore");
-            exit(1);
+            fprintf(stderr, "Semaforo dell'istanza %d già esistente: istanza in uso o non rimossa (ipcrm)\n", istanza);
         }
-
-        if (semctl(semid, 0, SETVAL, arg) == -1)
+        else
         {
-            perror("Error initializing the semaphore");
-            exit(1);
+            perror("Error creating the semaphore");
         }
+        exit(1);
+    }
+
+    if (semctl(semid, 0, SETVAL, arg) == -1)
+    {
+        perror("Error initializing the semaphore");
+        exit(1);
     }
     return semid;
 }
@@ -90,7 +96,7 @@ int increase_sem(int semid)
         if (errno == EINTR)
         {
             // Signal was received, but SA_RESTART will restart the system call
-            return decrease_sem(semid);
+            return increase_sem(semid);
         }
         else
         {
@@ -171,17 +177,179 @@ int wait_for_zero_sem(int semid)
         if (errno == EINTR)
         {
             // Signal was received, but SA_RESTART will restart the system call
-            return decrease_sem(semid);
+            return wait_for_zero_sem(semid);
         }
         else
         {
-            perror("Error during decrease operation on semaphore");
+            perror("Error during wait for zero operation on semaphore");
             return -1;
         }
     }
     return 0;
 }
 
+/**
+ * @brief Esegue un'operazione sul semaforo con un tempo massimo di attesa.
+ *
+ * Usa `semtimedop`: l'attesa termina allo scadere di `timeout_ms` oppure all'arrivo di un segnale,
+ * così che il chiamante possa ricontrollare lo stato del reattore.
+ *
+ * @param semid Identificatore del semaforo
+ * @param op Operazione da eseguire (-1 decremento, 0 attesa dello zero)
+ * @param timeout_ms Tempo massimo di attesa in millisecondi
+ * @return 0 se l'operazione è stata eseguita, 1 se l'attesa è scaduta o è stata interrotta,
+ *         -1 se il semaforo non esiste più o in caso di errore
+ */
+static int timed_sem_op(int semid, short op, long timeout_ms)
+{
+    struct sembuf sem;
+    struct timespec timeout;
+    sem.sem_num = 0;
+    sem.sem_op = op;
+    sem.sem_flg = 0;
+    timeout.tv_sec = timeout_ms / 1000;
+    timeout.tv_nsec = (timeout_ms % 1000) * 1000000;
+
+    if (semtimedop(semid, &sem, 1, &timeout) == -1)
+    {
+        if (errno == EAGAIN || errno == EINTR)
+        {
+            return 1;
+        }
+        if (errno != EIDRM && errno != EINVAL)
+        {
+            perror("Error during timed operation on semaphore");
+        }
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Decrementa il valore del semaforo di 1 attendendo al massimo `timeout_ms` millisecondi.
+ *
+ * @param semid Identificatore del semaforo da decrementare
+ * @param timeout_ms Tempo massimo di attesa in millisecondi
+ * @return 0 se il semaforo è stato decrementato, 1 se l'attesa è scaduta o interrotta, -1 in caso di errore
+ */
+int decrease_sem_timed(int semid, long timeout_ms)
+{
+    return timed_sem_op(semid, -1, timeout_ms);
+}
+
+/**
+ * @brief Attende che il semaforo raggiunga lo zero per al massimo `timeout_ms` millisecondi.
+ *
+ * @param semid Identificatore del semaforo
+ * @param timeout_ms Tempo massimo di attesa in millisecondi
+ * @return 0 se il semaforo vale zero, 1 se l'attesa è scaduta o interrotta, -1 in caso di errore
+ */
+int wait_for_zero_sem_timed(int semid, long timeout_ms)
+{
+    return timed_sem_op(semid, 0, timeout_ms);
+}
+
+/**
+ * @brief Tenta di decrementare il semaforo di 1 senza bloccare.
+ *
+ * @param semid Identificatore del semaforo
+ * @return 0 se il semaforo è stato decrementato, 1 se valeva zero, -1 in caso di errore
+ */
+int try_decrease_sem(int semid)
+{
+    struct sembuf sem;
+    sem.sem_num = 0;
+    sem.sem_op = -1;
+    sem.sem_flg = IPC_NOWAIT;
+
+    if (semop(semid, &sem, 1) == -1)
+    {
+        if (errno == EAGAIN || errno == EINTR)
+        {
+            return 1;
+        }
+        if (errno != EIDRM && errno != EINVAL)
+        {
+            perror("Error during non-blocking decrease operation on semaphore");
+        }
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Incrementa il valore del semaforo di `n` con un'unica operazione.
+ *
+ * @param semid Identificatore del semaforo
+ * @param n Quantità da aggiungere (positiva)
+ * @return 0 se l'operazione ha successo, -1 in caso di errore
+ */
+int add_sem(int semid, int n)
+{
+    struct sembuf sem;
+    sem.sem_num = 0;
+    sem.sem_op = n;
+    sem.sem_flg = 0;
+
+    if (n <= 0)
+    {
+        return 0;
+    }
+    if (semop(semid, &sem, 1) == -1)
+    {
+        if (errno == EINTR)
+        {
+            return add_sem(semid, n);
+        }
+        perror("Error during add operation on semaphore");
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Riporta il semaforo al più a `massimo` ritirando i gettoni in eccesso.
+ *
+ * Ogni ritiro toglie `massimo + 1` gettoni e ne restituisce `massimo` nella stessa semop, che il
+ * kernel applica per intero o per niente: con IPC_NOWAIT riesce solo se il valore supera ancora
+ * `massimo`, così un consumo concorrente tra due ritiri non porta mai il semaforo sotto `massimo`.
+ *
+ * @param semid Identificatore del semaforo
+ * @param massimo Valore massimo da lasciare nel semaforo
+ * @return Gettoni ritirati, -1 in caso di errore
+ */
+int trim_sem(int semid, int massimo)
+{
+    struct sembuf sem[2];
+    sem[0].sem_num = 0;
+    sem[0].sem_op = -(massimo + 1);
+    sem[0].sem_flg = IPC_NOWAIT;
+    sem[1].sem_num = 0;
+    sem[1].sem_op = massimo;
+    sem[1].sem_flg = IPC_NOWAIT;
+
+    // Con massimo 0 la seconda operazione sarebbe un'attesa dello zero: basta la prima
+    int operazioni = massimo > 0 ? 2 : 1;
+    int ritirati = 0;
+    while (1)
+    {
+        if (semop(semid, sem, operazioni) == 0)
+        {
+            ritirati++;
+            continue;
+        }
+        if (errno == EAGAIN)
+        {
+            return ritirati;
+        }
+        if (errno != EINTR)
+        {
+            perror("Error during trim operation on semaphore");
+            return -1;
+        }
+    }
+}
+
 /**
  * @brief Ottiene il valore attuale del semaforo.
  *
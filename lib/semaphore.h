@@ -12,13 +12,14 @@
 /**
  * @brief Crea un nuovo semaforo.
  *
- * Utilizza un percorso per generare una chiave unica per il semaforo e crea un nuovo semaforo
- * utilizzando tale chiave.
+ * Utilizza un percorso e l'istanza del reattore per generare una chiave unica per il semaforo
+ * e crea un nuovo semaforo utilizzando tale chiave. Il semaforo non deve esistere già.
  *
  * @param pathname Percorso per generare la chiave unica del semaforo
+ * @param istanza Identificativo dell'istanza del reattore
  * @return Identificatore del semaforo creato (int)
  */
-int create_sem(char *pathname);
+int create_sem(char *pathname, int istanza);
 
 /**
  * @brief Incrementa il valore del semaforo.
@@ -60,6 +61,56 @@ int remove_sem(int semid);
  */
 int wait_for_zero_sem(int semid);
 
+/**
+ * @brief Decrementa il valore del semaforo con un tempo massimo di attesa.
+ *
+ * L'attesa si interrompe allo scadere del tempo o all'arrivo di un segnale.
+ *
+ * @param semid Identificatore del semaforo da decrementare
+ * @param timeout_ms Tempo massimo di attesa in millisecondi
+ * @return 0 se il semaforo è stato decrementato, 1 se l'attesa è scaduta o interrotta, -1 in caso di errore
+ */
+int decrease_sem_timed(int semid, long timeout_ms);
+
+/**
+ * @brief Attende che il semaforo raggiunga il valore zero con un tempo massimo di attesa.
+ *
+ * @param semid Identificatore del semaforo
+ * @param timeout_ms Tempo massimo di attesa in millisecondi
+ * @return 0 se il semaforo vale zero, 1 se l'attesa è scaduta o interrotta, -1 in caso di errore
+ */
+int wait_for_zero_sem_timed(int semid, long timeout_ms);
+
+/**
+ * @brief Tenta di decrementare il semaforo di 1 senza bloccare.
+ *
+ * @param semid Identificatore del semaforo
+ * @return 0 se il semaforo è stato decrementato, 1 se valeva zero, -1 in caso di errore
+ */
+int try_decrease_sem(int semid);
+
+/**
+ * @brief Incrementa il valore del semaforo di `n` con un'unica operazione.
+ *
+ * @param semid Identificatore del semaforo
+ * @param n Quantità da aggiungere
+ * @return Stato dell'operazione (int)
+ */
+int add_sem(int semid, int n);
+
+/**
+ * @brief Riporta il semaforo al più a `massimo` ritirando i gettoni in eccesso.
+ *
+ * I gettoni vengono ritirati uno alla volta con un'operazione che riesce solo se il valore supera
+ * `massimo`, invece di sovrascrivere il valore: i gettoni consumati o aggiunti nel frattempo da
+ * altri processi non vengono né ritirati due volte né cancellati.
+ *
+ * @param semid Identificatore del semaforo
+ * @param massimo Valore massimo da lasciare nel semaforo
+ * @return Gettoni ritirati, -1 in caso di errore
+ */
+int trim_sem(int semid, int massimo);
+
 /**
  * @brief Ottiene il valore attuale del semaforo.
  *
@@ -12,21 +12,23 @@
 #include <sys/types.h>
 #include <sys/shm.h>
 #include "shared_memory.h"
+#include "istanza.h"
 
 /**
  * @brief Crea un nuovo segmento di memoria condivisa.
  *
- * Utilizza un percorso e un carattere identificativo per generare una chiave unica tramite `ftok`,
+ * Utilizza un percorso e l'istanza del reattore per generare una chiave unica tramite `ftok`,
  * quindi crea il segmento di memoria condivisa con `shmget`. Se la creazione fallisce, stampa un
  * errore e termina il programma.
  *
  * @param pathname Percorso per generare la chiave della memoria condivisa
+ * @param istanza Identificativo dell'istanza del reattore
  * @param size Dimensione in byte del segmento di memoria condivisa
  * @return Identificatore del segmento di memoria condivisa creato (int)
  */
-int create_shared_memory(char *pathname, size_t size)
+int create_shared_memory(char *pathname, int istanza, size_t size)
 {
-    key_t key = ftok(pathname, 'x');
+    key_t key = chiave_ipc(pathname, istanza);
     int id = shmget(key, size, IPC_CREAT | 0666);
     if (id == -1)
     {
@@ -10,47 +10,193 @@
 #ifndef SHARED_MEMORY_H
 #define SHARED_MEMORY_H
 
+#include <stddef.h>
+#include <sys/types.h>
+
+/**
+ * @brief Valori della parola di stato condivisa `stato_reattore`.
+ */
+#define REATTORE_IN_CORSO 0
+#define REATTORE_IN_ARRESTO 1
+
+/**
+ * @brief Code di messaggi del reattore: una per i record dei processi di controllo
+ * (alimentazione, attivatore, terminazioni) e `N_CODE_ATOMI` per quelli degli atomi,
+ * assegnati per PID del processo che invia.
+ */
+#define CODA_CONTROLLO 0
+#define N_CODE_ATOMI 4
+#define N_CODE (1 + N_CODE_ATOMI)
+
+/**
+ * @brief Numero massimo di processi ospite degli atomi (vedi lib/ospiti.h).
+ */
+#define N_OSPITI_MAX 64
+
 /**
  * @struct shmseg_
  * @brief Struttura per rappresentare un segmento di memoria condivisa.
  *
  * La struttura `shmseg` contiene gli identificatori necessari per la comunicazione
- * e sincronizzazione tramite memoria condivisa e semafori tra i processi.
+ * e sincronizzazione tramite memoria condivisa e semafori tra i processi, il gruppo di
+ * processi del reattore e la parola di stato osservata da ogni attesa bloccante.
  */
 typedef struct shmseg_
 {
-    int id_queue;
-    int id_semaphore;
+    int id_code[N_CODE];
+    int id_arena_lignaggi;
+    int id_coda_ospiti;
+    int n_ospiti; // 0: un processo per atomo
     int id_attivatore_sem;
     int id_start;
-    int sem_blocca_master;
-    int sem_blocca_inib;
-    int sem_sezione_critica_inib;
     int sem_scissione;
+    pid_t pgid_reattore;
+    int stato_reattore;
 } shmseg;
 
+/**
+ * @brief Numero di classi dell'istogramma della durata di vita degli atomi.
+ *
+ * La classe 0 raccoglie le durate inferiori a 2 ms, la classe i (i > 0) quelle in [2^i, 2^(i+1)) ms,
+ * l'ultima classe tutte le durate superiori.
+ */
+#define N_CLASSI_VITA 16
+
+/**
+ * @struct statistiche_atomi_
+ * @brief Consumo di risorse aggregato degli atomi raccolti con `wait4`.
+ *
+ * I campi vengono aggiornati con operazioni atomiche da qualsiasi processo raccolga un atomo.
+ */
+typedef struct statistiche_atomi_
+{
+    long long raccolti;
+    long long utime_us;
+    long long stime_us;
+    long long max_rss_kb;
+    long long nvcsw;
+    long long nivcsw;
+    long long attesa_cpu_us;
+    long long fette;
+    long long vita_ms_totale;
+    long long vita_ms[N_CLASSI_VITA];
+} statistiche_atomi;
+
+/**
+ * @brief Numero di classi dell'istogramma degli atomi vivi per numero atomico.
+ *
+ * La configurazione rifiuta N_ATOM_MAX oltre N_ATOMICO_MAX - 1: ogni atomo ha la propria classe.
+ */
+#define N_ATOMICO_MAX 1024
+
+/**
+ * @brief Intervalli di controllo conservati nella finestra della previsione dell'inibitore.
+ */
+#define FINESTRA_PREVISIONE 128
+
+/**
+ * @struct previsione_energia_
+ * @brief Finestra scorrevole della produzione per intervallo e previsione dell'inibitore.
+ *
+ * Il master accumula i totali `energia_prodotta` e `scissioni` a ogni record; l'inibitore, unico
+ * scrittore del resto della struttura, ne ricava a ogni passo la produzione dell'intervallo,
+ * la confronta con la previsione precedente e prevede l'intervallo successivo.
+ */
+typedef struct previsione_energia_
+{
+    long long energia_prodotta;
+    long long scissioni;
+    long long energia_prodotta_letta;
+    long long scissioni_lette;
+    int energia[FINESTRA_PREVISIONE];
+    int scissioni_intervallo[FINESTRA_PREVISIONE];
+    int errore[FINESTRA_PREVISIONE];
+    int posizione;
+    int riempimento;
+    double livello;
+    double tendenza;
+    int previsione;
+    int margine;
+    int limite_permessi;
+    // Errore della previsione dall'ultimo tick, azzerato dal master
+    long long errore_assoluto_tick;
+    long long errore_tick;
+    long long intervalli_tick;
+} previsione_energia;
+
+/**
+ * @struct statistiche_generazione_
+ * @brief Esiti della generazione dei processi atomo, aggiornati con operazioni atomiche.
+ */
+typedef struct statistiche_generazione_
+{
+    long long riusciti;
+    long long falliti;
+    long long ritentati;
+    long long scartati;
+    long long risparmiati; // Atomi destinati a scoria contati senza generare un processo
+    long long latenza_us_totale;
+    long long latenza_us_recente; // Media mobile esponenziale, segue la latenza corrente
+    int fallimenti_consecutivi;
+    int quota_alimentazione;
+} statistiche_generazione;
+
+/**
+ * @struct statistiche_code_
+ * @brief Record inviati e invii che hanno trovato la coda piena, per coda, aggiornati con operazioni atomiche.
+ */
+typedef struct statistiche_code_
+{
+    long long inviati[N_CODE];
+    long long bloccati[N_CODE];
+} statistiche_code;
+
 typedef struct shmseg2_
 {
     int atomi_attivi;
     int energia_totale;
-    int energia_totale_ultimo_secondo;
+    int energia_totale_ultimo_secondo; // Energia prodotta non ancora sommata al totale dal tick
     int energia_prelevata;
     int energia_assorbita;
     int inibitore_attivo;
     int energia_assorbita_ultimo_sec;
+    int ammissione_attiva;
+    int ammissione_chiusa;
+    int obiettivo_atomi;
+    int permessi_concessi_ultimo_sec;
+    statistiche_atomi statistiche;
+    statistiche_generazione generazione;
+    statistiche_code code;
+    int atomi_ospitati[N_OSPITI_MAX]; // Atomi vivi in ogni processo ospite
+    int tick;                          // Ultimo tick eseguito dal master
+    long long ritardo_tick_us;         // Ritardo dell'ultimo tick rispetto al secondo atteso
+    // Stato condiviso con il ciclo di controllo dell'inibitore, letto e scritto senza lock:
+    // il master aggiorna l'energia con il numero di sequenza dispari (vedi lib/inibizione.h),
+    // l'inibitore accumula in energia_da_assorbire quanto il master sottrarrà al tick
+    unsigned int sequenza_energia;
+    int energia_da_assorbire;
+    unsigned long long passi_inibitore;
+    unsigned long long interventi_inibitore;
+    previsione_energia previsione;
+    unsigned long long seme;
+    unsigned long long estrazioni;
+    // Deve restare l'ultimo campo: il checkpoint salva il segmento fin qui e l'istogramma a parte
+    int popolazione[N_ATOMICO_MAX];
 } shmseg2;
 
 /**
  * @brief Crea un nuovo segmento di memoria condivisa.
  *
- * Questa funzione utilizza un percorso e una dimensione specificata per creare un segmento
- * di memoria condivisa e restituisce il suo identificatore.
+ * Questa funzione utilizza un percorso, l'istanza del reattore e una dimensione specificata
+ * per creare un segmento di memoria condivisa (o collegarsi a quello esistente) e restituisce
+ * il suo identificatore.
  *
  * @param pathname Percorso per identificare univocamente la memoria condivisa
+ * @param istanza Identificativo dell'istanza del reattore
  * @param size Dimensione del segmento di memoria condivisa
  * @return Identificatore del segmento di memoria condivisa (int)
  */
-int create_shared_memory(char *pathname, size_t size);
+int create_shared_memory(char *pathname, int istanza, size_t size);
 
 /**
  * @brief Collega il processo corrente al segmento di memoria condivisa.
@@ -0,0 +1,39 @@
+#!/bin/sh
+# Confronta il costo di avvio e il costo per evento del master tra i profili di compilazione.
+#
+# Per ogni profilo compila gli eseguibili, esegue lo scenario indicato RIPETIZIONI volte
+# e riporta la media delle righe PRESTAZIONI stampate dal master a fine simulazione.
+#
+# Uso: scripts/confronta_profili.sh [scenario] [ripetizioni]
+
+SCENARIO=${1:-conf/config.txt}
+RIPETIZIONI=${2:-3}
+DURATA=5
+PROFILI="debug release pgo"
+
+mkdir -p build
+CONF=build/confronto.txt
+{ cat "$SCENARIO"; echo; echo "SIM_DURATION = $DURATA"; } > "$CONF"
+
+printf "%-10s %12s %20s\n" "profilo" "avvio (us)" "lettura evento (ns)"
+
+for profilo in $PROFILI; do
+    if [ "$profilo" = "pgo" ]; then
+        make -s pgo > /dev/null || exit 1
+    else
+        make -s PROFILE="$profilo" all > /dev/null || exit 1
+    fi
+
+    avvio=0
+    evento=0
+    i=0
+    while [ $i -lt "$RIPETIZIONI" ]; do
+        riga=$(echo 1 | REATTORE_CONF="$CONF" ./bin/master | grep '^PRESTAZIONI')
+        # PRESTAZIONI: avvio <us> us, ciclo eventi <n> iterazioni e <r> record, <ns> ns per lettura
+        avvio=$((avvio + $(echo "$riga" | awk '{print $3}')))
+        evento=$((evento + $(echo "$riga" | awk '{print $12}')))
+        i=$((i + 1))
+    done
+
+    printf "%-10s %12d %20d\n" "$profilo" $((avvio / RIPETIZIONI)) $((evento / RIPETIZIONI))
+done
@@ -0,0 +1,55 @@
+#!/bin/sh
+# Verifica checkpoint e ripristino con il numero atomico più alto ammesso dalla configurazione.
+#
+# Una simulazione con N_ATOM_MAX = 1023 (l'ultima classe dell'istogramma della popolazione)
+# scrive un checkpoint al secondo 2; il ripristino deve ricreare tutti gli atomi salvati e
+# ritrovare nella popolazione atomi con numero atomico 1023. Una configurazione con
+# N_ATOM_MAX = 1024 deve invece essere rifiutata.
+#
+# Uso: scripts/verifica_ripristino.sh [istanza]
+
+ISTANZA=${1:-41}
+MASSIMO=1023
+
+mkdir -p build
+CONF=build/verifica_ripristino.txt
+CHECKPOINT=build/verifica_ripristino.bin
+USCITA=build/verifica_ripristino.out
+rm -f "$CHECKPOINT"
+
+cat > "$CONF" <<EOF
+ENERGY_DEMAND = 0
+N_ATOMI_INIT = 10
+N_ATOM_MAX = $MASSIMO
+MIN_N_ATOMICO = 5
+N_NUOVI_ATOMI = 1
+SIM_DURATION = 4
+ENERGY_EXPLODE_THRESHOLD = 2000000000
+STEP = 1000000
+CHECKPOINT_TEMPO = 2
+EOF
+
+errore() {
+    echo "ERRORE: $1"
+    exit 1
+}
+
+echo 0 | REATTORE_CONF="$CONF" REATTORE_ISTANZA=$ISTANZA REATTORE_CHECKPOINT="$CHECKPOINT" \
+    ./bin/master > "$USCITA" 2>&1 || errore "simulazione fallita (vedi $USCITA)"
+salvati=$(sed -n 's/^CHECKPOINT: secondo [0-9]*, \([0-9]*\) atomi vivi.*/\1/p' "$USCITA")
+[ -n "$salvati" ] || errore "nessun checkpoint scritto (vedi $USCITA)"
+
+echo 0 | REATTORE_CONF="$CONF" REATTORE_ISTANZA=$ISTANZA REATTORE_CHECKPOINT="$CHECKPOINT" \
+    ./bin/master --restore "$CHECKPOINT" > "$USCITA" 2>&1 || errore "ripristino fallito (vedi $USCITA)"
+ricreati=$(sed -n 's/^RIPRISTINO: \([0-9]*\) atomi ricreati.*/\1/p' "$USCITA")
+[ "$ricreati" = "$salvati" ] || errore "$salvati atomi salvati, ${ricreati:-0} ricreati"
+# Popolazione: numero atomico min <n>, p10 <n>, mediana <n>, p90 <n>, max <n>; ...
+massimo=$(grep -m 1 '^Popolazione: numero atomico' "$USCITA" | sed 's/.* max \([0-9]*\);.*/\1/')
+[ "$massimo" = "$MASSIMO" ] || errore "numero atomico massimo ripristinato ${massimo:-?}, atteso $MASSIMO"
+
+sed -i "s/^N_ATOM_MAX = .*/N_ATOM_MAX = $((MASSIMO + 1))/" "$CONF"
+if echo 0 | REATTORE_CONF="$CONF" REATTORE_ISTANZA=$ISTANZA ./bin/master > "$USCITA" 2>&1; then
+    errore "N_ATOM_MAX = $((MASSIMO + 1)) accettato"
+fi
+
+echo "OK: $ricreati atomi ripristinati, numero atomico massimo $massimo, N_ATOM_MAX = $((MASSIMO + 1)) rifiutato"
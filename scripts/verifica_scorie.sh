@@ -0,0 +1,51 @@
+#!/bin/sh
+# Verifica che le scorie contate senza processo entrino nel totale delle scorie.
+#
+# Con MIN_N_ATOMICO vicino a N_ATOM_MAX molte scissioni producono un figlio già scoria, che
+# l'atomo annuncia nel record di scissione invece di avviare un processo. Ogni fork evitata
+# (`evitate (scorie)`, contata prima dell'invio del record) deve comparire tra le scorie senza
+# processo: quelle stampate all'ultimo tick non possono essere meno delle fork evitate al tick
+# precedente. Senza le scorie delle scissioni restano solo quelle dell'alimentazione.
+#
+# Uso: scripts/verifica_scorie.sh [istanza]
+
+ISTANZA=${1:-42}
+
+mkdir -p build
+CONF=build/verifica_scorie.txt
+USCITA=build/verifica_scorie.out
+
+cat > "$CONF" <<EOF
+ENERGY_DEMAND = 0
+N_ATOMI_INIT = 20
+N_ATOM_MAX = 40
+MIN_N_ATOMICO = 15
+N_NUOVI_ATOMI = 1
+SIM_DURATION = 8
+ENERGY_EXPLODE_THRESHOLD = 2000000000
+STEP = 1000000
+EOF
+
+errore() {
+    echo "ERRORE: $1"
+    exit 1
+}
+
+echo 0 | REATTORE_CONF="$CONF" REATTORE_ISTANZA=$ISTANZA ./bin/master > "$USCITA" 2>&1 ||
+    errore "simulazione fallita (vedi $USCITA)"
+
+# Per ogni tick: scorie senza processo e fork evitate
+# Quantita' scorie: <totale> (senza processo <n>), Ultimo secondo: <n>
+# Generazione atomi: ..., evitate (scorie) <n>, ...
+tick=$(awk '
+    /^Quantita. scorie:/ { sub("\\),", "", $6); scorie = $6 }
+    /^Generazione atomi:/ { for (i = 1; i < NF; i++) if ($i == "(scorie)") { sub(",", "", $(i + 1)); print scorie, $(i + 1) } }
+' "$USCITA" | tail -n 2)
+[ "$(echo "$tick" | wc -l)" -eq 2 ] || errore "meno di due tick stampati (vedi $USCITA)"
+
+evitate=$(echo "$tick" | head -n 1 | cut -d ' ' -f 2)
+scorie=$(echo "$tick" | tail -n 1 | cut -d ' ' -f 1)
+[ "$evitate" -gt 0 ] || errore "nessuna fork evitata: lo scenario non produce scorie senza processo"
+[ "$scorie" -ge "$evitate" ] || errore "$scorie scorie senza processo contate, ma già $evitate fork evitate"
+
+echo "OK: $scorie scorie senza processo, $evitate fork evitate al tick precedente"
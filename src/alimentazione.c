@@ -3,40 +3,79 @@
 // VARIABILI GLOBALI
 SimulationParams params;
 
-int queue;
+shmseg *memoria;
+shmseg2 *memoria2;
+
+ritentativo *coda_ritentativi;
+int n_ritentativi = 0;
+
+arena_lignaggi *arena = NULL;
+int lotto = 0;
 
 int main(int argc, char *argv[])
 {
     // INIZIALIZZAZIONE
-    const char *filename = "conf/config.txt";
+    const char *filename = percorso_configurazione();
     params = read_params_from_file(filename);
+    applica_profilo(&params, COMPONENTE_ALIMENTAZIONE);
     ignore(SIGINT);
     ignore(SIGUSR2);
-    ignore(SIGCHLD);
 
     struct timespec time;
     time.tv_sec = params.step / 1000000;
     time.tv_nsec = (params.step % 1000000) * 1000;
 
-    int m1 = create_shared_memory("src/master.c", sizeof(shmseg));
-    shmseg *memoria = attach_shared_memory(m1);
-    queue = memoria->id_queue;
-    int sem = memoria->id_semaphore;
-    int start = memoria->id_start;
+    int istanza = istanza_corrente();
+    int m1 = create_shared_memory("src/master.c", istanza, sizeof(shmseg));
+    memoria = attach_shared_memory(m1);
+    int m2 = create_shared_memory("src/inibitore.c", istanza, sizeof(shmseg2));
+    memoria2 = attach_shared_memory2(m2);
+    arena = collega_arena(memoria->id_arena_lignaggi);
 
-    wait_for_zero_sem(start);
+    coda_ritentativi = malloc(params.coda_ritentativi * sizeof(ritentativo));
+    if (coda_ritentativi == NULL)
+    {
+        perror("malloc error");
+        exit(EXIT_FAILURE);
+    }
+
+    if (!attendi_avvio(memoria))
+    {
+        exit(EXIT_SUCCESS);
+    }
 
     // CICLO DELLA SIMULAZIONE
-    while (sem_getvalue(sem) == 0)
+    while (reattore_in_corso(memoria))
     {
         nanosleep(&time, NULL);
-        for (int i = 0; i < params.n_nuovi_atomi && sem_getvalue(sem) == 0; i++)
+        lotto++;
+
+        int quota = calcola_quota();
+        memoria2->generazione.quota_alimentazione = quota;
+
+        // I ritentativi scaduti hanno la precedenza sui nuovi atomi e consumano la stessa quota
+        int generati = esegui_ritentativi(quota);
+        for (int i = generati; i < quota && reattore_in_corso(memoria); i++)
         {
             int numero_atomico = calcolo_numero_atomico(params.n_atom_max);
-            if (sem_getvalue(memoria->sem_scissione) != 0){
+            // Un atomo già sotto MIN_N_ATOMICO è una scoria: non serve né un permesso né un processo
+            if (scoria_senza_processo(numero_atomico, &params, memoria2))
+            {
+                annuncia_scoria(numero_atomico);
+            }
+            else if (richiedi_permesso(memoria, memoria2)){
                 new_atomo(numero_atomico);
             }
         }
+        raccogli_figli(&memoria2->statistiche, NULL, 0);
+
+        if (meltdown_sostenuto(memoria2, &params))
+        {
+            record_evento meltdown = nuovo_record(RECORD_TERMINAZIONE);
+            meltdown.valore = 3;
+            pubblica_record(memoria, memoria2, &meltdown);
+            exit(EXIT_FAILURE);
+        }
     }
 
     exit(EXIT_SUCCESS);
@@ -44,31 +83,149 @@ int main(int argc, char *argv[])
 
 int new_atomo(int n_atomico)
 {
-    char buffer[100];
-    sprintf(buffer, "%d", n_atomico);
-    char *pathname = "bin/atomo";
-    int pid = fork();
+    lignaggio_atomo radice = nuova_radice(arena, lotto);
+    int pid = genera_atomo(n_atomico, &radice, -1, memoria, memoria2);
 
-    switch (pid)
+    if (pid == -1)
     {
-    case -1:
-        perror("Error starting the process");
-        send_type_message(queue, -1, 4);
-        send_type_message(queue, 3, 15);
-        exit(EXIT_FAILURE);
-        break;
-    case 0:
-        execlp(pathname, pathname, buffer, NULL);
-        perror("Exec fallito");
-        exit(EXIT_FAILURE);
-    default:
-        return pid;
+        accoda_ritentativo(n_atomico, &radice);
+    }
+    else
+    {
+        annuncia_nascita(pid, n_atomico);
+    }
+    return pid;
+}
+
+void annuncia_nascita(pid_t pid, int n_atomico)
+{
+    record_evento record = nuovo_record(RECORD_NASCITA);
+    record.pid = pid;
+    record.genitore = getpid();
+    record.n_atomico = n_atomico;
+    record.delta_atomi = 1;
+    pubblica_record(memoria, memoria2, &record);
+}
+
+void annuncia_scoria(int n_atomico)
+{
+    record_evento record = nuovo_record(RECORD_SCORIA);
+    record.pid = 0;
+    record.genitore = getpid();
+    record.n_atomico = n_atomico;
+    record.valore = SCORIA_SENZA_PROCESSO;
+    pubblica_record(memoria, memoria2, &record);
+}
+
+int calcola_quota()
+{
+    double fattore = 1.0;
+
+    // Le fork di un passo non devono occupare più di metà del passo, alla latenza recente
+    long long latenza_us = latenza_recente_generazione_us(memoria2);
+    if (latenza_us > 0)
+    {
+        double fattore_latenza = (params.step / 2.0) / ((double)latenza_us * params.n_nuovi_atomi);
+        if (fattore_latenza < fattore)
+        {
+            fattore = fattore_latenza;
+        }
+    }
+
+    // Con un carico superiore al numero di CPU si rallenta in proporzione
+    double carico;
+    long cpu = sysconf(_SC_NPROCESSORS_ONLN);
+    if (getloadavg(&carico, 1) == 1 && cpu > 0 && carico > cpu)
+    {
+        double fattore_carico = cpu / carico;
+        if (fattore_carico < fattore)
+        {
+            fattore = fattore_carico;
+        }
+    }
+
+    // Un passo non consuma più di un decimo dei processi ancora disponibili; gli atomi
+    // eseguiti dai processi ospite non ne consumano
+    long disponibili = memoria->n_ospiti > 0 ? -1 : processi_disponibili();
+    if (disponibili == 0)
+    {
+        return 0;
+    }
+    if (disponibili > 0)
+    {
+        double fattore_pid = disponibili / (10.0 * params.n_nuovi_atomi);
+        if (fattore_pid < fattore)
+        {
+            fattore = fattore_pid;
+        }
+    }
+
+    int quota = (int)(params.n_nuovi_atomi * fattore + 0.5);
+    return quota > 0 ? quota : 1;
+}
+
+void accoda_ritentativo(int n_atomico, const lignaggio_atomo *lignaggio)
+{
+    if (n_ritentativi == params.coda_ritentativi)
+    {
+        annulla_figlio(arena, NULL, lignaggio);
+        registra_scartato(memoria2);
+        return;
+    }
+
+    struct timespec adesso;
+    clock_gettime(CLOCK_MONOTONIC, &adesso);
+    coda_ritentativi[n_ritentativi].n_atomico = n_atomico;
+    coda_ritentativi[n_ritentativi].tentativi = 1;
+    coda_ritentativi[n_ritentativi].lignaggio = *lignaggio;
+    coda_ritentativi[n_ritentativi].pronto_ms = adesso.tv_sec * 1000LL + adesso.tv_nsec / 1000000 + params.ritentativo_base_ms;
+    n_ritentativi++;
+    registra_ritentativo(memoria2);
+}
+
+int esegui_ritentativi(int quota)
+{
+    struct timespec adesso;
+    clock_gettime(CLOCK_MONOTONIC, &adesso);
+    long long adesso_ms = adesso.tv_sec * 1000LL + adesso.tv_nsec / 1000000;
+    int eseguiti = 0;
+
+    for (int i = 0; i < n_ritentativi && eseguiti < quota && reattore_in_corso(memoria);)
+    {
+        ritentativo *r = &coda_ritentativi[i];
+        if (r->pronto_ms > adesso_ms)
+        {
+            i++;
+            continue;
+        }
+
+        eseguiti++;
+        pid_t pid = genera_atomo(r->n_atomico, &r->lignaggio, -1, memoria, memoria2);
+        if (pid == -1 && r->tentativi < MAX_TENTATIVI)
+        {
+            // Attesa esponenziale prima del tentativo successivo
+            r->pronto_ms = adesso_ms + (params.ritentativo_base_ms << r->tentativi);
+            r->tentativi++;
+            registra_ritentativo(memoria2);
+            i++;
+            continue;
+        }
+        if (pid != -1)
+        {
+            annuncia_nascita(pid, r->n_atomico);
+        }
+        else
+        {
+            annulla_figlio(arena, NULL, &r->lignaggio);
+            registra_scartato(memoria2);
+        }
+        // Rimuove l'elemento sostituendolo con l'ultimo della coda
+        coda_ritentativi[i] = coda_ritentativi[--n_ritentativi];
     }
+    return eseguiti;
 }
 
 int calcolo_numero_atomico(int n_atomico_max)
 {
-    srand(time(NULL));
-    int n_atomico = rand() % (n_atomico_max - 1) + 1;
-    return n_atomico;
+    return estrai_numero_atomico(memoria2, n_atomico_max);
 }
@@ -11,115 +11,138 @@
 // VARIABILI GLOBALI
 int n_atomico;
 SimulationParams params;
-int queue;
 shmseg *memoria;
+shmseg2 *memoria2;
+lignaggio_atomo lignaggio;
+arena_lignaggi *arena = NULL;
 
 int main(int argc, char *argv[])
 {
     // INIZIALIZZAZIONE
 
-    const char *filename = "conf/config.txt";
+    const char *filename = percorso_configurazione();
     params = read_params_from_file(filename);
+    applica_profilo(&params, COMPONENTE_ATOMO);
     n_atomico = atoi(argv[1]);
-    ignore(SIGCHLD);
+    lignaggio = lignaggio_da_argomenti(argc, argv);
     ignore(SIGINT);
     ignore(SIGUSR2);
 
-    int m1 = create_shared_memory("src/master.c", sizeof(shmseg));
+    int istanza = istanza_corrente();
+    int m1 = create_shared_memory("src/master.c", istanza, sizeof(shmseg));
     memoria = attach_shared_memory(m1);
+    int m2 = create_shared_memory("src/inibitore.c", istanza, sizeof(shmseg2));
+    memoria2 = attach_shared_memory2(m2);
+    // Un atomo avviato senza lignaggio (es. dal banco IPC) non registra archi; senza arena
+    // i figli ereditano solo lignaggio e generazione
+    if (lignaggio.lignaggio != NESSUN_NODO)
+    {
+        arena = collega_arena(memoria->id_arena_lignaggi);
+    }
 
-    //dprintf(1, "AAAAAA");
-
-    queue = memoria->id_queue;
-    int sem = memoria->id_semaphore;
-    int start = memoria->id_start;
-    int attivatore_sem = memoria->id_attivatore_sem;
-
-    send_type_message(queue, 1, 4);
+    // La nascita è annunciata da chi ha generato l'atomo, insieme alla scissione o alla creazione
+    aggiorna_popolazione(memoria2, 0, n_atomico);
 
-    wait_for_zero_sem(start);
+    if (!attendi_avvio(memoria))
+    {
+        aggiorna_popolazione(memoria2, n_atomico, 0);
+        exit(EXIT_SUCCESS);
+    }
 
     // CICLO DELLA SIMULAZIONE
-    while (sem_getvalue(sem) == 0)
+    while (reattore_in_corso(memoria))
     {
         if (n_atomico < params.min_n_atomico)
         {
-            send_type_message(queue, -1, 4);
-            send_type_message(queue, 1, 10);
+            record_evento scoria = nuovo_record(RECORD_SCORIA);
+            scoria.n_atomico = n_atomico;
+            scoria.delta_atomi = -1;
+            pubblica_record(memoria, memoria2, &scoria);
+            aggiorna_popolazione(memoria2, n_atomico, 0);
+            raccogli_figli(&memoria2->statistiche, NULL, 0);
             exit(EXIT_SUCCESS);
         }
 
-        decrease_sem(attivatore_sem);
-
-        if (sem_getvalue(sem) == 0)
+        if (attendi_attivazione(memoria))
         {
-            int energy = scissione();
-            send_type_message(queue, energy, 5);
-            
+            scissione();
         }
+
+        // I figli terminati vengono raccolti da chi li ha generati, registrandone le risorse
+        raccogli_figli(&memoria2->statistiche, NULL, 0);
     }
 
-    send_type_message(queue, -1, 4);
-    sem_setvalue(attivatore_sem, 10000);
+    aggiorna_popolazione(memoria2, n_atomico, 0);
+    raccogli_figli(&memoria2->statistiche, NULL, 0);
     exit(EXIT_SUCCESS);
 }
 
-int max(int a, int b)
-{
-    return (a > b) ? a : b;
-}
-
-int energy(int n_atomico_figlio)
-{
-    int energy = n_atomico * n_atomico_figlio - max(n_atomico, n_atomico_figlio);
-    return energy;
-}
-
 int scissione() 
 {
 
     int n_atomico_figlio = calcolo_numero_atomico(n_atomico);
         n_atomico = n_atomico - n_atomico_figlio;
-        
-    if (sem_getvalue(memoria->sem_scissione) == 0) {
+        aggiorna_popolazione(memoria2, n_atomico + n_atomico_figlio, n_atomico);
+
+    if (!richiedi_permesso(memoria, memoria2)) {
     // Non fare nulla, la scissione è bloccata
     return 0; // Evita la creazione di nuovi atomi
     }
-    else{
-        // Altrimenti, prosegui con la creazione degli atomi
-        new_atomo(n_atomico_figlio);
-        send_type_message(queue, 1, 9);
-        return energy(n_atomico_figlio);
+
+    lignaggio_atomo lignaggio_figlio = nuovo_figlio(arena, &lignaggio, energy(n_atomico, n_atomico_figlio));
+
+    // Un figlio sotto MIN_N_ATOMICO sarebbe scoria appena avviato: lo si conta come tale senza fork
+    if (scoria_senza_processo(n_atomico_figlio, &params, memoria2)) {
+        record_evento record = nuovo_record(RECORD_SCISSIONE);
+        record.pid = 0;
+        record.genitore = getpid();
+        record.n_atomico = n_atomico;
+        record.n_atomico_figlio = n_atomico_figlio;
+        record.energia = energy(n_atomico, n_atomico_figlio);
+        record.valore = SCORIA_SENZA_PROCESSO;
+        pubblica_record(memoria, memoria2, &record);
+        return record.energia;
+    }
+
+    pid_t figlio = new_atomo(n_atomico_figlio, &lignaggio_figlio);
+    if (figlio == -1) {
+        // La fork è fallita: la scissione non avviene
+        annulla_figlio(arena, &lignaggio, &lignaggio_figlio);
+        n_atomico = n_atomico + n_atomico_figlio;
+        aggiorna_popolazione(memoria2, n_atomico - n_atomico_figlio, n_atomico);
+        return 0;
     }
+
+    // Scissione, energia e nascita del figlio in un solo record
+    record_evento record = nuovo_record(RECORD_SCISSIONE);
+    record.pid = figlio;
+    record.genitore = getpid();
+    record.n_atomico = n_atomico;
+    record.n_atomico_figlio = n_atomico_figlio;
+    record.energia = energy(n_atomico, n_atomico_figlio);
+    record.delta_atomi = 1;
+    pubblica_record(memoria, memoria2, &record);
+    return record.energia;
 }
 
-int new_atomo(int n_atomico)
+int new_atomo(int n_atomico_figlio, const lignaggio_atomo *lignaggio_figlio)
 {
-    char buffer[100];
-    sprintf(buffer, "%d", n_atomico);
-    char *pathname = "bin/atomo";
-    int pid = fork();
+    int pid = genera_atomo(n_atomico_figlio, lignaggio_figlio, -1, memoria, memoria2);
 
-    switch (pid)
+    if (pid == -1 && meltdown_sostenuto(memoria2, &params))
     {
-    case -1:
-        perror("Error starting the process");
-        send_type_message(queue, -1, 4);
-        send_type_message(queue, 3, 15);
-        exit(EXIT_FAILURE);
-        break;
-    case 0:
-        execlp(pathname, pathname, buffer, NULL);
-        perror("Exec fallito");
+        record_evento meltdown = nuovo_record(RECORD_TERMINAZIONE);
+        meltdown.n_atomico = n_atomico;
+        meltdown.valore = 3;
+        meltdown.delta_atomi = -1;
+        pubblica_record(memoria, memoria2, &meltdown);
+        aggiorna_popolazione(memoria2, n_atomico, 0);
         exit(EXIT_FAILURE);
-    default:
-        return pid;
     }
+    return pid;
 }
 
 int calcolo_numero_atomico(int n_atomico_max)
 {
-    srand(time(NULL));
-    int n_atomico = rand() % (n_atomico_max - 1) + 1;
-    return n_atomico;
+    return estrai_numero_atomico(memoria2, n_atomico_max);
 }
@@ -9,6 +9,10 @@
 #include "../lib/semaphore.h"
 #include "../lib/shared_memory.h"
 #include "../lib/conf.h"
+#include "../lib/processi.h"
+#include "../lib/istanza.h"
+#include "../lib/pianificazione.h"
+#include "../lib/eventi.h"
 
 /**
  * @brief gestore del segnale di terminazione, imposta a 0 la flag "simulazione_in_corso"
@@ -16,29 +20,35 @@
 
 int main()
 {
-    int m1 = create_shared_memory("src/master.c", sizeof(shmseg));
+    SimulationParams params = read_params_from_file(percorso_configurazione());
+    applica_profilo(&params, COMPONENTE_ATTIVATORE);
+
+    int istanza = istanza_corrente();
+    int m1 = create_shared_memory("src/master.c", istanza, sizeof(shmseg));
     shmseg *memoria = attach_shared_memory(m1);
+    int m2 = create_shared_memory("src/inibitore.c", istanza, sizeof(shmseg2));
+    shmseg2 *memoria2 = attach_shared_memory2(m2);
     ignore(SIGINT);
     ignore(SIGUSR2);
 
-    int queue = memoria->id_queue;
-    int sem = memoria->id_semaphore;
-    int start = memoria->id_start;
     int attivatore_sem = memoria->id_attivatore_sem;
 
-    wait_for_zero_sem(start);
+    if (!attendi_avvio(memoria))
+    {
+        exit(EXIT_SUCCESS);
+    }
 
-    while (sem_getvalue(sem) == 0)
+    while (reattore_in_corso(memoria))
     {
         if (how_many_sem(attivatore_sem) > 0)
         {
             increase_sem(attivatore_sem);
-            send_type_message(queue, 1, 12);
+            record_evento attivazione = nuovo_record(RECORD_ATTIVAZIONE);
+            attivazione.valore = 1;
+            pubblica_record(memoria, memoria2, &attivazione);
         }
         usleep(500000);
     }
 
-    sem_setvalue(attivatore_sem, 10000);
-
     exit(EXIT_SUCCESS);
 }
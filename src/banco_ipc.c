@@ -0,0 +1,740 @@
+#include <sys/mman.h>
+#include <sys/msg.h>
+#include <sys/sem.h>
+#include <sys/shm.h>
+#include <sys/wait.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include <mqueue.h>
+#include <spawn.h>
+#include <sched.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../lib/code.h"
+#include "../lib/semaphore.h"
+#include "../lib/shared_memory.h"
+#include "../lib/istanza.h"
+#include "../lib/processi.h"
+#include "../lib/pianificazione.h"
+#include "../lib/eventi.h"
+
+/**
+ * @file banco_ipc.c
+ * @brief Microbenchmark delle primitive IPC usate dal reattore.
+ *
+ * Misura latenza e throughput di invio e lettura non bloccante sulla coda di messaggi, della
+ * coppia incremento/decremento e del passaggio di mano con attesa dello zero sui semafori,
+ * dell'aggancio di un segmento di memoria condivisa e di fork+exec di `bin/atomo`. Ogni
+ * primitiva è confrontata con un'alternativa (coda POSIX e pipe, futex, mmap, posix_spawn)
+ * ed eseguita con 1, 2, 4, ... fino a N produttori concorrenti.
+ *
+ * Ogni produttore esegue prima un riscaldamento non misurato, poi cronometra le singole
+ * operazioni. I processi sono fissati alle CPU indicate, a rotazione: prima i consumatori,
+ * poi i produttori. Il throughput è il numero di operazioni misurate diviso l'intervallo tra
+ * il primo inizio e l'ultima fine delle fasi misurate.
+ *
+ * Uso: bin/banco_ipc [-p produttori] [-n operazioni] [-w riscaldamento] [-c cpu] [-b primitiva]
+ */
+
+#define PRODUTTORI_DEFAULT 4
+#define PRODUTTORI_MAX 64
+// Istanza riservata agli atomi lanciati dal benchmark, accanto a quella di bin/popolazione
+#define ISTANZA_BANCO (ISTANZE_MAX - 2)
+
+/**
+ * @brief Consumatori di un benchmark.
+ */
+#define NESSUN_CONSUMATORE 0
+#define UN_CONSUMATORE 1
+#define UN_CONSUMATORE_PER_PRODUTTORE 2
+
+/**
+ * @struct banco_
+ * @brief Un benchmark: una primitiva con una sua implementazione.
+ *
+ * `prepara` crea le risorse prima delle fork, così che produttori e consumatori le ereditino;
+ * `operazione` è l'operazione cronometrata del produttore; `consuma` riceve le `totale`
+ * operazioni dei produttori che serve (tutti oppure solo il proprio).
+ */
+typedef struct banco_
+{
+    const char *primitiva;
+    const char *implementazione;
+    int operazioni;
+    int consumatori;
+    void (*prepara)(int produttori);
+    void (*operazione)(int produttore);
+    void (*consuma)(int consumatore, long totale);
+    void (*pulisci)(void);
+} banco;
+
+// RISORSE CONDIVISE DAI PROCESSI DEL BENCHMARK
+int coda;
+mqd_t coda_posix;
+int tubo[2];
+int semafori[PRODUTTORI_MAX];
+int n_semafori;
+int *futex_condivisi;
+int segmento;
+int descrittore_posix;
+shmseg *memoria;
+int m1, m2;
+char percorso_atomo[] = "bin/atomo";
+char numero_atomico[] = "10";
+
+/**
+ * @brief Istante corrente di CLOCK_MONOTONIC, in nanosecondi.
+ */
+long long ora_ns()
+{
+    struct timespec adesso;
+    clock_gettime(CLOCK_MONOTONIC, &adesso);
+    return adesso.tv_sec * 1000000000LL + adesso.tv_nsec;
+}
+
+int confronta_latenze(const void *a, const void *b)
+{
+    long long x = *(const long long *)a, y = *(const long long *)b;
+    return (x > y) - (x < y);
+}
+
+// FUTEX: SEMAFORO CON LA STESSA SEMANTICA DI increase_sem, decrease_sem E wait_for_zero_sem
+
+void futex_incrementa(int *valore)
+{
+    __atomic_fetch_add(valore, 1, __ATOMIC_RELEASE);
+    syscall(SYS_futex, valore, FUTEX_WAKE, __INT_MAX__, NULL, NULL, 0);
+}
+
+void futex_decrementa(int *valore)
+{
+    for (;;)
+    {
+        int corrente = __atomic_load_n(valore, __ATOMIC_ACQUIRE);
+        if (corrente > 0)
+        {
+            if (__atomic_compare_exchange_n(valore, &corrente, corrente - 1, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+            {
+                // Sveglia chi attende lo zero
+                syscall(SYS_futex, valore, FUTEX_WAKE, __INT_MAX__, NULL, NULL, 0);
+                return;
+            }
+            continue;
+        }
+        syscall(SYS_futex, valore, FUTEX_WAIT, 0, NULL, NULL, 0);
+    }
+}
+
+void futex_attendi_zero(int *valore)
+{
+    int corrente;
+    while ((corrente = __atomic_load_n(valore, __ATOMIC_ACQUIRE)) != 0)
+    {
+        syscall(SYS_futex, valore, FUTEX_WAIT, corrente, NULL, NULL, 0);
+    }
+}
+
+void prepara_futex(int produttori)
+{
+    (void)produttori;
+    futex_condivisi = mmap(NULL, sizeof(int) * PRODUTTORI_MAX, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (futex_condivisi == MAP_FAILED)
+    {
+        perror("mmap error");
+        exit(EXIT_FAILURE);
+    }
+}
+
+void pulisci_futex()
+{
+    munmap(futex_condivisi, sizeof(int) * PRODUTTORI_MAX);
+}
+
+// CODA DI MESSAGGI
+
+void prepara_coda(int produttori)
+{
+    (void)produttori;
+    coda = msgget(IPC_PRIVATE, IPC_CREAT | 0600);
+    if (coda == -1)
+    {
+        perror("msgget error");
+        exit(EXIT_FAILURE);
+    }
+}
+
+void invia_coda(int produttore)
+{
+    (void)produttore;
+    send_type_message(coda, 1, 4);
+}
+
+void consuma_coda(int consumatore, long totale)
+{
+    (void)consumatore;
+    // Come il master: lettura non bloccante in un ciclo attivo
+    for (long ricevuti = 0; ricevuti < totale;)
+    {
+        ricevuti += read_type_message_nb(coda, 4);
+    }
+}
+
+void pulisci_coda()
+{
+    remove_queue(coda);
+}
+
+void invia_record_coda(int produttore)
+{
+    (void)produttore;
+    record_evento record = nuovo_record(RECORD_SCISSIONE);
+    record.delta_atomi = 1;
+    invia_record(coda, &record);
+}
+
+void ignora_record(const record_evento *record)
+{
+    (void)record;
+}
+
+void consuma_record_coda(int consumatore, long totale)
+{
+    (void)consumatore;
+    gestore_evento gestori[N_TIPI_RECORD] = {NULL};
+    statistiche_record statistiche = {0};
+    gestori[RECORD_SCISSIONE] = ignora_record;
+    for (long ricevuti = 0; ricevuti < totale;)
+    {
+        ricevuti += consuma_record(coda, gestori, 0, &statistiche);
+    }
+}
+
+void prepara_coda_posix(int produttori)
+{
+    (void)produttori;
+    char nome[64];
+    struct mq_attr attributi = {0};
+    attributi.mq_maxmsg = 10;
+    attributi.mq_msgsize = sizeof(int);
+    snprintf(nome, sizeof(nome), "/reattore_banco_%d", getpid());
+    coda_posix = mq_open(nome, O_CREAT | O_RDWR, 0600, &attributi);
+    if (coda_posix == (mqd_t)-1)
+    {
+        perror("mq_open error");
+        exit(EXIT_FAILURE);
+    }
+    // Il descrittore resta valido: il nome non serve più
+    mq_unlink(nome);
+}
+
+void invia_coda_posix(int produttore)
+{
+    (void)produttore;
+    int messaggio = 1;
+    if (mq_send(coda_posix, (char *)&messaggio, sizeof(messaggio), 0) == -1)
+    {
+        perror("mq_send error");
+        exit(EXIT_FAILURE);
+    }
+}
+
+void consuma_coda_posix(int consumatore, long totale)
+{
+    (void)consumatore;
+    // O_NONBLOCK cambierebbe anche il descrittore dei produttori: una scadenza già passata
+    // rende la ricezione non bloccante solo qui
+    struct timespec scadenza = {0, 0};
+    int messaggio;
+    for (long ricevuti = 0; ricevuti < totale;)
+    {
+        if (mq_timedreceive(coda_posix, (char *)&messaggio, sizeof(messaggio), NULL, &scadenza) != -1)
+        {
+            ricevuti++;
+        }
+    }
+}
+
+void pulisci_coda_posix()
+{
+    mq_close(coda_posix);
+}
+
+void prepara_tubo(int produttori)
+{
+    (void)produttori;
+    if (pipe(tubo) == -1)
+    {
+        perror("pipe error");
+        exit(EXIT_FAILURE);
+    }
+}
+
+void invia_tubo(int produttore)
+{
+    (void)produttore;
+    int messaggio = 1;
+    // Scritture sotto PIPE_BUF: atomiche anche con più produttori
+    if (write(tubo[1], &messaggio, sizeof(messaggio)) != sizeof(messaggio))
+    {
+        perror("write error");
+        exit(EXIT_FAILURE);
+    }
+}
+
+void consuma_tubo(int consumatore, long totale)
+{
+    (void)consumatore;
+    int messaggi[1024];
+    close(tubo[1]);
+    for (long ricevuti = 0; ricevuti < totale * (long)sizeof(int);)
+    {
+        ssize_t letti = read(tubo[0], messaggi, sizeof(messaggi));
+        if (letti <= 0)
+        {
+            perror("read error");
+            exit(EXIT_FAILURE);
+        }
+        ricevuti += letti;
+    }
+}
+
+void pulisci_tubo()
+{
+    close(tubo[0]);
+    close(tubo[1]);
+}
+
+// SEMAFORI
+
+void prepara_semafori(int produttori)
+{
+    for (n_semafori = 0; n_semafori < produttori; n_semafori++)
+    {
+        semafori[n_semafori] = semget(IPC_PRIVATE, 1, IPC_CREAT | 0600);
+        if (semafori[n_semafori] == -1)
+        {
+            perror("semget error");
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+void pulisci_semafori()
+{
+    for (int i = 0; i < n_semafori; i++)
+    {
+        remove_sem(semafori[i]);
+    }
+    n_semafori = 0;
+}
+
+/**
+ * @brief Incremento seguito da decremento sullo stesso semaforo, condiviso da tutti i produttori.
+ */
+void incrementa_decrementa(int produttore)
+{
+    (void)produttore;
+    increase_sem(semafori[0]);
+    decrease_sem(semafori[0]);
+}
+
+void incrementa_decrementa_futex(int produttore)
+{
+    (void)produttore;
+    futex_incrementa(&futex_condivisi[0]);
+    futex_decrementa(&futex_condivisi[0]);
+}
+
+/**
+ * @brief Passaggio di mano: il produttore incrementa e attende che il suo consumatore torni a zero.
+ *
+ * È lo schema con cui il master concede un permesso e attende che venga consumato.
+ */
+void passaggio(int produttore)
+{
+    increase_sem(semafori[produttore]);
+    wait_for_zero_sem(semafori[produttore]);
+}
+
+void ricevi_passaggio(int consumatore, long totale)
+{
+    for (long i = 0; i < totale; i++)
+    {
+        decrease_sem(semafori[consumatore]);
+    }
+}
+
+void passaggio_futex(int produttore)
+{
+    futex_incrementa(&futex_condivisi[produttore]);
+    futex_attendi_zero(&futex_condivisi[produttore]);
+}
+
+void ricevi_passaggio_futex(int consumatore, long totale)
+{
+    for (long i = 0; i < totale; i++)
+    {
+        futex_decrementa(&futex_condivisi[consumatore]);
+    }
+}
+
+// MEMORIA CONDIVISA
+
+void prepara_segmento(int produttori)
+{
+    (void)produttori;
+    segmento = shmget(IPC_PRIVATE, sizeof(shmseg2), IPC_CREAT | 0600);
+    if (segmento == -1)
+    {
+        perror("shmget error");
+        exit(EXIT_FAILURE);
+    }
+}
+
+void aggancia_segmento(int produttore)
+{
+    (void)produttore;
+    shmdt(attach_shared_memory2(segmento));
+}
+
+void pulisci_segmento()
+{
+    remove_shared_memory(segmento);
+}
+
+void prepara_mappa(int produttori)
+{
+    (void)produttori;
+    char nome[64];
+    snprintf(nome, sizeof(nome), "/reattore_banco_%d", getpid());
+    descrittore_posix = shm_open(nome, O_CREAT | O_RDWR, 0600);
+    if (descrittore_posix == -1 || ftruncate(descrittore_posix, sizeof(shmseg2)) == -1)
+    {
+        perror("shm_open error");
+        exit(EXIT_FAILURE);
+    }
+    shm_unlink(nome);
+}
+
+void aggancia_mappa(int produttore)
+{
+    (void)produttore;
+    void *mappa = mmap(NULL, sizeof(shmseg2), PROT_READ | PROT_WRITE, MAP_SHARED, descrittore_posix, 0);
+    if (mappa == MAP_FAILED)
+    {
+        perror("mmap error");
+        exit(EXIT_FAILURE);
+    }
+    munmap(mappa, sizeof(shmseg2));
+}
+
+void pulisci_mappa()
+{
+    close(descrittore_posix);
+}
+
+// FORK+EXEC DI bin/atomo
+
+/**
+ * @brief Crea le risorse IPC lette da un atomo, su un'istanza riservata e con il reattore in arresto.
+ *
+ * Gli atomi si collegano alla memoria condivisa e terminano subito perché il reattore non partirà.
+ */
+void prepara_atomi(int produttori)
+{
+    (void)produttori;
+    char istanza[16];
+    snprintf(istanza, sizeof(istanza), "%d", ISTANZA_BANCO);
+    setenv(VARIABILE_ISTANZA, istanza, 1);
+
+    m1 = create_shared_memory("src/master.c", ISTANZA_BANCO, sizeof(shmseg));
+    memoria = attach_shared_memory(m1);
+    m2 = create_shared_memory("src/inibitore.c", ISTANZA_BANCO, sizeof(shmseg2));
+    memset(memoria, 0, sizeof(shmseg));
+    memoria->stato_reattore = REATTORE_IN_ARRESTO;
+}
+
+void lancia_atomo(int produttore)
+{
+    (void)produttore;
+    pid_t pid = avvia_processo(percorso_atomo, numero_atomico, -1);
+    if (pid == -1 || waitpid(pid, NULL, 0) == -1)
+    {
+        exit(EXIT_FAILURE);
+    }
+}
+
+void lancia_atomo_spawn(int produttore)
+{
+    (void)produttore;
+    extern char **environ;
+    char *argomenti[] = {percorso_atomo, numero_atomico, NULL};
+    pid_t pid;
+    if (posix_spawn(&pid, percorso_atomo, NULL, NULL, argomenti, environ) != 0 || waitpid(pid, NULL, 0) == -1)
+    {
+        perror("posix_spawn error");
+        exit(EXIT_FAILURE);
+    }
+}
+
+void pulisci_atomi()
+{
+    shmdt(memoria);
+    remove_shared_memory(m1);
+    remove_shared_memory(m2);
+    unsetenv(VARIABILE_ISTANZA);
+}
+
+banco banchi[] = {
+    {"coda di messaggi", "SysV msgsnd", 100000, UN_CONSUMATORE, prepara_coda, invia_coda, consuma_coda, pulisci_coda},
+    {"coda di messaggi", "SysV record", 100000, UN_CONSUMATORE, prepara_coda, invia_record_coda, consuma_record_coda, pulisci_coda},
+    {"coda di messaggi", "POSIX mq_send", 100000, UN_CONSUMATORE, prepara_coda_posix, invia_coda_posix, consuma_coda_posix, pulisci_coda_posix},
+    {"coda di messaggi", "pipe", 100000, UN_CONSUMATORE, prepara_tubo, invia_tubo, consuma_tubo, pulisci_tubo},
+    {"semaforo inc/dec", "SysV semop", 100000, NESSUN_CONSUMATORE, prepara_semafori, incrementa_decrementa, NULL, pulisci_semafori},
+    {"semaforo inc/dec", "futex", 100000, NESSUN_CONSUMATORE, prepara_futex, incrementa_decrementa_futex, NULL, pulisci_futex},
+    {"semaforo passaggio", "SysV semop", 20000, UN_CONSUMATORE_PER_PRODUTTORE, prepara_semafori, passaggio, ricevi_passaggio, pulisci_semafori},
+    {"semaforo passaggio", "futex", 20000, UN_CONSUMATORE_PER_PRODUTTORE, prepara_futex, passaggio_futex, ricevi_passaggio_futex, pulisci_futex},
+    {"memoria aggancio", "SysV shmat", 20000, NESSUN_CONSUMATORE, prepara_segmento, aggancia_segmento, NULL, pulisci_segmento},
+    {"memoria aggancio", "POSIX mmap", 20000, NESSUN_CONSUMATORE, prepara_mappa, aggancia_mappa, NULL, pulisci_mappa},
+    {"fork+exec atomo", "fork+execlp", 300, NESSUN_CONSUMATORE, prepara_atomi, lancia_atomo, NULL, pulisci_atomi},
+    {"fork+exec atomo", "posix_spawn", 300, NESSUN_CONSUMATORE, prepara_atomi, lancia_atomo_spawn, NULL, pulisci_atomi},
+};
+
+/**
+ * @brief Fissa il processo chiamante a una CPU dell'elenco, a rotazione.
+ */
+void fissa_cpu(const int *cpu, int n_cpu, int posizione)
+{
+    cpu_set_t insieme;
+    CPU_ZERO(&insieme);
+    CPU_SET(cpu[posizione % n_cpu], &insieme);
+    if (sched_setaffinity(0, sizeof(insieme), &insieme) == -1)
+    {
+        perror("sched_setaffinity error");
+    }
+}
+
+/**
+ * @brief Attende la chiusura della barriera di partenza da parte del processo principale.
+ */
+void attendi_partenza(int barriera[2])
+{
+    char c;
+    close(barriera[1]);
+    while (read(barriera[0], &c, 1) > 0)
+    {
+    }
+    close(barriera[0]);
+}
+
+/**
+ * @brief Esegue un benchmark con `produttori` produttori e ne stampa la riga della tabella.
+ *
+ * @return 0 in caso di successo, -1 se un processo del benchmark è fallito
+ */
+int esegui_banco(const banco *b, int produttori, int operazioni, int riscaldamento, const int *cpu, int n_cpu)
+{
+    int consumatori = b->consumatori == UN_CONSUMATORE ? 1 : b->consumatori == UN_CONSUMATORE_PER_PRODUTTORE ? produttori
+                                                                                                           : 0;
+    size_t dimensione = sizeof(long long) * ((size_t)produttori * operazioni + 2 * produttori);
+    long long *latenze = mmap(NULL, dimensione, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (latenze == MAP_FAILED)
+    {
+        perror("mmap error");
+        exit(EXIT_FAILURE);
+    }
+    // Inizio e fine della fase misurata di ogni produttore, dopo le latenze
+    long long *intervalli = latenze + (size_t)produttori * operazioni;
+
+    b->prepara(produttori);
+
+    int barriera[2];
+    if (pipe(barriera) == -1)
+    {
+        perror("pipe error");
+        exit(EXIT_FAILURE);
+    }
+
+    pid_t processi[2 * PRODUTTORI_MAX];
+    long per_consumatore = b->consumatori == UN_CONSUMATORE ? (long)produttori * (riscaldamento + operazioni)
+                                                            : riscaldamento + operazioni;
+    for (int i = 0; i < consumatori; i++)
+    {
+        processi[produttori + i] = fork();
+        if (processi[produttori + i] == -1)
+        {
+            perror("fork error");
+            exit(EXIT_FAILURE);
+        }
+        if (processi[produttori + i] == 0)
+        {
+            fissa_cpu(cpu, n_cpu, i);
+            attendi_partenza(barriera);
+            b->consuma(i, per_consumatore);
+            exit(EXIT_SUCCESS);
+        }
+    }
+    for (int i = 0; i < produttori; i++)
+    {
+        processi[i] = fork();
+        if (processi[i] == -1)
+        {
+            perror("fork error");
+            exit(EXIT_FAILURE);
+        }
+        if (processi[i] == 0)
+        {
+            fissa_cpu(cpu, n_cpu, consumatori + i);
+            attendi_partenza(barriera);
+            for (int k = 0; k < riscaldamento; k++)
+            {
+                b->operazione(i);
+            }
+            long long *mie = latenze + (size_t)i * operazioni;
+            intervalli[2 * i] = ora_ns();
+            for (int k = 0; k < operazioni; k++)
+            {
+                long long inizio = ora_ns();
+                b->operazione(i);
+                mie[k] = ora_ns() - inizio;
+            }
+            intervalli[2 * i + 1] = ora_ns();
+            exit(EXIT_SUCCESS);
+        }
+    }
+
+    // Partenza: la barriera si apre quando tutti i processi sono stati creati
+    close(barriera[0]);
+    close(barriera[1]);
+
+    int falliti = 0;
+    for (int i = 0; i < produttori; i++)
+    {
+        int stato;
+        waitpid(processi[i], &stato, 0);
+        falliti += !WIFEXITED(stato) || WEXITSTATUS(stato) != EXIT_SUCCESS;
+    }
+    for (int i = 0; i < consumatori; i++)
+    {
+        int stato;
+        // Con un produttore fallito il consumatore non riceverà mai tutte le operazioni
+        if (falliti)
+        {
+            kill(processi[produttori + i], SIGKILL);
+        }
+        waitpid(processi[produttori + i], &stato, 0);
+        falliti += !falliti && (!WIFEXITED(stato) || WEXITSTATUS(stato) != EXIT_SUCCESS);
+    }
+    b->pulisci();
+
+    if (falliti)
+    {
+        dprintf(1, "%-20s %-16s %10d %12s\n", b->primitiva, b->implementazione, produttori, "errore");
+        munmap(latenze, dimensione);
+        return -1;
+    }
+
+    long long primo_inizio = intervalli[0], ultima_fine = intervalli[1];
+    for (int i = 1; i < produttori; i++)
+    {
+        primo_inizio = intervalli[2 * i] < primo_inizio ? intervalli[2 * i] : primo_inizio;
+        ultima_fine = intervalli[2 * i + 1] > ultima_fine ? intervalli[2 * i + 1] : ultima_fine;
+    }
+    size_t n = (size_t)produttori * operazioni;
+    qsort(latenze, n, sizeof(long long), confronta_latenze);
+    double al_secondo = ultima_fine > primo_inizio ? n * 1e9 / (ultima_fine - primo_inizio) : 0.0;
+
+    dprintf(1, "%-20s %-16s %10d %12.0f %10lld %10lld %10lld\n", b->primitiva, b->implementazione, produttori,
+            al_secondo, latenze[n / 2], latenze[(size_t)(n * 0.99)], latenze[(size_t)(n * 0.999)]);
+    munmap(latenze, dimensione);
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    int max_produttori = PRODUTTORI_DEFAULT;
+    int operazioni = 0;
+    int riscaldamento = -1;
+    const char *elenco_cpu = NULL;
+    const char *filtro = NULL;
+    int opzione;
+
+    while ((opzione = getopt(argc, argv, "p:n:w:c:b:")) != -1)
+    {
+        switch (opzione)
+        {
+        case 'p':
+            max_produttori = atoi(optarg);
+            break;
+        case 'n':
+            operazioni = atoi(optarg);
+            break;
+        case 'w':
+            riscaldamento = atoi(optarg);
+            break;
+        case 'c':
+            elenco_cpu = optarg;
+            break;
+        case 'b':
+            filtro = optarg;
+            break;
+        default:
+            fprintf(stderr, "Uso: %s [-p produttori] [-n operazioni] [-w riscaldamento] [-c cpu] [-b primitiva]\n", argv[0]);
+            exit(EXIT_FAILURE);
+        }
+    }
+    if (max_produttori < 1 || max_produttori > PRODUTTORI_MAX)
+    {
+        fprintf(stderr, "Il numero di produttori deve essere compreso tra 1 e %d\n", PRODUTTORI_MAX);
+        exit(EXIT_FAILURE);
+    }
+
+    cpu_set_t insieme;
+    if (elenco_cpu != NULL ? leggi_insieme_cpu(elenco_cpu, &insieme) == -1
+                           : sched_getaffinity(0, sizeof(insieme), &insieme) == -1)
+    {
+        fprintf(stderr, "Elenco di CPU non valido\n");
+        exit(EXIT_FAILURE);
+    }
+    int cpu[CPU_SETSIZE];
+    int n_cpu = 0;
+    for (int i = 0; i < CPU_SETSIZE; i++)
+    {
+        if (CPU_ISSET(i, &insieme))
+        {
+            cpu[n_cpu++] = i;
+        }
+    }
+
+    dprintf(1, "CPU usate: %d, produttori fino a %d\n\n", n_cpu, max_produttori);
+    dprintf(1, "%-20s %-16s %10s %12s %10s %10s %10s\n", "PRIMITIVA", "IMPLEMENTAZIONE", "PRODUTTORI", "OPS/S",
+            "P50 NS", "P99 NS", "P999 NS");
+
+    int errori = 0;
+    for (size_t i = 0; i < sizeof(banchi) / sizeof(banchi[0]); i++)
+    {
+        const banco *b = &banchi[i];
+        if (filtro != NULL && strstr(b->primitiva, filtro) == NULL)
+        {
+            continue;
+        }
+        int n_operazioni = operazioni > 0 ? operazioni : b->operazioni;
+        int n_riscaldamento = riscaldamento >= 0 ? riscaldamento : (n_operazioni + 9) / 10;
+
+        // 1, 2, 4, ... e infine il massimo richiesto
+        for (int produttori = 1;; produttori = produttori * 2 < max_produttori ? produttori * 2 : max_produttori)
+        {
+            errori += esegui_banco(b, produttori, n_operazioni, n_riscaldamento, cpu, n_cpu) == -1;
+            if (produttori == max_produttori)
+            {
+                break;
+            }
+        }
+    }
+    exit(errori ? EXIT_FAILURE : EXIT_SUCCESS);
+}
@@ -0,0 +1,585 @@
+#include <sys/wait.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "../lib/conf.h"
+#include "../lib/istanza.h"
+#include "../lib/report.h"
+#include "../lib/processi.h"
+
+/**
+ * @file ensemble.c
+ * @brief Esegue molte repliche della simulazione su una griglia di parametri e ne stima gli esiti.
+ *
+ * La griglia è un file nel formato di conf/: ogni riga `CHIAVE = v1, v2, ...` indica i valori
+ * da provare per un parametro, e la simulazione viene ripetuta per ogni combinazione. Le chiavi
+ * `BASE` (configurazione di partenza), `REPLICHE` e `INIBITORE` regolano l'esecuzione.
+ * Le repliche girano in parallelo come istanze indipendenti, al massimo una per CPU.
+ *
+ * Con un `SEME` fisso (nella base o nella griglia) ogni replica riceve il seme più il proprio
+ * indice, altrimenti le repliche di una combinazione seguirebbero tutte la stessa traiettoria.
+ *
+ * Per ogni combinazione vengono riportate le frequenze degli esiti con intervallo di confidenza
+ * di Wilson al 95%, le statistiche dell'energia finale e del tempo all'esito, sia a video sia
+ * in un file CSV.
+ *
+ * Uso: bin/ensemble <griglia> [risultato.csv] [repliche in parallelo]
+ */
+
+#define DIRECTORY_ENSEMBLE "build/ensemble"
+#define RISULTATO_DEFAULT DIRECTORY_ENSEMBLE "/risultato.csv"
+#define MAX_PARAMETRI 16
+#define MAX_VALORI 32
+#define LUNGHEZZA_VALORE 32
+#define REPLICHE_DEFAULT 10
+#define Z_95 1.96
+
+/**
+ * @struct parametro_griglia_
+ * @brief Un parametro della griglia con i valori da provare.
+ */
+typedef struct parametro_griglia_
+{
+    char nome[64];
+    char valori[MAX_VALORI][LUNGHEZZA_VALORE];
+    int n_valori;
+} parametro_griglia;
+
+/**
+ * @struct griglia_
+ * @brief Griglia di parametri letta dal file.
+ */
+typedef struct griglia_
+{
+    char base[256];
+    int repliche;
+    int inibitore;
+    parametro_griglia parametri[MAX_PARAMETRI];
+    int n_parametri;
+} griglia;
+
+/**
+ * @struct statistica_
+ * @brief Media e varianza calcolate in modo incrementale (algoritmo di Welford).
+ */
+typedef struct statistica_
+{
+    int n;
+    double media;
+    double m2;
+    double minimo;
+    double massimo;
+} statistica;
+
+/**
+ * @struct punto_griglia_
+ * @brief Risultati aggregati delle repliche di una combinazione di parametri.
+ */
+typedef struct punto_griglia_
+{
+    int esiti[N_ESITI];
+    int completate;
+    int fallite;
+    statistica energia;
+    statistica tempo;
+} punto_griglia;
+
+/**
+ * @struct esecuzione_
+ * @brief Replica in corso su uno slot di esecuzione.
+ */
+typedef struct esecuzione_
+{
+    pid_t pid;
+    int punto;
+} esecuzione;
+
+griglia g;
+
+griglia leggi_griglia(const char *percorso);
+int numero_punti();
+void valori_punto(int punto, int *indici);
+unsigned long long scrivi_configurazione(int punto, const char *percorso);
+void scrivi_replica(const char *configurazione, const char *percorso, unsigned long long seme);
+void aggiungi_campione(statistica *s, double x);
+double deviazione_standard(const statistica *s);
+void intervallo_wilson(int successi, int n, double *basso, double *alto);
+void stampa_risultati(punto_griglia *punti, int n_punti);
+int scrivi_risultati(const char *percorso, punto_griglia *punti, int n_punti);
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "Uso: %s <griglia> [risultato.csv] [repliche in parallelo]\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    g = leggi_griglia(argv[1]);
+    const char *risultato = argc > 2 ? argv[2] : RISULTATO_DEFAULT;
+
+    long cpu = sysconf(_SC_NPROCESSORS_ONLN);
+    int parallelismo = argc > 3 ? atoi(argv[3]) : (cpu > 0 ? (int)cpu : 1);
+    // L'istanza 0 resta libera per le simulazioni avviate a mano
+    if (parallelismo > ISTANZE_MAX - 1)
+    {
+        parallelismo = ISTANZE_MAX - 1;
+    }
+    if (parallelismo < 1)
+    {
+        parallelismo = 1;
+    }
+
+    int n_punti = numero_punti();
+    int totale = n_punti * g.repliche;
+
+    mkdir("build", 0755);
+    mkdir(DIRECTORY_ENSEMBLE, 0755);
+
+    unsigned long long *semi = calloc(n_punti, sizeof(unsigned long long));
+    if (semi == NULL)
+    {
+        perror("calloc error");
+        exit(EXIT_FAILURE);
+    }
+    for (int p = 0; p < n_punti; p++)
+    {
+        char percorso[128];
+        sprintf(percorso, DIRECTORY_ENSEMBLE "/punto_%d.txt", p);
+        semi[p] = scrivi_configurazione(p, percorso);
+    }
+
+    punto_griglia *punti = calloc(n_punti, sizeof(punto_griglia));
+    esecuzione *slot = calloc(parallelismo, sizeof(esecuzione));
+    if (punti == NULL || slot == NULL)
+    {
+        perror("calloc error");
+        exit(EXIT_FAILURE);
+    }
+
+    dprintf(1, "Griglia %s: %d combinazioni x %d repliche = %d simulazioni, %d in parallelo\n",
+            argv[1], n_punti, g.repliche, totale, parallelismo);
+
+    struct timespec inizio;
+    clock_gettime(CLOCK_MONOTONIC, &inizio);
+
+    int avviate = 0, terminate = 0, in_corso = 0;
+    while (terminate < totale)
+    {
+        // Occupa gli slot liberi con le repliche ancora da eseguire
+        for (int s = 0; s < parallelismo && avviate < totale; s++)
+        {
+            if (slot[s].pid > 0)
+            {
+                continue;
+            }
+            char configurazione[128], percorso_log[128], percorso_report[128];
+            int punto = avviate / g.repliche;
+            sprintf(configurazione, DIRECTORY_ENSEMBLE "/punto_%d.txt", punto);
+            if (semi[punto] != 0)
+            {
+                // Un seme fisso per replica: la configurazione del punto con il seme spostato dell'indice
+                char replica[128];
+                sprintf(replica, DIRECTORY_ENSEMBLE "/replica_%d.txt", s + 1);
+                scrivi_replica(configurazione, replica, semi[punto] + avviate % g.repliche);
+                strcpy(configurazione, replica);
+            }
+            sprintf(percorso_log, DIRECTORY_ENSEMBLE "/istanza_%d.log", s + 1);
+            sprintf(percorso_report, DIRECTORY_ENSEMBLE "/report_%d.txt", s + 1);
+
+            pid_t pid = avvia_istanza(s + 1, g.inibitore, configurazione, percorso_log, percorso_report);
+            avviate++;
+            if (pid == -1)
+            {
+                punti[punto].fallite++;
+                terminate++;
+                continue;
+            }
+            slot[s].pid = pid;
+            slot[s].punto = punto;
+            in_corso++;
+        }
+
+        if (in_corso == 0)
+        {
+            continue;
+        }
+
+        pid_t pid = wait(NULL);
+        if (pid == -1)
+        {
+            perror("wait error");
+            exit(EXIT_FAILURE);
+        }
+        for (int s = 0; s < parallelismo; s++)
+        {
+            if (slot[s].pid != pid)
+            {
+                continue;
+            }
+            char percorso_report[128];
+            report_simulazione report;
+            punto_griglia *punto = &punti[slot[s].punto];
+            sprintf(percorso_report, DIRECTORY_ENSEMBLE "/report_%d.txt", s + 1);
+
+            if (leggi_report(percorso_report, &report) == -1)
+            {
+                punto->fallite++;
+            }
+            else
+            {
+                punto->esiti[report.causa_terminazione]++;
+                punto->completate++;
+                aggiungi_campione(&punto->energia, (double)report.energia_totale);
+                aggiungi_campione(&punto->tempo, (double)report.tempo_passato);
+            }
+            slot[s].pid = 0;
+            in_corso--;
+            terminate++;
+            dprintf(1, "\r%d/%d simulazioni completate", terminate, totale);
+            break;
+        }
+    }
+    dprintf(1, "\nDurata complessiva: %ld ms\n\n", millisecondi_da(&inizio));
+
+    stampa_risultati(punti, n_punti);
+    if (scrivi_risultati(risultato, punti, n_punti) == 0)
+    {
+        dprintf(1, "\nRisultati scritti in %s\n", risultato);
+    }
+
+    free(semi);
+    free(punti);
+    free(slot);
+    exit(EXIT_SUCCESS);
+}
+
+/**
+ * @brief Legge la griglia dei parametri.
+ *
+ * Le righe seguono il formato dei file di configurazione, con i commenti `//`; il valore di
+ * un parametro può essere un elenco separato da virgole.
+ *
+ * @param percorso Percorso del file della griglia
+ * @return La griglia letta, termina il programma in caso di errore
+ */
+griglia leggi_griglia(const char *percorso)
+{
+    griglia letta = {0};
+    strcpy(letta.base, CONFIGURAZIONE_DEFAULT);
+    letta.repliche = REPLICHE_DEFAULT;
+    letta.inibitore = 1;
+
+    FILE *file = fopen(percorso, "r");
+    if (file == NULL)
+    {
+        perror("Errore nell'aprire la griglia");
+        exit(EXIT_FAILURE);
+    }
+
+    char line[1024];
+    while (fgets(line, sizeof(line), file))
+    {
+        char *comment_start = strstr(line, "//");
+        if (comment_start != NULL)
+        {
+            *comment_start = '\0';
+        }
+
+        char nome[64], valori[1024];
+        if (sscanf(line, " %63[A-Z_0-9] = %1023[^\n]", nome, valori) != 2)
+        {
+            continue;
+        }
+
+        if (strcmp(nome, "BASE") == 0)
+        {
+            sscanf(valori, "%255s", letta.base);
+            continue;
+        }
+        if (strcmp(nome, "REPLICHE") == 0)
+        {
+            letta.repliche = atoi(valori);
+            continue;
+        }
+        if (strcmp(nome, "INIBITORE") == 0)
+        {
+            letta.inibitore = atoi(valori);
+            continue;
+        }
+
+        if (letta.n_parametri == MAX_PARAMETRI)
+        {
+            fprintf(stderr, "Troppi parametri nella griglia (massimo %d)\n", MAX_PARAMETRI);
+            exit(EXIT_FAILURE);
+        }
+        parametro_griglia *parametro = &letta.parametri[letta.n_parametri++];
+        strcpy(parametro->nome, nome);
+
+        for (char *valore = strtok(valori, ", \t\r"); valore != NULL; valore = strtok(NULL, ", \t\r"))
+        {
+            if (parametro->n_valori == MAX_VALORI)
+            {
+                fprintf(stderr, "Troppi valori per %s (massimo %d)\n", nome, MAX_VALORI);
+                exit(EXIT_FAILURE);
+            }
+            snprintf(parametro->valori[parametro->n_valori++], LUNGHEZZA_VALORE, "%s", valore);
+        }
+        if (parametro->n_valori == 0)
+        {
+            fprintf(stderr, "Nessun valore per %s\n", nome);
+            exit(EXIT_FAILURE);
+        }
+    }
+    fclose(file);
+
+    if (letta.repliche <= 0)
+    {
+        fprintf(stderr, "REPLICHE deve essere positivo\n");
+        exit(EXIT_FAILURE);
+    }
+    return letta;
+}
+
+/**
+ * @brief Numero di combinazioni della griglia (prodotto cartesiano dei valori).
+ *
+ * @return Numero di combinazioni
+ */
+int numero_punti()
+{
+    int n = 1;
+    for (int i = 0; i < g.n_parametri; i++)
+    {
+        n *= g.parametri[i].n_valori;
+    }
+    return n;
+}
+
+/**
+ * @brief Ricava gli indici dei valori di una combinazione, con l'ultimo parametro che varia più velocemente.
+ *
+ * @param punto Indice della combinazione
+ * @param indici Indice del valore scelto per ogni parametro
+ */
+void valori_punto(int punto, int *indici)
+{
+    for (int i = g.n_parametri - 1; i >= 0; i--)
+    {
+        indici[i] = punto % g.parametri[i].n_valori;
+        punto /= g.parametri[i].n_valori;
+    }
+}
+
+/**
+ * @brief Scrive la configurazione di una combinazione: la configurazione di base seguita dai valori della griglia.
+ *
+ * I valori della griglia vengono accodati, quindi prevalgono su quelli di base.
+ *
+ * @param punto Indice della combinazione
+ * @param percorso File da scrivere
+ * @return Il `SEME` della combinazione, 0 se il seme non è fisso
+ */
+unsigned long long scrivi_configurazione(int punto, const char *percorso)
+{
+    unsigned long long seme = 0;
+    FILE *base = fopen(g.base, "r");
+    FILE *file = fopen(percorso, "w");
+    if (base == NULL || file == NULL)
+    {
+        perror("Errore nello scrivere la configurazione");
+        exit(EXIT_FAILURE);
+    }
+
+    char line[256];
+    while (fgets(line, sizeof(line), base))
+    {
+        fputs(line, file);
+        sscanf(line, "SEME = %llu", &seme);
+    }
+    fclose(base);
+
+    int indici[MAX_PARAMETRI];
+    valori_punto(punto, indici);
+    fprintf(file, "\n");
+    for (int i = 0; i < g.n_parametri; i++)
+    {
+        fprintf(file, "%s = %s\n", g.parametri[i].nome, g.parametri[i].valori[indici[i]]);
+        if (strcmp(g.parametri[i].nome, "SEME") == 0)
+        {
+            seme = strtoull(g.parametri[i].valori[indici[i]], NULL, 10);
+        }
+    }
+    fclose(file);
+    return seme;
+}
+
+/**
+ * @brief Scrive la configurazione di una replica: quella della combinazione con un proprio `SEME`.
+ *
+ * @param configurazione Configurazione della combinazione
+ * @param percorso File da scrivere
+ * @param seme Seme della replica
+ */
+void scrivi_replica(const char *configurazione, const char *percorso, unsigned long long seme)
+{
+    FILE *punto = fopen(configurazione, "r");
+    FILE *file = fopen(percorso, "w");
+    if (punto == NULL || file == NULL)
+    {
+        perror("Errore nello scrivere la configurazione");
+        exit(EXIT_FAILURE);
+    }
+
+    char line[256];
+    while (fgets(line, sizeof(line), punto))
+    {
+        fputs(line, file);
+    }
+    fclose(punto);
+    fprintf(file, "SEME = %llu\n", seme);
+    fclose(file);
+}
+
+void aggiungi_campione(statistica *s, double x)
+{
+    s->n++;
+    if (s->n == 1)
+    {
+        s->minimo = s->massimo = x;
+    }
+    else
+    {
+        s->minimo = x < s->minimo ? x : s->minimo;
+        s->massimo = x > s->massimo ? x : s->massimo;
+    }
+    double delta = x - s->media;
+    s->media += delta / s->n;
+    s->m2 += delta * (x - s->media);
+}
+
+double deviazione_standard(const statistica *s)
+{
+    return s->n > 1 ? sqrt(s->m2 / (s->n - 1)) : 0.0;
+}
+
+/**
+ * @brief Intervallo di confidenza di Wilson al 95% per una proporzione.
+ *
+ * A differenza dell'approssimazione normale resta dentro [0, 1] anche con poche repliche
+ * o frequenze vicine a 0 e 1.
+ *
+ * @param successi Numero di repliche con l'esito considerato
+ * @param n Numero di repliche completate
+ * @param basso Estremo inferiore
+ * @param alto Estremo superiore
+ */
+void intervallo_wilson(int successi, int n, double *basso, double *alto)
+{
+    if (n == 0)
+    {
+        *basso = 0.0;
+        *alto = 1.0;
+        return;
+    }
+    double p = (double)successi / n;
+    double z2 = Z_95 * Z_95;
+    double denominatore = 1.0 + z2 / n;
+    double centro = (p + z2 / (2.0 * n)) / denominatore;
+    double margine = Z_95 * sqrt(p * (1.0 - p) / n + z2 / (4.0 * n * n)) / denominatore;
+    *basso = centro - margine < 0.0 ? 0.0 : centro - margine;
+    *alto = centro + margine > 1.0 ? 1.0 : centro + margine;
+}
+
+void stampa_risultati(punto_griglia *punti, int n_punti)
+{
+    for (int p = 0; p < n_punti; p++)
+    {
+        int indici[MAX_PARAMETRI];
+        valori_punto(p, indici);
+
+        dprintf(1, "Combinazione %d:", p);
+        for (int i = 0; i < g.n_parametri; i++)
+        {
+            dprintf(1, " %s=%s", g.parametri[i].nome, g.parametri[i].valori[indici[i]]);
+        }
+        dprintf(1, "\n  repliche completate %d, fallite %d\n", punti[p].completate, punti[p].fallite);
+
+        for (int e = 0; e < N_ESITI; e++)
+        {
+            double basso, alto;
+            intervallo_wilson(punti[p].esiti[e], punti[p].completate, &basso, &alto);
+            dprintf(1, "  %-9s %4d  %5.1f%%  [%5.1f%%, %5.1f%%]\n", nome_esito(e), punti[p].esiti[e],
+                    punti[p].completate > 0 ? 100.0 * punti[p].esiti[e] / punti[p].completate : 0.0,
+                    100.0 * basso, 100.0 * alto);
+        }
+        dprintf(1, "  energia finale: media %.0f, dev. std. %.0f, min %.0f, max %.0f\n",
+                punti[p].energia.media, deviazione_standard(&punti[p].energia),
+                punti[p].energia.minimo, punti[p].energia.massimo);
+        dprintf(1, "  tempo all'esito: media %.2f s, dev. std. %.2f s\n",
+                punti[p].tempo.media, deviazione_standard(&punti[p].tempo));
+    }
+}
+
+/**
+ * @brief Scrive i risultati in CSV, una riga per combinazione.
+ *
+ * @param percorso File da scrivere
+ * @param punti Risultati delle combinazioni
+ * @param n_punti Numero di combinazioni
+ * @return 0 in caso di successo, -1 in caso di errore
+ */
+int scrivi_risultati(const char *percorso, punto_griglia *punti, int n_punti)
+{
+    FILE *file = fopen(percorso, "w");
+    if (file == NULL)
+    {
+        perror("Errore nello scrivere i risultati");
+        return -1;
+    }
+
+    fprintf(file, "punto");
+    for (int i = 0; i < g.n_parametri; i++)
+    {
+        fprintf(file, ",%s", g.parametri[i].nome);
+    }
+    fprintf(file, ",repliche,fallite");
+    for (int e = 0; e < N_ESITI; e++)
+    {
+        const char *nome = nome_esito(e);
+        fprintf(file, ",%s,%s_freq,%s_ic_basso,%s_ic_alto", nome, nome, nome, nome);
+    }
+    fprintf(file, ",energia_media,energia_dev_std,energia_min,energia_max,tempo_medio,tempo_dev_std\n");
+
+    for (int p = 0; p < n_punti; p++)
+    {
+        int indici[MAX_PARAMETRI];
+        valori_punto(p, indici);
+
+        fprintf(file, "%d", p);
+        for (int i = 0; i < g.n_parametri; i++)
+        {
+            fprintf(file, ",%s", g.parametri[i].valori[indici[i]]);
+        }
+        fprintf(file, ",%d,%d", punti[p].completate, punti[p].fallite);
+        for (int e = 0; e < N_ESITI; e++)
+        {
+            double basso, alto;
+            intervallo_wilson(punti[p].esiti[e], punti[p].completate, &basso, &alto);
+            fprintf(file, ",%d,%.4f,%.4f,%.4f", punti[p].esiti[e],
+                    punti[p].completate > 0 ? (double)punti[p].esiti[e] / punti[p].completate : 0.0,
+                    basso, alto);
+        }
+        fprintf(file, ",%.1f,%.1f,%.0f,%.0f,%.3f,%.3f\n",
+                punti[p].energia.media, deviazione_standard(&punti[p].energia),
+                punti[p].energia.minimo, punti[p].energia.massimo,
+                punti[p].tempo.media, deviazione_standard(&punti[p].tempo));
+    }
+
+    fclose(file);
+    return 0;
+}
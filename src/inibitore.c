@@ -4,19 +4,24 @@
 #include <signal.h>
 #include <stdlib.h>
 #include <time.h>
+#include <errno.h>
 #include "../lib/handler.h"
 #include "../lib/code.h"
 #include "../lib/semaphore.h"
 #include "../lib/shared_memory.h"
 #include "../lib/conf.h"
+#include "../lib/processi.h"
+#include "../lib/istanza.h"
+#include "../lib/ammissione.h"
+#include "../lib/pianificazione.h"
+#include "../lib/inibizione.h"
+#include "../lib/casuale.h"
 
 SimulationParams params;
 int inibitore_attivo = 1;
-int energia_assorbita_ultimo_sec;
 
 shmseg2 *memoria2;
-
-#define MAX_ATOMI_ATTIVI 1000
+controllore_ammissione ammissione;
 
 void inibitore_handler(int signum)
 {
@@ -33,88 +38,65 @@ void inibitore_handler(int signum)
 
 int main()
 {
-    pid_t pid_inibitore = getpid();
     set_handler(inibitore_handler, SIGUSR2);
 
     ignore(SIGINT);
-    const char *filename = "conf/config.txt";
+    const char *filename = percorso_configurazione();
     params = read_params_from_file(filename);
+    applica_profilo(&params, COMPONENTE_INIBITORE);
 
-    int m1 = create_shared_memory("src/master.c", sizeof(shmseg));
+    int istanza = istanza_corrente();
+    int m1 = create_shared_memory("src/master.c", istanza, sizeof(shmseg));
     shmseg *memoria = attach_shared_memory(m1);
-    int queue = memoria->id_queue;
-    int start = memoria->id_start;
-    int sem = memoria->id_semaphore;
-    int sem_sezione_critica_inib = memoria->sem_sezione_critica_inib;
-    int sem_blocca_master = memoria->sem_blocca_master;
-    int sem_blocca_inib = memoria->sem_blocca_inib;
-    int sem_scissione = memoria->sem_scissione;
-
 
-    int m2 = create_shared_memory("src/inibitore.c", sizeof(shmseg2));
+    int m2 = create_shared_memory("src/inibitore.c", istanza, sizeof(shmseg2));
     memoria2 = attach_shared_memory2(m2);
 
-    wait_for_zero_sem(start);
+    inizializza_ammissione(&ammissione, calcola_obiettivo_atomi(&params), params.frequenza_inibitore);
+    memoria2->obiettivo_atomi = ammissione.obiettivo;
 
-    while (sem_getvalue(sem) == 0)
+    if (!attendi_avvio(memoria))
     {
-        decrease_sem(sem_blocca_inib);
-
-        if (inibitore_attivo)
-        {
-
-            decrease_sem(sem_sezione_critica_inib);
-
-            if (((memoria2->energia_totale + memoria2->energia_totale_ultimo_secondo) > params.energy_explode_threshold * 0.75))
-    
-            {
-                
-                // Calcola l'energia da assorbire
-                memoria2->energia_assorbita_ultimo_sec = (memoria2->energia_totale + memoria2->energia_totale_ultimo_secondo) - (params.energy_explode_threshold / 2);
-
-                memoria2->energia_assorbita += memoria2->energia_assorbita_ultimo_sec;
-                // Aggiorna l'energia totale
-                memoria2->energia_totale = (memoria2->energia_totale + memoria2->energia_totale_ultimo_secondo) - memoria2->energia_assorbita_ultimo_sec;
-
-                // Debug: stampa l'energia totale prima e dopo l'assorbimento
-            }
-            else{
-                 memoria2->energia_assorbita_ultimo_sec =0;
-            }
-
-            
-
-            if (memoria2->atomi_attivi > MAX_ATOMI_ATTIVI) {
-              
-                
-                // Imposta il semaforo a 0 per bloccare la scissione
-                if (sem_setvalue(sem_scissione, 0) == -1) {
-                    fprintf(stderr, "Errore nell'impostare il valore del semaforo.\n");
-                    exit(1);
-                }
-                
-
-            } else {
-                // Imposta il semaforo a 1 per abilitare la scissione
-                if (sem_setvalue(sem_scissione, 1) == -1) {
-                    
-                    fprintf(stderr, "Errore nell'impostare il valore del semaforo.\n");
-                    exit(1);
-                }
-                
-            }
-
-            
+        exit(EXIT_SUCCESS);
+    }
 
+    // Il ciclo di controllo ha un proprio periodo e non attende il tick del master
+    long long periodo_ns = 1000000000LL / params.frequenza_inibitore;
+    struct timespec prossimo;
+    clock_gettime(CLOCK_MONOTONIC, &prossimo);
 
+    while (reattore_in_corso(memoria))
+    {
+        // Con l'inibitore disattivato scissioni e nuovi atomi non sono limitati
+        __atomic_store_n(&memoria2->ammissione_attiva, inibitore_attivo, __ATOMIC_RELEASE);
+        __atomic_store_n(&memoria2->inibitore_attivo, inibitore_attivo, __ATOMIC_RELAXED);
 
+        if (inibitore_attivo)
+        {
+            passo_inibitore(&params, memoria2, 1);
 
+            // Concede i permessi di scissione e di nuovi atomi in base agli atomi vivi, entro
+            // le scissioni che la previsione dell'energia lascia sotto la soglia
+            passo_ammissione(&ammissione, memoria, memoria2, conta_atomi_vivi(memoria2),
+                             __atomic_load_n(&memoria2->previsione.limite_permessi, __ATOMIC_RELAXED));
+        }
 
-            increase_sem(sem_sezione_critica_inib);
+        long long scadenza_ns = prossimo.tv_sec * 1000000000LL + prossimo.tv_nsec + periodo_ns;
+        prossimo.tv_sec = scadenza_ns / 1000000000LL;
+        prossimo.tv_nsec = scadenza_ns % 1000000000LL;
+        // Un segnale interrompe l'attesa: il passo successivo parte comunque alla scadenza
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &prossimo, NULL) == EINTR)
+        {
         }
 
-        increase_sem(sem_blocca_master);
+        // In ritardo di oltre un periodo (CPU contesa) si riparte da adesso invece di recuperare i passi persi
+        struct timespec adesso;
+        clock_gettime(CLOCK_MONOTONIC, &adesso);
+        if (adesso.tv_sec * 1000000000LL + adesso.tv_nsec > scadenza_ns + periodo_ns)
+        {
+            prossimo = adesso;
+        }
     }
 
     exit(EXIT_SUCCESS);
-}
\ No newline at end of file
+}
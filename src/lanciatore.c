@@ -0,0 +1,108 @@
+#include <sys/wait.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "../lib/istanza.h"
+#include "../lib/report.h"
+#include "../lib/processi.h"
+
+/**
+ * @file lanciatore.c
+ * @brief Avvia più istanze indipendenti del reattore e ne aggrega i resoconti finali.
+ *
+ * Ogni istanza è un master con un proprio identificativo (`REATTORE_ISTANZA`), quindi con
+ * chiavi IPC distinte. L'output di ciascuna istanza viene scritto in un file di log e il
+ * resoconto finale in un file letto al termine per costruire il riepilogo.
+ *
+ * Uso: bin/lanciatore <istanze> [inibitore 0|1] [prima istanza]
+ */
+
+#define DIRECTORY_ISTANZE "build/istanze"
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "Uso: %s <istanze> [inibitore 0|1] [prima istanza]\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    int n_istanze = atoi(argv[1]);
+    int inibitore = argc > 2 ? atoi(argv[2]) : 1;
+    int prima = argc > 3 ? atoi(argv[3]) : 0;
+
+    if (n_istanze <= 0 || prima < 0 || prima + n_istanze > ISTANZE_MAX)
+    {
+        fprintf(stderr, "Istanze da %d a %d non valide (massimo %d)\n", prima, prima + n_istanze - 1, ISTANZE_MAX);
+        exit(EXIT_FAILURE);
+    }
+
+    mkdir("build", 0755);
+    mkdir(DIRECTORY_ISTANZE, 0755);
+
+    struct timespec inizio;
+    clock_gettime(CLOCK_MONOTONIC, &inizio);
+
+    int avviate = 0;
+    for (int i = prima; i < prima + n_istanze; i++)
+    {
+        char percorso_log[128];
+        char percorso_report[128];
+        sprintf(percorso_log, DIRECTORY_ISTANZE "/istanza_%d.log", i);
+        sprintf(percorso_report, DIRECTORY_ISTANZE "/report_%d.txt", i);
+        if (avvia_istanza(i, inibitore, NULL, percorso_log, percorso_report) != -1)
+        {
+            avviate++;
+        }
+    }
+    dprintf(1, "Avviate %d istanze (%d-%d), log in %s\n", avviate, prima, prima + n_istanze - 1, DIRECTORY_ISTANZE);
+
+    while (wait(NULL) > 0)
+        ;
+    long durata_ms = millisecondi_da(&inizio);
+
+    // RIEPILOGO
+    int esiti[N_ESITI] = {0};
+    int completate = 0;
+    long long energia_totale = 0, scissioni = 0, scorie = 0, attivazioni = 0, atomi = 0, fork_evitate = 0;
+
+    dprintf(1, "\n%-8s %-10s %8s %14s %10s %10s %12s\n", "istanza", "esito", "tempo", "energia", "scissioni", "scorie", "attivazioni");
+    for (int i = prima; i < prima + n_istanze; i++)
+    {
+        char percorso_report[128];
+        report_simulazione report;
+        sprintf(percorso_report, DIRECTORY_ISTANZE "/report_%d.txt", i);
+
+        if (leggi_report(percorso_report, &report) == -1)
+        {
+            dprintf(1, "%-8d %-10s\n", i, "ERRORE");
+            continue;
+        }
+        completate++;
+        esiti[report.causa_terminazione]++;
+        energia_totale += report.energia_totale;
+        scissioni += report.scissioni;
+        scorie += report.scorie;
+        attivazioni += report.attivazioni;
+        atomi += report.atomi_raccolti;
+        fork_evitate += report.fork_evitate;
+        dprintf(1, "%-8d %-10s %8d %14lld %10lld %10lld %12lld\n", i, nome_esito(report.causa_terminazione),
+                report.tempo_passato, report.energia_totale, report.scissioni, report.scorie, report.attivazioni);
+    }
+
+    dprintf(1, "\nIstanze completate: %d su %d in %ld ms\n", completate, n_istanze, durata_ms);
+    for (int e = 0; e < N_ESITI; e++)
+    {
+        dprintf(1, "%s: %d\n", nome_esito(e), esiti[e]);
+    }
+    if (completate > 0)
+    {
+        dprintf(1, "Energia finale media: %lld\n", energia_totale / completate);
+        dprintf(1, "Totali: scissioni %lld, scorie %lld, attivazioni %lld, atomi raccolti %lld, fork evitate %lld\n",
+                scissioni, scorie, attivazioni, atomi, fork_evitate);
+    }
+
+    exit(completate == n_istanze ? EXIT_SUCCESS : EXIT_FAILURE);
+}
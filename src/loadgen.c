@@ -0,0 +1,382 @@
+#include <sys/mman.h>
+#include <sys/shm.h>
+#include <sys/wait.h>
+#include <signal.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../lib/handler.h"
+#include "../lib/code.h"
+#include "../lib/shared_memory.h"
+#include "../lib/conf.h"
+#include "../lib/istanza.h"
+#include "../lib/processi.h"
+#include "../lib/eventi.h"
+
+/**
+ * @file loadgen.c
+ * @brief Generatore di carico sintetico per misurare la capacità del master e dell'inibitore.
+ *
+ * Si collega a un master già in esecuzione (istanza di REATTORE_ISTANZA) e impersona N atomi
+ * virtuali che inviano sulle code del reattore, con lo stesso protocollo di lib/eventi.c, un
+ * ciclo di record realistico: attivazione, scissione con energia, scoria, nascita, scoria. Il
+ * numero di atomi resta quindi in equilibrio. L'invio è ripartito tra più processi produttori
+ * (ognuno scrive sulla coda degli atomi scelta dal proprio PID) e avviene a raffiche.
+ *
+ * Il carico cresce a gradini: ogni gradino moltiplica il tasso per un fattore. Durante il
+ * gradino il processo principale campiona i messaggi in attesa nelle code, il ritardo del tick
+ * pubblicato dal master e i passi al secondo dell'inibitore. Il gradino è sostenuto se
+ * l'arretrato e il ritardo restano sotto le soglie, l'inibitore mantiene la sua frequenza e i
+ * produttori raggiungono il tasso richiesto; al primo gradino non sostenuto viene riportato
+ * l'ultimo tasso sostenuto.
+ *
+ * Il master va avviato con una configurazione che non termini per energia, per esempio
+ * conf/carico.txt.
+ *
+ * Uso: bin/loadgen [-a atomi] [-p produttori] [-r tasso] [-f fattore] [-d secondi] [-b raffica]
+ *                  [-e energia] [-q arretrato] [-l ritardo_ms]
+ */
+
+#define ATOMI_DEFAULT 10000
+#define PRODUTTORI_DEFAULT N_CODE_ATOMI
+#define PRODUTTORI_MAX 64
+#define TASSO_DEFAULT 1000.0
+#define FATTORE_DEFAULT 2.0
+#define DURATA_DEFAULT 3
+#define RAFFICA_DEFAULT 1
+#define ENERGIA_DEFAULT 1
+// Messaggi in attesa nelle code oltre i quali il master non tiene il passo
+#define SOGLIA_ARRETRATO_DEFAULT 1000
+#define SOGLIA_RITARDO_MS_DEFAULT 100
+#define CAMPIONAMENTO_MS 100
+// Frazione del tasso richiesto (o della frequenza dell'inibitore) sotto la quale il gradino non è sostenuto
+#define FRAZIONE_SOSTENUTA 0.9
+// I PID virtuali partono oltre il pid_max predefinito, così non si confondono con processi reali
+#define PID_VIRTUALE_BASE (1 << 22)
+
+/**
+ * @struct opzioni_carico_
+ * @brief Parametri del generatore letti dalla riga di comando.
+ */
+typedef struct opzioni_carico_
+{
+    int atomi;
+    int produttori;
+    double tasso;
+    double fattore;
+    int durata;
+    int raffica;
+    int energia;
+    long arretrato;
+    long ritardo_ms;
+} opzioni_carico;
+
+/**
+ * @struct misura_gradino_
+ * @brief Quanto osservato durante un gradino di carico.
+ */
+typedef struct misura_gradino_
+{
+    double inviati_al_secondo;
+    unsigned long arretrato_massimo;
+    long long ritardo_massimo_us;
+    double passi_inibitore_al_secondo;
+    int inibitore_attivo;
+    int reattore_terminato;
+} misura_gradino;
+
+// Ciclo di record di ogni atomo virtuale: le nascite compensano le scorie
+const int ciclo[] = {RECORD_ATTIVAZIONE, RECORD_SCISSIONE, RECORD_SCORIA, RECORD_NASCITA, RECORD_SCORIA};
+#define LUNGHEZZA_CICLO ((int)(sizeof(ciclo) / sizeof(ciclo[0])))
+
+shmseg *memoria;
+shmseg2 *memoria2;
+
+/**
+ * @brief Collega il generatore ai segmenti di un master in esecuzione, senza crearli.
+ *
+ * @return 0 in caso di successo, -1 se l'istanza non ha un master attivo
+ */
+int collega_reattore(int istanza)
+{
+    int m1 = shmget(chiave_ipc("src/master.c", istanza), 0, 0);
+    int m2 = shmget(chiave_ipc("src/inibitore.c", istanza), 0, 0);
+    if (m1 == -1 || m2 == -1)
+    {
+        return -1;
+    }
+    memoria = attach_shared_memory(m1);
+    memoria2 = attach_shared_memory2(m2);
+    return reattore_in_corso(memoria) ? 0 : -1;
+}
+
+/**
+ * @brief Compila il record di un passo del ciclo di un atomo virtuale.
+ */
+record_evento record_virtuale(int atomo, int passo, const opzioni_carico *opzioni)
+{
+    int tipo = ciclo[passo % LUNGHEZZA_CICLO];
+    record_evento record = nuovo_record(tipo);
+    record.pid = PID_VIRTUALE_BASE + atomo;
+    record.genitore = PID_VIRTUALE_BASE + atomo;
+    record.n_atomico = 50;
+    switch (tipo)
+    {
+    case RECORD_ATTIVAZIONE:
+        record.valore = 1;
+        break;
+    case RECORD_SCISSIONE:
+        record.n_atomico_figlio = 25;
+        record.energia = opzioni->energia;
+        record.delta_atomi = 1;
+        break;
+    case RECORD_SCORIA:
+        record.delta_atomi = -1;
+        break;
+    case RECORD_NASCITA:
+        record.delta_atomi = 1;
+        break;
+    }
+    return record;
+}
+
+/**
+ * @brief Invia i record di un produttore fino alla fine del gradino, a raffiche al tasso richiesto.
+ *
+ * @param indice Indice del produttore: gestisce gli atomi virtuali congruenti a indice modulo produttori
+ * @param tasso Record al secondo di questo produttore
+ * @param fine_ns Fine del gradino (CLOCK_MONOTONIC)
+ * @return Record inviati
+ */
+long long produci(int indice, double tasso, long long fine_ns, const opzioni_carico *opzioni)
+{
+    int atomi = (opzioni->atomi - indice + opzioni->produttori - 1) / opzioni->produttori;
+    long long periodo_ns = (long long)(opzioni->raffica * 1e9 / tasso);
+    struct timespec prossima;
+    clock_gettime(CLOCK_MONOTONIC, &prossima);
+    long long inviati = 0;
+
+    while (reattore_in_corso(memoria))
+    {
+        long long adesso_ns = prossima.tv_sec * 1000000000LL + prossima.tv_nsec;
+        if (adesso_ns >= fine_ns)
+        {
+            break;
+        }
+        for (int i = 0; i < opzioni->raffica; i++, inviati++)
+        {
+            int atomo = indice + (int)(inviati % atomi) * opzioni->produttori;
+            record_evento record = record_virtuale(atomo, (int)(inviati / atomi), opzioni);
+            pubblica_record(memoria, memoria2, &record);
+        }
+        // La raffica successiva parte a una scadenza assoluta: un produttore in ritardo non dorme
+        long long scadenza_ns = adesso_ns + periodo_ns;
+        prossima.tv_sec = scadenza_ns / 1000000000LL;
+        prossima.tv_nsec = scadenza_ns % 1000000000LL;
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &prossima, NULL);
+    }
+    return inviati;
+}
+
+/**
+ * @brief Somma i messaggi in attesa in tutte le code del reattore.
+ */
+unsigned long arretrato_code()
+{
+    unsigned long messaggi = 0;
+    for (int i = 0; i < N_CODE; i++)
+    {
+        stato_coda stato;
+        if (leggi_stato_coda(memoria->id_code[i], &stato) == 0)
+        {
+            messaggi += stato.messaggi;
+        }
+    }
+    return messaggi;
+}
+
+/**
+ * @brief Esegue un gradino di carico: avvia i produttori e campiona il reattore fino alla fine.
+ */
+void esegui_gradino(double tasso, const opzioni_carico *opzioni, long long *inviati, misura_gradino *misura)
+{
+    struct timespec inizio;
+    clock_gettime(CLOCK_MONOTONIC, &inizio);
+    long long inizio_ns = inizio.tv_sec * 1000000000LL + inizio.tv_nsec;
+    long long fine_ns = inizio_ns + opzioni->durata * 1000000000LL;
+    unsigned long long passi_iniziali = __atomic_load_n(&memoria2->passi_inibitore, __ATOMIC_RELAXED);
+
+    pid_t produttori[PRODUTTORI_MAX];
+    for (int i = 0; i < opzioni->produttori; i++)
+    {
+        inviati[i] = 0;
+        produttori[i] = fork();
+        if (produttori[i] == -1)
+        {
+            perror("fork error");
+            exit(EXIT_FAILURE);
+        }
+        if (produttori[i] == 0)
+        {
+            inviati[i] = produci(i, tasso / opzioni->produttori, fine_ns, opzioni);
+            exit(EXIT_SUCCESS);
+        }
+    }
+
+    memset(misura, 0, sizeof(misura_gradino));
+    struct timespec attesa = {0, CAMPIONAMENTO_MS * 1000000L};
+    while (nanosecondi_da(&inizio) < opzioni->durata * 1000000000LL)
+    {
+        nanosleep(&attesa, NULL);
+        if (!reattore_in_corso(memoria))
+        {
+            misura->reattore_terminato = 1;
+            break;
+        }
+        unsigned long arretrato = arretrato_code();
+        long long ritardo_us = __atomic_load_n(&memoria2->ritardo_tick_us, __ATOMIC_RELAXED);
+        if (arretrato > misura->arretrato_massimo)
+        {
+            misura->arretrato_massimo = arretrato;
+        }
+        if (ritardo_us > misura->ritardo_massimo_us)
+        {
+            misura->ritardo_massimo_us = ritardo_us;
+        }
+    }
+
+    for (int i = 0; i < opzioni->produttori; i++)
+    {
+        waitpid(produttori[i], NULL, 0);
+    }
+    double secondi = nanosecondi_da(&inizio) / 1e9;
+    long long totale = 0;
+    for (int i = 0; i < opzioni->produttori; i++)
+    {
+        totale += inviati[i];
+    }
+    misura->inviati_al_secondo = totale / secondi;
+    misura->passi_inibitore_al_secondo =
+        (__atomic_load_n(&memoria2->passi_inibitore, __ATOMIC_RELAXED) - passi_iniziali) / secondi;
+    misura->inibitore_attivo = __atomic_load_n(&memoria2->inibitore_attivo, __ATOMIC_RELAXED);
+}
+
+int main(int argc, char *argv[])
+{
+    opzioni_carico opzioni = {ATOMI_DEFAULT, PRODUTTORI_DEFAULT, TASSO_DEFAULT, FATTORE_DEFAULT, DURATA_DEFAULT,
+                              RAFFICA_DEFAULT, ENERGIA_DEFAULT, SOGLIA_ARRETRATO_DEFAULT, SOGLIA_RITARDO_MS_DEFAULT};
+    int opzione;
+
+    while ((opzione = getopt(argc, argv, "a:p:r:f:d:b:e:q:l:")) != -1)
+    {
+        switch (opzione)
+        {
+        case 'a':
+            opzioni.atomi = atoi(optarg);
+            break;
+        case 'p':
+            opzioni.produttori = atoi(optarg);
+            break;
+        case 'r':
+            opzioni.tasso = atof(optarg);
+            break;
+        case 'f':
+            opzioni.fattore = atof(optarg);
+            break;
+        case 'd':
+            opzioni.durata = atoi(optarg);
+            break;
+        case 'b':
+            opzioni.raffica = atoi(optarg);
+            break;
+        case 'e':
+            opzioni.energia = atoi(optarg);
+            break;
+        case 'q':
+            opzioni.arretrato = atol(optarg);
+            break;
+        case 'l':
+            opzioni.ritardo_ms = atol(optarg);
+            break;
+        default:
+            fprintf(stderr, "Uso: %s [-a atomi] [-p produttori] [-r tasso] [-f fattore] [-d secondi] [-b raffica] "
+                            "[-e energia] [-q arretrato] [-l ritardo_ms]\n", argv[0]);
+            exit(EXIT_FAILURE);
+        }
+    }
+    if (opzioni.produttori < 1 || opzioni.produttori > PRODUTTORI_MAX)
+    {
+        fprintf(stderr, "Il numero di produttori deve essere compreso tra 1 e %d\n", PRODUTTORI_MAX);
+        exit(EXIT_FAILURE);
+    }
+    if (opzioni.atomi < opzioni.produttori || opzioni.tasso <= 0 || opzioni.fattore <= 1 ||
+        opzioni.durata <= 0 || opzioni.raffica <= 0)
+    {
+        fprintf(stderr, "Servono almeno un atomo per produttore, tasso e durata positivi, fattore maggiore di 1 e raffica positiva\n");
+        exit(EXIT_FAILURE);
+    }
+
+    int istanza = istanza_corrente();
+    if (collega_reattore(istanza) == -1)
+    {
+        fprintf(stderr, "Nessun master in esecuzione per l'istanza %d\n", istanza);
+        exit(EXIT_FAILURE);
+    }
+    SimulationParams params = read_params_from_file(percorso_configurazione());
+    ignore(SIGINT);
+
+    // I contatori dei produttori sopravvivono alle loro fork
+    long long *inviati = mmap(NULL, sizeof(long long) * PRODUTTORI_MAX, PROT_READ | PROT_WRITE,
+                              MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (inviati == MAP_FAILED)
+    {
+        perror("mmap error");
+        exit(EXIT_FAILURE);
+    }
+
+    dprintf(1, "Istanza %d: %d atomi virtuali, %d produttori, raffiche da %d, gradini da %d s (soglie: arretrato %ld messaggi, ritardo tick %ld ms)\n\n",
+            istanza, opzioni.atomi, opzioni.produttori, opzioni.raffica, opzioni.durata, opzioni.arretrato, opzioni.ritardo_ms);
+    dprintf(1, "%12s %12s %10s %12s %16s\n", "TASSO", "INVIATI/S", "ARRETRATO", "RITARDO MS", "PASSI INIB/S");
+
+    double sostenuto = 0;
+    const char *motivo = NULL;
+    for (double tasso = opzioni.tasso; motivo == NULL; tasso *= opzioni.fattore)
+    {
+        misura_gradino misura;
+        esegui_gradino(tasso, &opzioni, inviati, &misura);
+        dprintf(1, "%12.0f %12.0f %10lu %12.1f %16.1f\n", tasso, misura.inviati_al_secondo, misura.arretrato_massimo,
+                misura.ritardo_massimo_us / 1000.0, misura.passi_inibitore_al_secondo);
+
+        if (misura.reattore_terminato)
+        {
+            motivo = "il reattore ha terminato la simulazione";
+        }
+        else if (misura.arretrato_massimo > (unsigned long)opzioni.arretrato)
+        {
+            motivo = "arretrato delle code oltre la soglia";
+        }
+        else if (misura.ritardo_massimo_us > opzioni.ritardo_ms * 1000)
+        {
+            motivo = "ritardo del tick oltre la soglia";
+        }
+        else if (misura.inibitore_attivo &&
+                 misura.passi_inibitore_al_secondo < params.frequenza_inibitore * FRAZIONE_SOSTENUTA)
+        {
+            motivo = "inibitore sotto la propria frequenza";
+        }
+        else if (misura.inviati_al_secondo < tasso * FRAZIONE_SOSTENUTA)
+        {
+            motivo = "i produttori non raggiungono il tasso richiesto";
+        }
+        else
+        {
+            sostenuto = misura.inviati_al_secondo;
+        }
+    }
+
+    dprintf(1, "\nTasso massimo sostenibile: %.0f eventi/s (gradino successivo: %s)\n", sostenuto, motivo);
+    munmap(inviati, sizeof(long long) * PRODUTTORI_MAX);
+    exit(EXIT_SUCCESS);
+}
@@ -13,30 +13,78 @@
 SimulationParams params;
 int tempo_passato = 0;
 int simulazione_in_corso = 1;
-int queue;
+int code[N_CODE];
+int coda_ospiti = -1;
 int num_scissioni = 0;
-int num_scissioni_ultimo_secondo = 0;
 int num_scorie = 0;
-int num_scorie_ultimo_secondo = 0;
+int num_scorie_senza_processo = 0;
 int num_attivazioni = 0;
-int num_attivazioni_ultimo_secondo = 0;
 int causa_terminazione = 0;
+int energia_ultimo_secondo = 0;
+statistiche_record statistiche_eventi;
+gestore_evento gestori_eventi[N_TIPI_RECORD] = {NULL, gestisci_nascita, gestisci_scissione, gestisci_scoria,
+                                                gestisci_attivazione, gestisci_terminazione};
 int inibitore_attivo = 1;
 pid_t pid_inibitore;
+// Processi di controllo seguiti dagli ospiti: raccolti senza essere contati tra gli atomi
+pid_t processi_controllo[N_PROCESSI_CONTROLLO + N_OSPITI_MAX];
+int n_processi_esclusi = N_PROCESSI_CONTROLLO;
+int raccolta_richiesta = 0;
+volatile sig_atomic_t checkpoint_richiesto = 0;
+char percorso_checkpoint[256];
+registro_eventi registro;
+int riproduzione = 0;
+shmseg *memoria;
 shmseg2 *memoria2;
-int sem_sezione_critica_inib;
-int sem_blocca_master;
-int sem_blocca_inib;
 int avvia_inibitore;
 int sem_scissione;
+cgroup_reattore cgroup;
+int cgroup_attivo = 0;
+arena_lignaggi *arena = NULL;
+esposizione_metriche metriche;
+int metriche_attive = 0;
+struct timespec scadenza_tick;
+long long ritardo_tick_us = 0;
+long long ritardo_tick_massimo_us = 0;
+long long ritardo_tick_totale_us = 0;
+istogramma_latenza latenze_contabilita_totali;
+long long fuori_secondo_totali = 0;
+// Il ciclo eventi scrive il secchio dell'epoca aperta; il thread del tick apre la successiva e
+// legge il secchio chiuso dopo che il ciclo eventi ha confermato il passaggio
+secchio_tick secchi[N_SECCHI];
+secchio_tick *secchio_corrente = &secchi[0];
+unsigned epoca_aperta = 0;
+unsigned epoca_ingestione = 0;
+int ingestione_attiva = 1;
+int stampa_attiva = 1;
+anello_spsc anello_stampa;
+pthread_t id_thread_tick;
+pthread_t id_thread_stampa;
 
 int main(int argc, char *argv[])
 {
-    ignore(SIGCHLD);
-    
+    // Gli atomi rimasti orfani vengono riassegnati al master, che può così raccoglierli all'arresto
+    prctl(PR_SET_CHILD_SUBREAPER, 1);
 
     set_handler(inibitore_handler, SIGINT);
 
+    // Con --restore <file> la simulazione riparte dallo stato salvato in un checkpoint,
+    // con --replay <file> il master riproduce un registro di eventi senza avviare processi
+    const char *ripristino = NULL;
+    if (argc == 3 && strcmp(argv[1], "--restore") == 0)
+    {
+        ripristino = argv[2];
+    }
+    else if (argc == 3 && strcmp(argv[1], "--replay") == 0)
+    {
+        riproduci_registro(argv[2]);
+    }
+    else if (argc != 1)
+    {
+        fprintf(stderr, "Uso: %s [--restore <checkpoint> | --replay <registro>]\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
     // Input da tastiera per scegliere se avviare il processo inibitore
     do
     {
@@ -55,81 +103,211 @@ int main(int argc, char *argv[])
         }
     } while (avvia_inibitore != 0 && avvia_inibitore != 1);
 
-    const char *filename = "conf/config.txt";
+    // Il costo di avvio esclude le attese volute (sleep e conto alla rovescia)
+    struct timespec inizio_fase;
+    clock_gettime(CLOCK_MONOTONIC, &inizio_fase);
+
+    const char *filename = percorso_configurazione();
     params = read_params_from_file(filename);
+    applica_profilo(&params, COMPONENTE_MASTER);
+
+    int istanza = istanza_corrente();
+    dprintf(1, "Istanza del reattore: %d\n", istanza);
+    crea_code(istanza);
+    int start_sem = create_sem("src/alimentazione.c", istanza);
+    int attivatore_sem = create_sem("src/attivatore.c", istanza);
+    sem_scissione = create_sem("lib/conf.c", istanza);
 
-    set_handler(alarm_handler, SIGALRM);
-    queue = create_queue("src/master.c");
-    int sem = create_sem("src/master.c");
-    int start_sem = create_sem("src/alimentazione.c");
-    int attivatore_sem = create_sem("src/attivatore.c");
-    sem_sezione_critica_inib = create_sem("lib/semaphore.c");
-    sem_blocca_master = create_sem("lib/semaphore.h");
-    sem_blocca_inib = create_sem("lib/code.c");
-    sem_scissione = create_sem("lib/conf.c");
-
-    increase_sem(sem);
     increase_sem(start_sem);
-    increase_sem(sem_sezione_critica_inib);
     increase_sem(sem_scissione);
 
-    int m1 = create_shared_memory("src/master.c", sizeof(shmseg));
+    int m1 = create_shared_memory("src/master.c", istanza, sizeof(shmseg));
+
+    int m2 = create_shared_memory("src/inibitore.c", istanza, sizeof(shmseg2));
 
-    int m2 = create_shared_memory("src/inibitore.c", sizeof(shmseg2));
+    int id_arena;
+    arena = crea_arena(istanza, params.arena_lignaggi, &id_arena);
 
-    shmseg *memoria = attach_shared_memory(m1);
+    memoria = attach_shared_memory(m1);
     memoria2 = attach_shared_memory2(m2);
+    memset(memoria2, 0, sizeof(shmseg2));
+    unsigned long long seme = inizializza_casuale(memoria2, params.seme);
 
-    memoria->id_queue = queue;
-    memoria->id_semaphore = sem;
+    // Il checkpoint viene scritto dal tick successivo alla richiesta (SIGUSR1) o al secondo CHECKPOINT_TEMPO
+    const char *percorso = getenv(VARIABILE_CHECKPOINT);
+    if (percorso != NULL && percorso[0] != '\0')
+    {
+        snprintf(percorso_checkpoint, sizeof(percorso_checkpoint), "%s", percorso);
+    }
+    else
+    {
+        snprintf(percorso_checkpoint, sizeof(percorso_checkpoint), "build/checkpoint_%d.bin", istanza);
+    }
+    set_handler(checkpoint_handler, SIGUSR1);
+
+    int *popolazione_ripristinata = NULL;
+    if (ripristino != NULL)
+    {
+        contatori_master contatori;
+        popolazione_ripristinata = malloc(sizeof(int) * N_ATOMICO_MAX);
+        if (popolazione_ripristinata == NULL || leggi_checkpoint(ripristino, &contatori, memoria2, popolazione_ripristinata) == -1)
+        {
+            rimuovi_code();
+            remove_sem(attivatore_sem);
+            remove_sem(start_sem);
+            remove_sem(sem_scissione);
+            remove_shared_memory(m1);
+            remove_shared_memory(m2);
+            remove_shared_memory(id_arena);
+            exit(EXIT_FAILURE);
+        }
+        tempo_passato = contatori.tempo_passato;
+        num_scissioni = contatori.num_scissioni;
+        num_scorie = contatori.num_scorie;
+        num_attivazioni = contatori.num_attivazioni;
+        // Gli atomi ricreati vengono contati da new_atomo; i valori dell'ultimo secondo e del controllo ripartono da zero
+        memoria2->atomi_attivi = 0;
+        memoria2->energia_totale_ultimo_secondo = 0;
+        memoria2->energia_assorbita_ultimo_sec = 0;
+        memoria2->sequenza_energia = 0;
+        memset(&memoria2->previsione, 0, sizeof(memoria2->previsione));
+        memoria2->permessi_concessi_ultimo_sec = 0;
+        memoria2->ammissione_attiva = 0;
+        memoria2->ammissione_chiusa = 0;
+        memoria2->generazione.fallimenti_consecutivi = 0;
+        memoria2->generazione.quota_alimentazione = 0;
+        // Gli atomi ricreati vengono riassegnati agli ospiti di questa esecuzione
+        memset(memoria2->atomi_ospitati, 0, sizeof memoria2->atomi_ospitati);
+        dprintf(1, "Ripristino da %s: secondo %d, seme %llu, %llu estrazioni\n",
+                ripristino, tempo_passato, memoria2->seme, memoria2->estrazioni);
+    }
+    else
+    {
+        dprintf(1, "Seme del generatore: %llu\n", seme);
+    }
+
+    memcpy(memoria->id_code, code, sizeof(code));
+    memoria->id_arena_lignaggi = id_arena;
+    memoria->id_coda_ospiti = coda_ospiti;
+    memoria->n_ospiti = params.n_ospiti;
+    memoria->stato_reattore = REATTORE_IN_CORSO;
+    memoria->pgid_reattore = 0;
     memoria->id_attivatore_sem = attivatore_sem;
     memoria->id_start = start_sem;
-    memoria->sem_sezione_critica_inib = sem_sezione_critica_inib;
-    memoria->sem_blocca_master = sem_blocca_master;
-    memoria->sem_blocca_inib = sem_blocca_inib;
     memoria->sem_scissione = sem_scissione;
 
+    // Il master entra nel proprio cgroup prima di generare processi, così tutti i discendenti lo ereditano
+    const char *padre_cgroup = getenv(VARIABILE_CGROUP);
+    if (padre_cgroup != NULL && padre_cgroup[0] != '\0')
+    {
+        const char *pids_max = getenv(VARIABILE_PIDS_MAX);
+        cgroup_attivo = entra_cgroup(&cgroup, padre_cgroup, istanza, pids_max != NULL ? atol(pids_max) : -1) == 0;
+    }
+
+    // Il thread di esposizione nasce prima dei processi: il socket è chiuso nei figli (SOCK_CLOEXEC)
+    const char *indirizzo_metriche = getenv(VARIABILE_METRICHE);
+    if (indirizzo_metriche != NULL && indirizzo_metriche[0] != '\0')
+    {
+        metriche_attive = avvia_esposizione(&metriche, indirizzo_metriche) == 0;
+        pubblica_stato_metriche();
+    }
 
+    long long costo_avvio_ns = nanosecondi_da(&inizio_fase);
     sleep(1);
+    clock_gettime(CLOCK_MONOTONIC, &inizio_fase);
 
-    pid_t pid_attivatore = start("bin/attivatore");
-    pid_t pid_alimentazione = start("bin/alimentazione");
+    // L'attivatore fonda il gruppo di processi del reattore, gli altri processi vi entrano
+    processi_controllo[0] = start("bin/attivatore");
+    memoria->pgid_reattore = processi_controllo[0];
+    processi_controllo[1] = start("bin/alimentazione");
 
     if (avvia_inibitore)
     {
         pid_inibitore = start("bin/inibitore");
+        processi_controllo[2] = pid_inibitore;
         dprintf(1, "Processo inibitore avviato.\n");
     }
     else
     {
         dprintf(1, "Processo inibitore non avviato.\n");
     }
+    avvia_ospiti();
 
-    for (int i = 0; i < params.n_atomi_init; i++)
+    if (popolazione_ripristinata != NULL)
+    {
+        struct timespec inizio_ripristino;
+        clock_gettime(CLOCK_MONOTONIC, &inizio_ripristino);
+        int ricreati = 0;
+        for (int n = 1; n < N_ATOMICO_MAX; n++)
+        {
+            for (int i = 0; i < popolazione_ripristinata[n]; i++)
+            {
+                ricreati += new_atomo(n) != -1;
+            }
+        }
+        free(popolazione_ripristinata);
+        dprintf(1, "RIPRISTINO: %d atomi ricreati in %ld ms\n", ricreati, millisecondi_da(&inizio_ripristino));
+    }
+    else
     {
-        new_atomo(params.n_atom_max);
+        for (int i = 0; i < params.n_atomi_init; i++)
+        {
+            new_atomo(params.n_atom_max);
+        }
     }
+    costo_avvio_ns += nanosecondi_da(&inizio_fase);
 
     for (int i = 3; i > 0; i--)
     {
         sleep(1);
         dprintf(1, "AVVIO SIMULAZIONE IN %d\n", i);
     }
-    decrease_sem(sem);
-
     decrease_sem(start_sem);
 
-    alarm(1); // Inizia il timer impostando un allarme ogni secondo.
+    const char *percorso_registro = getenv(VARIABILE_REGISTRO);
+    if (percorso_registro != NULL && percorso_registro[0] != '\0')
+    {
+        stato_iniziale iniziale;
+        iniziale.tempo_passato = tempo_passato;
+        iniziale.energia_totale = memoria2->energia_totale;
+        iniziale.energia_prelevata = memoria2->energia_prelevata;
+        iniziale.energia_assorbita = memoria2->energia_assorbita;
+        iniziale.atomi_attivi = memoria2->atomi_attivi;
+        iniziale.num_scissioni = num_scissioni;
+        iniziale.num_scorie = num_scorie;
+        iniziale.num_attivazioni = num_attivazioni;
+        iniziale.inibitore_avviato = avvia_inibitore;
+        iniziale.inibitore_attivo = inibitore_attivo;
+        apri_registro(&registro, percorso_registro, &iniziale);
+    }
+
+    // Un thread esegue il tick a ogni secondo e un altro ne stampa lo stato, fuori dal ciclo eventi
+    clock_gettime(CLOCK_MONOTONIC, &scadenza_tick);
+    secchio_corrente->inizio_ns = scadenza_tick.tv_sec * 1000000000LL + scadenza_tick.tv_nsec;
+    avvia_thread_master();
 
-    while (simulazione_in_corso && causa_terminazione == 0)
+    long long iterazioni_ciclo = 0;
+    long long record_letti = 0;
+    clock_gettime(CLOCK_MONOTONIC, &inizio_fase);
+
+    while (__atomic_load_n(&simulazione_in_corso, __ATOMIC_ACQUIRE) &&
+           __atomic_load_n(&causa_terminazione, __ATOMIC_RELAXED) == 0)
     {
-        memoria2->energia_totale_ultimo_secondo += read_type_message_nb(queue, 5);
-        num_scissioni_ultimo_secondo += read_type_message_nb(queue, 9);
-        num_scorie_ultimo_secondo += read_type_message_nb(queue, 10);
-        num_attivazioni_ultimo_secondo += read_type_message_nb(queue, 12);
-        causa_terminazione = read_type_message_nb(queue, 15);
+        iterazioni_ciclo++;
+        segui_epoca();
+        record_letti += consuma_code();
+
+        if (__atomic_exchange_n(&raccolta_richiesta, 0, __ATOMIC_RELAXED))
+        {
+            // Un tick arrivato durante la lettura delle code viene confermato prima della raccolta
+            segui_epoca();
+            raccogli_figli(&memoria2->statistiche, processi_controllo, n_processi_esclusi);
+        }
     }
 
+    long long durata_ciclo_ns = nanosecondi_da(&inizio_fase);
+    termina_thread_master();
+
     switch (causa_terminazione)
     {
     case 0:
@@ -147,127 +325,842 @@ int main(int argc, char *argv[])
         break;
     }
 
-    increase_sem(sem);
+    // I processi di controllo vanno letti prima dell'arresto, finché esistono
+    uso_scheduler uso_finale[N_COMPONENTI];
+    leggi_uso_componenti(uso_finale);
 
-    while (memoria2->atomi_attivi)
+    // ARRESTO: la parola di stato ferma le attese bloccanti, SIGTERM raggiunge tutto il gruppo
+    struct timespec inizio_arresto;
+    clock_gettime(CLOCK_MONOTONIC, &inizio_arresto);
+    int forzato;
+
+    arresta_reattore(memoria);
+    int raccolti = arresto_processi(memoria->pgid_reattore, params.teardown_grazia_ms,
+                                   params.teardown_deadline_ms, &forzato,
+                                   &memoria2->statistiche, processi_controllo, n_processi_esclusi);
+    statistiche_atomi statistiche = memoria2->statistiche;
+    if (metriche_attive)
     {
-        memoria2->atomi_attivi += read_type_message_nb(queue, 4); // Aspetta fino a quando ci sono atomi attivi.
+        termina_esposizione(&metriche);
     }
 
-    increase_sem(sem_blocca_inib);
-
-    waitpid(pid_alimentazione, NULL, 0);
-    waitpid(pid_inibitore, NULL, 0);
-
-    sleep(1);
-
-    remove_queue(queue);
-    remove_sem(sem);
+    // Tutti gli atomi sono stati raccolti: l'arena non cambia più
+    stampa_lignaggi();
+    stampa_bloccati_code();
+    rimuovi_code();
     remove_sem(attivatore_sem);
     remove_sem(start_sem);
-    remove_sem(sem_sezione_critica_inib);
-    remove_sem(sem_blocca_inib);
-    remove_sem(sem_blocca_master);
     remove_sem(sem_scissione); 
     remove_shared_memory(m1);
     remove_shared_memory(m2);
+    remove_shared_memory(id_arena);
+    if (cgroup_attivo)
+    {
+        campione_cgroup finale;
+        campiona_cgroup(&cgroup, &finale);
+        dprintf(1, "Cgroup: CPU totale %lld ms, fork rifiutate per pids.max %lld\n",
+                finale.cpu_us / 1000, finale.processi_rifiutati);
+        esci_cgroup(&cgroup);
+    }
+
+    long durata_arresto_ms = millisecondi_da(&inizio_arresto);
+    dprintf(1, "Arresto completato in %ld ms (scadenza %ld ms): %d processi raccolti%s\n",
+            durata_arresto_ms, params.teardown_deadline_ms, raccolti,
+            forzato ? ", terminazione forzata" : "");
+    stampa_statistiche_atomi(&statistiche);
+    stampa_latenza_scheduling(uso_finale, &statistiche);
+    if (!riproduzione)
+    {
+        stampa_latenza_contabilita_totale();
+    }
+
+    if (registro.intestazione != NULL)
+    {
+        dprintf(1, "Registro eventi: %llu eventi (%llu persi) in %s\n",
+                (unsigned long long)registro.intestazione->n_eventi,
+                (unsigned long long)registro.intestazione->eventi_persi, percorso_registro);
+        chiudi_registro(&registro);
+    }
+
+    // Il segmento è già marcato per la rimozione ma resta collegato fino all'uscita
+    const char *percorso_report = getenv(VARIABILE_REPORT);
+    if (percorso_report != NULL)
+    {
+        report_simulazione report;
+        report.istanza = istanza;
+        report.causa_terminazione = causa_terminazione;
+        report.tempo_passato = tempo_passato;
+        report.energia_totale = memoria2->energia_totale;
+        report.energia_prelevata = memoria2->energia_prelevata;
+        report.energia_assorbita = memoria2->energia_assorbita;
+        report.scissioni = num_scissioni;
+        report.scorie = num_scorie;
+        report.attivazioni = num_attivazioni;
+        report.atomi_raccolti = statistiche.raccolti;
+        report.fork_evitate = memoria2->generazione.risparmiati;
+        report.tempo_cpu_ms = tempo_cpu_reattore_ms();
+        report.durata_arresto_ms = durata_arresto_ms;
+        scrivi_report(percorso_report, &report);
+    }
+
+    stampa_statistiche_record();
+    // Ogni iterazione legge i record presenti, fino a RECORD_PER_ITERAZIONE, più una lettura a vuoto
+    dprintf(1, "\nPRESTAZIONI: avvio %lld us, ciclo eventi %lld iterazioni e %lld record, %lld ns per lettura\n",
+            costo_avvio_ns / 1000, iterazioni_ciclo, record_letti,
+            iterazioni_ciclo > 0 ? durata_ciclo_ns / (iterazioni_ciclo + record_letti) : 0);
     printf("FINE SIMULAZIONE\n");
 
     exit(EXIT_SUCCESS);
 }
 
-void alarm_handler(int signum)
+void avvia_thread_master()
+{
+    if (crea_anello(&anello_stampa, CAPACITA_STAMPA, sizeof(istantanea_tick)) == -1)
+    {
+        invia_terminazione(3);
+        exit(EXIT_FAILURE);
+    }
+
+    // I thread ereditano la maschera: i segnali arrivano solo al ciclo eventi
+    sigset_t tutti, precedenti;
+    sigfillset(&tutti);
+    pthread_sigmask(SIG_BLOCK, &tutti, &precedenti);
+    int errore = pthread_create(&id_thread_stampa, NULL, thread_stampa, NULL);
+    if (errore == 0)
+    {
+        errore = pthread_create(&id_thread_tick, NULL, thread_tick, NULL);
+    }
+    pthread_sigmask(SIG_SETMASK, &precedenti, NULL);
+    if (errore != 0)
+    {
+        fprintf(stderr, "pthread_create error: %s\n", strerror(errore));
+        invia_terminazione(3);
+        exit(EXIT_FAILURE);
+    }
+}
+
+void termina_thread_master()
+{
+    __atomic_store_n(&ingestione_attiva, 0, __ATOMIC_RELEASE);
+    pthread_join(id_thread_tick, NULL);
+    __atomic_store_n(&stampa_attiva, 0, __ATOMIC_RELEASE);
+    pthread_join(id_thread_stampa, NULL);
+    if (anello_stampa.persi > 0)
+    {
+        dprintf(1, "Stampe dei tick perse (thread di stampa in ritardo): %llu\n", anello_stampa.persi);
+    }
+    distruggi_anello(&anello_stampa);
+}
+
+void *thread_tick(void *argomento)
+{
+    int continua = 1;
+    while (continua)
+    {
+        scadenza_tick.tv_sec++;
+        if (attendi_scadenza(&scadenza_tick) == -1)
+        {
+            break;
+        }
+        continua = esegui_tick();
+    }
+    return NULL;
+}
+
+int attendi_scadenza(const struct timespec *scadenza)
+{
+    while (__atomic_load_n(&ingestione_attiva, __ATOMIC_ACQUIRE))
+    {
+        struct timespec passo;
+        clock_gettime(CLOCK_MONOTONIC, &passo);
+        if (passo.tv_sec > scadenza->tv_sec || (passo.tv_sec == scadenza->tv_sec && passo.tv_nsec >= scadenza->tv_nsec))
+        {
+            return 0;
+        }
+        passo.tv_nsec += ATTESA_TICK_MS * 1000000L;
+        if (passo.tv_nsec >= 1000000000L)
+        {
+            passo.tv_sec++;
+            passo.tv_nsec -= 1000000000L;
+        }
+        if (passo.tv_sec > scadenza->tv_sec || (passo.tv_sec == scadenza->tv_sec && passo.tv_nsec > scadenza->tv_nsec))
+        {
+            passo = *scadenza;
+        }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &passo, NULL);
+    }
+    return -1;
+}
+
+void registra_ritardo_tick(const struct timespec *istante)
+{
+    // Dopo un ritardo di oltre un secondo le scadenze ripartono dall'istante invece di
+    // recuperare i secondi persi
+    long long ritardo_us = (istante->tv_sec - scadenza_tick.tv_sec) * 1000000LL + (istante->tv_nsec - scadenza_tick.tv_nsec) / 1000;
+    ritardo_tick_us = ritardo_us > 0 ? ritardo_us : 0;
+    if (ritardo_tick_us > 1000000)
+    {
+        scadenza_tick = *istante;
+    }
+    ritardo_tick_totale_us += ritardo_tick_us;
+    if (ritardo_tick_us > ritardo_tick_massimo_us)
+    {
+        ritardo_tick_massimo_us = ritardo_tick_us;
+    }
+    // Letti da bin/loadgen per misurare il carico sostenibile
+    __atomic_store_n(&memoria2->ritardo_tick_us, ritardo_tick_us, __ATOMIC_RELAXED);
+    __atomic_store_n(&memoria2->tick, tempo_passato, __ATOMIC_RELAXED);
+}
+
+int esegui_tick()
 {
     tempo_passato++;
 
-    if (tempo_passato < params.sim_duration && causa_terminazione == 0)
+    struct timespec adesso;
+    clock_gettime(CLOCK_MONOTONIC, &adesso);
+    if (tempo_passato >= params.sim_duration || __atomic_load_n(&causa_terminazione, __ATOMIC_RELAXED) != 0)
+    {
+        registra_ritardo_tick(&adesso);
+        // Anche l'ultimo tick passa dal ciclo eventi, che lo scrive nel registro
+        chiudi_secchio(&adesso);
+        __atomic_store_n(&simulazione_in_corso, 0, __ATOMIC_RELEASE);
+        return 0;
+    }
+
+    // L'inibitore esegue il proprio ciclo di controllo: il tick non lo attende
+    secchio_tick *secchio = chiudi_secchio(&adesso);
+    // La raccolta dei figli è chiesta solo dopo la conferma: non può ritardarla
+    __atomic_store_n(&raccolta_richiesta, 1, __ATOMIC_RELAXED);
+
+    // Il ritardo del tick va dalla scadenza alla conferma del secchio chiuso, che delimita
+    // davvero il secondo
+    struct timespec chiuso;
+    clock_gettime(CLOCK_MONOTONIC, &chiuso);
+    registra_ritardo_tick(&chiuso);
+    aggiorna_simulazione(secchio);
+
+    istantanea_tick istantanea;
+    fotografa_tick(secchio, &istantanea);
+    memset(secchio, 0, sizeof(*secchio));
+    inserisci_anello(&anello_stampa, &istantanea);
+
+    if (metriche_attive)
+    {
+        pubblica_stato_metriche();
+    }
+    if (__atomic_exchange_n(&checkpoint_richiesto, 0, __ATOMIC_RELAXED) || tempo_passato == params.checkpoint_tempo)
     {
-        decrease_sem(sem_sezione_critica_inib);
-        aggiorna_simulazione();
-        increase_sem(sem_sezione_critica_inib);
+        salva_checkpoint();
+    }
 
+    if (memoria2->energia_totale > params.energy_explode_threshold)
+    {
+        invia_terminazione(1);
+        return 0;
+    }
+    if (memoria2->energia_totale < params.energy_demand)
+    {
+        invia_terminazione(2);
+        return 0;
+    }
+    return 1;
+}
 
-        if(avvia_inibitore) {
-            increase_sem(sem_blocca_inib);
-            //qua in mezzo agisce l'inibitore
-            decrease_sem(sem_blocca_master);
+void *thread_stampa(void *argomento)
+{
+    istantanea_tick istantanea;
+    for (;;)
+    {
+        // La richiesta di arresto va letta prima di svuotare la coda: le ultime istantanee vengono stampate
+        int attiva = __atomic_load_n(&stampa_attiva, __ATOMIC_ACQUIRE);
+        while (estrai_anello(&anello_stampa, &istantanea))
+        {
+            stampa_stato(&istantanea);
+        }
+        if (!attiva)
+        {
+            return NULL;
         }
+        usleep(ATTESA_STAMPA_MS * 1000);
+    }
+}
+
+void segui_epoca()
+{
+    unsigned epoca = __atomic_load_n(&epoca_aperta, __ATOMIC_ACQUIRE);
+    if (epoca == epoca_ingestione)
+    {
+        return;
+    }
+    // Il ciclo eventi è l'unico a scrivere gli eventi dei secchi: il tick entra nel registro dopo
+    // l'ultimo record del secondo chiuso e prima del primo del successivo, come lo conta la riproduzione
+    if (secchio_corrente->delta_atomi != 0)
+    {
+        registra_evento(&registro, EVENTO_ATOMI, secchio_corrente->delta_atomi);
+    }
+    registra_evento(&registro, EVENTO_TICK, tempo_passato);
+    secchio_corrente = &secchi[epoca % N_SECCHI];
+    __atomic_store_n(&epoca_ingestione, epoca, __ATOMIC_RELEASE);
+}
 
-        decrease_sem(sem_sezione_critica_inib);
-        stato_simulazione();
+secchio_tick *chiudi_secchio(const struct timespec *adesso)
+{
+    unsigned epoca = epoca_aperta;
+    secchio_tick *chiuso = &secchi[epoca % N_SECCHI];
+    // Il secchio che si apre è stato azzerato al tick precedente
+    secchi[(epoca + 1) % N_SECCHI].inizio_ns = adesso->tv_sec * 1000000000LL + adesso->tv_nsec;
+    __atomic_store_n(&epoca_aperta, epoca + 1, __ATOMIC_RELEASE);
+
+    // La conferma arriva all'inizio dell'iterazione successiva del ciclo eventi, dopo gli ultimi
+    // record applicati al secchio chiuso
+    while (__atomic_load_n(&epoca_ingestione, __ATOMIC_ACQUIRE) != epoca + 1 &&
+           __atomic_load_n(&ingestione_attiva, __ATOMIC_ACQUIRE))
+    {
+        sched_yield();
+    }
+    return chiuso;
+}
+
+void gestisci_nascita(const record_evento *record)
+{
+    secchio_corrente->delta_atomi += record->delta_atomi;
+}
 
-        if (memoria2->energia_totale > params.energy_explode_threshold)
+void gestisci_scissione(const record_evento *record)
+{
+    secchio_corrente->delta_atomi += record->delta_atomi;
+    secchio_corrente->scissioni++;
+    secchio_corrente->energia += record->energia;
+    // Il contatore condiviso segue l'energia prodotta mentre si accumula, per energia_corrente()
+    __atomic_fetch_add(&memoria2->energia_totale_ultimo_secondo, record->energia, __ATOMIC_RELAXED);
+    if (!riproduzione)
+    {
+        // Dal timestamp del produttore all'energia contata: una scissione prodotta prima
+        // dell'apertura del secchio finisce nel secondo successivo a quello in cui è avvenuta
+        struct timespec adesso;
+        clock_gettime(CLOCK_MONOTONIC, &adesso);
+        long long adesso_ns = adesso.tv_sec * 1000000000LL + adesso.tv_nsec;
+        registra_latenza(&secchio_corrente->latenze, adesso_ns - record->tempo_ns);
+        if (record->tempo_ns < secchio_corrente->inizio_ns)
         {
-            send_type_message(queue, 1, 15);
+            secchio_corrente->fuori_secondo++;
         }
-        else if (memoria2->energia_totale < params.energy_demand)
+    }
+    conta_produzione(memoria2, 1, record->energia);
+    // Il registro conserva un evento per fatto, come i messaggi che il record sostituisce
+    registra_evento(&registro, EVENTO_SCISSIONE, 1);
+    if (record->energia != 0)
+    {
+        registra_evento(&registro, EVENTO_ENERGIA, record->energia);
+    }
+    // Il figlio sotto MIN_N_ATOMICO non ha avuto un processo: è una scoria, come gli atomi
+    // dell'alimentazione e del master contati senza fork
+    if (record->valore == SCORIA_SENZA_PROCESSO)
+    {
+        secchio_corrente->scorie++;
+        secchio_corrente->scorie_senza_processo++;
+        registra_evento(&registro, EVENTO_SCORIA, 1);
+    }
+}
+
+void gestisci_scoria(const record_evento *record)
+{
+    secchio_corrente->delta_atomi += record->delta_atomi;
+    secchio_corrente->scorie++;
+    if (record->valore == SCORIA_SENZA_PROCESSO)
+    {
+        secchio_corrente->scorie_senza_processo++;
+    }
+    registra_evento(&registro, EVENTO_SCORIA, 1);
+}
+
+void gestisci_attivazione(const record_evento *record)
+{
+    secchio_corrente->attivazioni += record->valore;
+    registra_evento(&registro, EVENTO_ATTIVAZIONE, record->valore);
+}
+
+void gestisci_terminazione(const record_evento *record)
+{
+    secchio_corrente->delta_atomi += record->delta_atomi;
+    // Letta anche dal thread del tick
+    __atomic_store_n(&causa_terminazione, record->valore, __ATOMIC_RELAXED);
+    registra_evento(&registro, EVENTO_TERMINAZIONE, record->valore);
+}
+
+void crea_code(int istanza)
+{
+    // La coda di controllo ha la chiave dell'istanza e ne garantisce l'esclusività, le altre sono private
+    code[CODA_CONTROLLO] = create_queue("src/master.c", istanza);
+    for (int i = 1; i < N_CODE; i++)
+    {
+        code[i] = create_private_queue();
+    }
+    unsigned long capacita = 0;
+    for (int i = 0; i < N_CODE; i++)
+    {
+        capacita = imposta_capacita_coda(code[i], params.byte_coda);
+    }
+    dprintf(1, "Code di messaggi: %d (controllo e %d per gli atomi), %lu byte ciascuna (richiesti %d)\n",
+            N_CODE, N_CODE_ATOMI, capacita, params.byte_coda);
+
+    if (params.n_ospiti > 0)
+    {
+        coda_ospiti = create_private_queue();
+        imposta_capacita_coda(coda_ospiti, params.byte_coda);
+    }
+}
+
+void rimuovi_code()
+{
+    for (int i = 0; i < N_CODE; i++)
+    {
+        remove_queue(code[i]);
+    }
+    if (coda_ospiti != -1)
+    {
+        remove_queue(coda_ospiti);
+    }
+}
+
+int consuma_code()
+{
+    // La coda di controllo per prima: una terminazione non attende dietro ai record degli atomi
+    int letti = 0;
+    for (int i = 0; i < N_CODE; i++)
+    {
+        letti += consuma_record(code[i], gestori_eventi, RECORD_PER_ITERAZIONE, &statistiche_eventi);
+    }
+    return letti;
+}
+
+void stampa_code(const istantanea_tick *istantanea)
+{
+    unsigned long messaggi = 0, byte = 0, massimo = 0, capacita = 0;
+    dprintf(1, "Code (messaggi/byte):");
+    for (int i = 0; i < N_CODE; i++)
+    {
+        if (!istantanea->code_lette[i])
         {
-            send_type_message(queue, 2, 15);
+            continue;
         }
-        else
+        const stato_coda *stato = &istantanea->code[i];
+        dprintf(1, " %s %lu/%lu", i == CODA_CONTROLLO ? "controllo" : "atomi", stato->messaggi, stato->byte);
+        messaggi += stato->messaggi;
+        byte += stato->byte;
+        capacita = stato->capacita;
+        if (stato->byte > massimo)
         {
-            alarm(1); // Imposta il prossimo allarme se la simulazione non è finita.
+            massimo = stato->byte;
         }
-        increase_sem(sem_sezione_critica_inib);
     }
-    else
+    dprintf(1, "; totale %lu messaggi, coda più piena al %lu%% di %lu byte, invii su coda piena nell'ultimo secondo: %lld\n",
+            messaggi, capacita > 0 ? massimo * 100 / capacita : 0, capacita, istantanea->invii_bloccati_ultimo_secondo);
+}
+
+void stampa_bloccati_code()
+{
+    long long inviati = 0, bloccati = 0;
+    for (int i = 0; i < N_CODE; i++)
+    {
+        inviati += memoria2->code.inviati[i];
+        bloccati += memoria2->code.bloccati[i];
+    }
+    dprintf(1, "Invii sulle code: %lld, %lld con la coda piena (controllo %lld su %lld)\n",
+            inviati, bloccati, memoria2->code.bloccati[CODA_CONTROLLO], memoria2->code.inviati[CODA_CONTROLLO]);
+}
+
+void invia_terminazione(int causa)
+{
+    record_evento record = nuovo_record(RECORD_TERMINAZIONE);
+    record.valore = causa;
+    pubblica_record(memoria, memoria2, &record);
+}
+
+void stampa_statistiche_record()
+{
+    long long ricevuti = 0;
+    for (int tipo = 1; tipo < N_TIPI_RECORD; tipo++)
+    {
+        ricevuti += statistiche_eventi.ricevuti[tipo];
+    }
+    long long scissioni = statistiche_eventi.ricevuti[RECORD_SCISSIONE];
+
+    dprintf(1, "\nMESSAGGI: %lld record da %zu byte (versione %d)", ricevuti, sizeof(record_evento) - sizeof(long),
+            RECORD_VERSIONE);
+    for (int tipo = 1; tipo < N_TIPI_RECORD; tipo++)
+    {
+        dprintf(1, ", %s %lld", nome_record(tipo), statistiche_eventi.ricevuti[tipo]);
+    }
+    dprintf(1, "\n");
+    if (statistiche_eventi.scartati > 0)
+    {
+        dprintf(1, "Record scartati (versione o tipo sconosciuti): %lld\n", statistiche_eventi.scartati);
+    }
+    if (scissioni > 0)
+    {
+        dprintf(1, "Messaggi per scissione: %.2f, con un intero per messaggio %.2f (%lld messaggi)\n",
+                (double)ricevuti / scissioni, (double)statistiche_eventi.messaggi_equivalenti / scissioni,
+                statistiche_eventi.messaggi_equivalenti);
+    }
+}
+
+int tick_riproduzione(const secchio_tick *secchio)
+{
+    tempo_passato++;
+    if (tempo_passato >= params.sim_duration)
     {
         simulazione_in_corso = 0;
+        return 0;
+    }
+
+    aggiorna_simulazione(secchio);
+    // Senza processi l'inibitore esegue un passo per tick, applicato subito, con la regola fissa:
+    // la previsione è calibrata sugli intervalli del ciclo di controllo, non su quelli di un secondo
+    if (avvia_inibitore && inibitore_attivo)
+    {
+        passo_inibitore(&params, memoria2, 0);
+        inizia_aggiornamento_energia(memoria2);
+        applica_assorbimento(memoria2);
+        termina_aggiornamento_energia(memoria2);
+    }
+    istantanea_tick istantanea;
+    fotografa_tick(secchio, &istantanea);
+    stampa_stato(&istantanea);
+
+    if (memoria2->energia_totale > params.energy_explode_threshold)
+    {
+        return 1;
+    }
+    if (memoria2->energia_totale < params.energy_demand)
+    {
+        return 2;
     }
+    return 0;
 }
 
-int start(char *pathname)
+void riproduci_registro(const char *percorso)
 {
-    pid_t pid = fork();
-    switch (pid)
+    params = read_params_from_file(percorso_configurazione());
+
+    registro_eventi letto;
+    if (leggi_registro(&letto, percorso) == -1)
     {
-    case -1:
-        perror("Error starting the process");
-        send_type_message(queue, -1, 4);
-        send_type_message(queue, 3, 15);
         exit(EXIT_FAILURE);
-        break;
-    case 0:
-        execlp(pathname, pathname, NULL);
-        perror("Exec fallito");
+    }
+    memoria2 = calloc(1, sizeof(shmseg2));
+    if (memoria2 == NULL)
+    {
+        perror("calloc error");
+        exit(EXIT_FAILURE);
+    }
+
+    const stato_iniziale *iniziale = &letto.intestazione->iniziale;
+    riproduzione = 1;
+    tempo_passato = iniziale->tempo_passato;
+    memoria2->energia_totale = iniziale->energia_totale;
+    memoria2->energia_prelevata = iniziale->energia_prelevata;
+    memoria2->energia_assorbita = iniziale->energia_assorbita;
+    memoria2->atomi_attivi = iniziale->atomi_attivi;
+    num_scissioni = iniziale->num_scissioni;
+    num_scorie = iniziale->num_scorie;
+    num_attivazioni = iniziale->num_attivazioni;
+    avvia_inibitore = iniziale->inibitore_avviato;
+    inibitore_attivo = iniziale->inibitore_attivo;
+
+    struct timespec inizio;
+    clock_gettime(CLOCK_MONOTONIC, &inizio);
+
+    uint64_t n_eventi = letto.intestazione->n_eventi;
+    uint64_t i;
+    secchio_tick secchio;
+    memset(&secchio, 0, sizeof(secchio));
+    int tick = 0, causa_registrata = 0;
+    uint32_t durata_registrata_us = 0;
+    for (i = 0; i < n_eventi && simulazione_in_corso && causa_terminazione == 0; i++)
+    {
+        const evento *e = &letto.eventi[i];
+        durata_registrata_us = e->tempo_us;
+        switch (e->tipo)
+        {
+        case EVENTO_ENERGIA:
+            secchio.energia += e->valore;
+            memoria2->energia_totale_ultimo_secondo += e->valore;
+            conta_produzione(memoria2, 0, e->valore);
+            break;
+        case EVENTO_SCISSIONE:
+            secchio.scissioni += e->valore;
+            conta_produzione(memoria2, e->valore, 0);
+            break;
+        case EVENTO_SCORIA:
+            secchio.scorie += e->valore;
+            break;
+        case EVENTO_ATTIVAZIONE:
+            secchio.attivazioni += e->valore;
+            break;
+        case EVENTO_ATOMI:
+            secchio.delta_atomi += e->valore;
+            break;
+        case EVENTO_INIBITORE:
+            inibitore_attivo = e->valore;
+            break;
+        case EVENTO_TERMINAZIONE:
+            // EXPLODE e BLACKOUT vengono ricalcolati dai tick, il MELTDOWN dipende dagli atomi
+            causa_registrata = e->valore;
+            if (e->valore == 3)
+            {
+                causa_terminazione = 3;
+            }
+            break;
+        case EVENTO_TICK:
+            tick++;
+            causa_terminazione = tick_riproduzione(&secchio);
+            memset(&secchio, 0, sizeof(secchio));
+            break;
+        }
+    }
+    long long durata_ns = nanosecondi_da(&inizio);
+
+    dprintf(1, "\nRIPRODUZIONE: %llu eventi su %llu, %d tick in %lld us (%lld ns per evento), "
+               "registrati in %u ms\n",
+            (unsigned long long)i, (unsigned long long)n_eventi, tick, durata_ns / 1000,
+            i > 0 ? durata_ns / (long long)i : 0, durata_registrata_us / 1000);
+    dprintf(1, "Esito riprodotto: %s al secondo %d, esito registrato: %s\n",
+            nome_esito(causa_terminazione), tempo_passato, nome_esito(causa_registrata));
+    dprintf(1, "Energia finale %d, assorbita %d, prelevata %d\n",
+            memoria2->energia_totale, memoria2->energia_assorbita, memoria2->energia_prelevata);
+
+    rilascia_registro(&letto);
+    free(memoria2);
+    exit(EXIT_SUCCESS);
+}
+
+void avvia_ospiti()
+{
+    for (int i = 0; i < params.n_ospiti; i++)
+    {
+        char indice[16];
+        sprintf(indice, "%d", i);
+        pid_t pid = avvia_processo("bin/ospite", indice, memoria->pgid_reattore);
+        if (pid == -1)
+        {
+            invia_terminazione(3);
+            exit(EXIT_FAILURE);
+        }
+        processi_controllo[n_processi_esclusi++] = pid;
+    }
+    if (params.n_ospiti > 0)
+    {
+        dprintf(1, "Atomi eseguiti da %d processi ospite.\n", params.n_ospiti);
+    }
+}
+
+void stampa_ospiti(const istantanea_tick *istantanea)
+{
+    dprintf(1, "Ospiti: %d processi, %d atomi (min %d, max %d per ospite)\n", params.n_ospiti,
+            istantanea->atomi_ospitati, istantanea->atomi_ospitati_minimo, istantanea->atomi_ospitati_massimo);
+}
+
+int start(char *pathname)
+{
+    pid_t pid = avvia_processo(pathname, NULL, memoria->pgid_reattore);
+    if (pid == -1)
+    {
+        invia_terminazione(3);
         exit(EXIT_FAILURE);
-    default:
-        return pid;
     }
+    return pid;
 }
 
-void aggiorna_simulazione()
+void aggiorna_simulazione(const secchio_tick *secchio)
 {
-    num_attivazioni += num_attivazioni_ultimo_secondo;
-    num_scissioni += num_scissioni_ultimo_secondo;
-    num_scorie += num_scorie_ultimo_secondo;
-    memoria2->energia_totale += memoria2->energia_totale_ultimo_secondo;
+    num_attivazioni += secchio->attivazioni;
+    num_scissioni += secchio->scissioni;
+    num_scorie += secchio->scorie;
+    num_scorie_senza_processo += secchio->scorie_senza_processo;
+
+    // L'inibitore legge l'energia senza lock: il passaggio dell'ultimo secondo nel totale e
+    // l'assorbimento pubblicato dall'inibitore avvengono con la sequenza dispari
+    inizia_aggiornamento_energia(memoria2);
+    // L'energia del secondo è quella del secchio chiuso: il contatore condiviso conserva quella
+    // già prodotta nel secondo successivo
+    energia_ultimo_secondo = secchio->energia;
+    __atomic_fetch_sub(&memoria2->energia_totale_ultimo_secondo, energia_ultimo_secondo, __ATOMIC_RELAXED);
+    memoria2->energia_totale += energia_ultimo_secondo;
     memoria2->energia_prelevata += params.energy_demand;
     memoria2->energia_totale -= params.energy_demand;
-    memoria2->energia_assorbita;
-    memoria2->atomi_attivi += somma_messaggi_di_tipo(queue, 4);
+    applica_assorbimento(memoria2);
+    termina_aggiornamento_energia(memoria2);
+    memoria2->atomi_attivi += secchio->delta_atomi;
+}
+
+void fotografa_tick(const secchio_tick *secchio, istantanea_tick *istantanea)
+{
+    istantanea->tempo_passato = tempo_passato;
+    istantanea->atomi_attivi = memoria2->atomi_attivi;
+    istantanea->attivazioni = num_attivazioni;
+    istantanea->attivazioni_ultimo_secondo = secchio->attivazioni;
+    istantanea->energia_totale = memoria2->energia_totale;
+    istantanea->energia_ultimo_secondo = energia_ultimo_secondo;
+    istantanea->energia_prelevata = memoria2->energia_prelevata;
+    istantanea->scissioni = num_scissioni;
+    istantanea->scissioni_ultimo_secondo = secchio->scissioni;
+    istantanea->scorie = num_scorie;
+    istantanea->scorie_ultimo_secondo = secchio->scorie;
+    istantanea->scorie_senza_processo = num_scorie_senza_processo;
+    istantanea->generazione = memoria2->generazione;
+    istantanea->latenza_media_generazione_us = latenza_media_generazione_us(memoria2);
+    istantanea->inibitore_attivo = inibitore_attivo;
+    istantanea->energia_assorbita = memoria2->energia_assorbita;
+    istantanea->obiettivo_atomi = memoria2->obiettivo_atomi;
+    istantanea->permessi_disponibili = riproduzione ? 0 : sem_getvalue(sem_scissione);
+    istantanea->ammissione_chiusa = memoria2->ammissione_chiusa;
+    // Contatori aggiornati anche dal ciclo dell'inibitore: letti e azzerati in un'unica operazione
+    istantanea->permessi_concessi_ultimo_secondo = __atomic_exchange_n(&memoria2->permessi_concessi_ultimo_sec, 0, __ATOMIC_RELAXED);
+    istantanea->energia_assorbita_ultimo_secondo = __atomic_exchange_n(&memoria2->energia_assorbita_ultimo_sec, 0, __ATOMIC_RELAXED);
+
+    istantanea->latenze_campioni = secchio->latenze.campioni;
+    istantanea->latenza_p50_ns = percentile_latenza(&secchio->latenze, 50);
+    istantanea->latenza_p99_ns = percentile_latenza(&secchio->latenze, 99);
+    istantanea->latenza_massima_ns = secchio->latenze.massimo_ns;
+    istantanea->fuori_secondo = secchio->fuori_secondo;
+    somma_latenze(&latenze_contabilita_totali, &secchio->latenze);
+    fuori_secondo_totali += secchio->fuori_secondo;
+
+    if (!riproduzione)
+    {
+        fotografa_diagnostiche(istantanea);
+    }
+}
+
+void fotografa_diagnostiche(istantanea_tick *istantanea)
+{
+    static uso_scheduler uso_precedente[N_COMPONENTI];
+    static long long bloccati_precedenti[N_CODE];
+    static long long cpu_cgroup_precedente_us = 0;
+    static unsigned long long passi_precedenti = 0, interventi_precedenti = 0;
+
+    riassumi_popolazione(memoria2, params.min_n_atomico, &istantanea->popolazione);
+
+    uso_scheduler uso[N_COMPONENTI];
+    leggi_uso_componenti(uso);
+    for (int c = 0; c < N_COMPONENTI; c++)
+    {
+        int avviato = c == COMPONENTE_MASTER || c == COMPONENTE_ATOMO || processi_controllo[c - COMPONENTE_ATTIVATORE] > 0;
+        istantanea->attesa_cpu_us[c] = avviato ? (uso[c].attesa_ns - uso_precedente[c].attesa_ns) / 1000 : -1;
+        uso_precedente[c] = uso[c];
+    }
+
+    istantanea->invii_bloccati_ultimo_secondo = 0;
+    for (int i = 0; i < N_CODE; i++)
+    {
+        istantanea->code_lette[i] = leggi_stato_coda(code[i], &istantanea->code[i]) == 0;
+        long long b = __atomic_load_n(&memoria2->code.bloccati[i], __ATOMIC_RELAXED);
+        istantanea->invii_bloccati_ultimo_secondo += b - bloccati_precedenti[i];
+        bloccati_precedenti[i] = b;
+    }
+
+    istantanea->atomi_ospitati = istantanea->atomi_ospitati_minimo = istantanea->atomi_ospitati_massimo = 0;
+    for (int i = 0; i < params.n_ospiti; i++)
+    {
+        int atomi = __atomic_load_n(&memoria2->atomi_ospitati[i], __ATOMIC_RELAXED);
+        istantanea->atomi_ospitati_minimo = i == 0 || atomi < istantanea->atomi_ospitati_minimo ? atomi : istantanea->atomi_ospitati_minimo;
+        istantanea->atomi_ospitati_massimo = atomi > istantanea->atomi_ospitati_massimo ? atomi : istantanea->atomi_ospitati_massimo;
+        istantanea->atomi_ospitati += atomi;
+    }
+
+    if (cgroup_attivo)
+    {
+        campiona_cgroup(&cgroup, &istantanea->cgroup);
+        istantanea->cpu_cgroup_ultimo_secondo_us = istantanea->cgroup.cpu_us >= 0 ? istantanea->cgroup.cpu_us - cpu_cgroup_precedente_us : -1;
+        cpu_cgroup_precedente_us = istantanea->cgroup.cpu_us;
+    }
+
+    unsigned long long passi = __atomic_load_n(&memoria2->passi_inibitore, __ATOMIC_RELAXED);
+    unsigned long long interventi = __atomic_load_n(&memoria2->interventi_inibitore, __ATOMIC_RELAXED);
+    istantanea->passi_inibitore_ultimo_secondo = passi - passi_precedenti;
+    istantanea->interventi_inibitore_ultimo_secondo = interventi - interventi_precedenti;
+    passi_precedenti = passi;
+    interventi_precedenti = interventi;
+
+    // L'errore della previsione è accumulato dall'inibitore: letto e azzerato in un'unica operazione
+    previsione_energia *p = &memoria2->previsione;
+    istantanea->previsione_intervalli = __atomic_exchange_n(&p->intervalli_tick, 0, __ATOMIC_RELAXED);
+    istantanea->previsione_errore = __atomic_exchange_n(&p->errore_tick, 0, __ATOMIC_RELAXED);
+    istantanea->previsione_errore_assoluto = __atomic_exchange_n(&p->errore_assoluto_tick, 0, __ATOMIC_RELAXED);
+    istantanea->previsione_limite = __atomic_load_n(&p->limite_permessi, __ATOMIC_RELAXED);
+    istantanea->previsione = p->previsione;
+    istantanea->previsione_margine = p->margine;
+    istantanea->previsione_in_avvio = p->riempimento < AVVIO_PREVISIONE;
 }
 
-void stato_simulazione()
+void stampa_stato(const istantanea_tick *istantanea)
 {
     dprintf(1, "\n");
-    dprintf(1, "TEMPO RESTANTE: %d secondi\n", params.sim_duration - tempo_passato);
-    dprintf(1, "atomi attivi: %d\n", memoria2->atomi_attivi);
-    dprintf(1, "Numero Attivazioni: %d, Ultimo secondo: %d\n", num_attivazioni, num_attivazioni_ultimo_secondo);
-    dprintf(1, "Energia prodotta: %d, Ultimo secondo: %d\n", memoria2->energia_totale, memoria2->energia_totale_ultimo_secondo);
-    dprintf(1, "Energia consumata: %d, Ultimo secondo: %d\n", memoria2->energia_prelevata, params.energy_demand);
-    dprintf(1, "Numero scissioni: %d, Ultimo secondo: %d\n", num_scissioni, num_scissioni_ultimo_secondo);
-    dprintf(1, "Quantita' scorie: %d, Ultimo secondo: %d\n", num_scorie, num_scorie_ultimo_secondo);
+    dprintf(1, "TEMPO RESTANTE: %d secondi\n", params.sim_duration - istantanea->tempo_passato);
+    dprintf(1, "atomi attivi: %d\n", istantanea->atomi_attivi);
+    if (!riproduzione)
+    {
+        stampa_popolazione(istantanea);
+    }
+    dprintf(1, "Numero Attivazioni: %d, Ultimo secondo: %d\n", istantanea->attivazioni, istantanea->attivazioni_ultimo_secondo);
+    dprintf(1, "Energia prodotta: %d, Ultimo secondo: %d\n", istantanea->energia_totale, istantanea->energia_ultimo_secondo);
+    dprintf(1, "Energia consumata: %d, Ultimo secondo: %d\n", istantanea->energia_prelevata, params.energy_demand);
+    dprintf(1, "Numero scissioni: %d, Ultimo secondo: %d\n", istantanea->scissioni, istantanea->scissioni_ultimo_secondo);
+    if (riproduzione)
+    {
+        dprintf(1, "Quantita' scorie: %d, Ultimo secondo: %d\n", istantanea->scorie, istantanea->scorie_ultimo_secondo);
+    }
+    else
+    {
+        // Il registro non distingue le scorie senza processo
+        dprintf(1, "Quantita' scorie: %d (senza processo %d), Ultimo secondo: %d\n", istantanea->scorie,
+                istantanea->scorie_senza_processo, istantanea->scorie_ultimo_secondo);
+    }
+    dprintf(1, "Generazione atomi: riuscite %lld, fallite %lld, ritentate %lld, scartate %lld, evitate (scorie) %lld, latenza media %lld us (recente %lld us), quota alimentazione %d\n",
+            istantanea->generazione.riusciti, istantanea->generazione.falliti, istantanea->generazione.ritentati,
+            istantanea->generazione.scartati, istantanea->generazione.risparmiati, istantanea->latenza_media_generazione_us,
+            istantanea->generazione.latenza_us_recente,
+            istantanea->generazione.quota_alimentazione);
+    if (!riproduzione)
+    {
+        stampa_attesa_ultimo_secondo(istantanea);
+        dprintf(1, "Latenza scissione-contabilita': %lld scissioni, p50 %lld us, p99 %lld us, max %lld us, nel secondo sbagliato: %lld\n",
+                istantanea->latenze_campioni, istantanea->latenza_p50_ns / 1000, istantanea->latenza_p99_ns / 1000,
+                istantanea->latenza_massima_ns / 1000, istantanea->fuori_secondo);
+    }
+    if (!riproduzione)
+    {
+        stampa_code(istantanea);
+    }
+    if (!riproduzione && params.n_ospiti > 0)
+    {
+        stampa_ospiti(istantanea);
+    }
+    if (cgroup_attivo)
+    {
+        stampa_cgroup(istantanea);
+    }
 
     if(avvia_inibitore ==1){
-        if(inibitore_attivo==1){
+        if(istantanea->inibitore_attivo==1){
     dprintf(1,"\n----INIBITORE ATTIVO----\n");
         }
         else{
              dprintf(1,"\n----INIBITORE INATTIVO----\n");
         }
-    dprintf(1, "Energia assorbita: %d, Ultimo secondo:%d\n", memoria2->energia_assorbita, memoria2->energia_assorbita_ultimo_sec);
-    if(sem_getvalue(sem_scissione)==0)
+    dprintf(1, "Energia assorbita: %d, Ultimo secondo:%d\n", istantanea->energia_assorbita, istantanea->energia_assorbita_ultimo_secondo);
+    stampa_previsione(istantanea);
+    if (!riproduzione)
+    {
+        stampa_ciclo_inibitore(istantanea);
+    }
+    if (!riproduzione)
+    {
+        dprintf(1, "Ammissione: obiettivo %d atomi attivi, permessi concessi ultimo secondo: %d, disponibili: %d\n",
+                istantanea->obiettivo_atomi, istantanea->permessi_concessi_ultimo_secondo, istantanea->permessi_disponibili);
+    }
+    if(istantanea->ammissione_chiusa)
     {
         dprintf(1, "Scissioni bloccate perchè ci sono troppi atomi attivi.\n\n");
     }
@@ -275,36 +1168,211 @@ void stato_simulazione()
         dprintf(1,"Scissioni in corso.\n\n");
     }
     }
+}
+
+long long tempo_cpu_reattore_ms()
+{
+    struct rusage proprio, figli;
+    getrusage(RUSAGE_SELF, &proprio);
+    getrusage(RUSAGE_CHILDREN, &figli);
+    long long us = proprio.ru_utime.tv_sec * 1000000LL + proprio.ru_utime.tv_usec +
+                   proprio.ru_stime.tv_sec * 1000000LL + proprio.ru_stime.tv_usec +
+                   figli.ru_utime.tv_sec * 1000000LL + figli.ru_utime.tv_usec +
+                   figli.ru_stime.tv_sec * 1000000LL + figli.ru_stime.tv_usec;
+    return us / 1000;
+}
+
+void leggi_uso_componenti(uso_scheduler *uso)
+{
+    memset(uso, 0, sizeof(uso_scheduler) * N_COMPONENTI);
+    leggi_uso_scheduler(0, &uso[COMPONENTE_MASTER]);
+    // processi_controllo segue l'ordine dei componenti: attivatore, alimentazione, inibitore
+    for (int i = 0; i < N_PROCESSI_CONTROLLO; i++)
+    {
+        if (processi_controllo[i] > 0)
+        {
+            leggi_uso_scheduler(processi_controllo[i], &uso[COMPONENTE_ATTIVATORE + i]);
+        }
+    }
+    uso[COMPONENTE_ATOMO].attesa_ns = memoria2->statistiche.attesa_cpu_us * 1000;
+    uso[COMPONENTE_ATOMO].fette = memoria2->statistiche.fette;
+}
+
+void stampa_ciclo_inibitore(const istantanea_tick *istantanea)
+{
+    dprintf(1, "Ciclo di controllo: %llu passi nell'ultimo secondo (%d Hz), %llu assorbimenti\n",
+            istantanea->passi_inibitore_ultimo_secondo, params.frequenza_inibitore,
+            istantanea->interventi_inibitore_ultimo_secondo);
+}
+
+void stampa_cgroup(const istantanea_tick *istantanea)
+{
+    const campione_cgroup *c = &istantanea->cgroup;
+    long long cpu_us = istantanea->cpu_cgroup_ultimo_secondo_us;
+    dprintf(1, "Cgroup: CPU ultimo secondo %lld ms (utente %lld, sistema %lld ms in totale)",
+            cpu_us >= 0 ? cpu_us / 1000 : -1, c->utente_us / 1000, c->sistema_us / 1000);
+    if (c->memoria_byte >= 0)
+    {
+        dprintf(1, ", memoria %lld KiB", c->memoria_byte / 1024);
+    }
+    else
+    {
+        dprintf(1, ", memoria n/d");
+    }
+    if (c->processi >= 0)
+    {
+        dprintf(1, ", processi %lld", c->processi);
+        if (cgroup.pids_max > 0)
+        {
+            dprintf(1, " su %ld (%lld fork rifiutate)", cgroup.pids_max, c->processi_rifiutati);
+        }
+    }
+    else
+    {
+        dprintf(1, ", processi n/d");
+    }
+    dprintf(1, "\n");
+    if (c->pressione_cpu >= 0)
+    {
+        dprintf(1, "Pressione (some avg10): CPU %.2f%%, memoria %.2f%%, I/O %.2f%%\n",
+                c->pressione_cpu, c->pressione_memoria, c->pressione_io);
+    }
+}
+
+void stampa_popolazione(const istantanea_tick *istantanea)
+{
+    const riepilogo_popolazione *r = &istantanea->popolazione;
+    if (r->atomi == 0)
+    {
+        dprintf(1, "Popolazione: nessun atomo vivo\n");
+        return;
+    }
+    dprintf(1, "Popolazione: numero atomico min %d, p10 %d, mediana %d, p90 %d, max %d; fissili %d su %d (%d vicini alle scorie), potenziale %.0f\n",
+            r->minimo, r->p10, r->mediana, r->p90, r->massimo, r->fissili, r->atomi, r->vicini_scoria, r->potenziale);
+}
+
+void stampa_previsione(const istantanea_tick *istantanea)
+{
+    if (riproduzione)
+    {
+        dprintf(1, "Previsione: non usata nella riproduzione (regola fissa)\n");
+        return;
+    }
+    long long intervalli = istantanea->previsione_intervalli;
+    if (intervalli == 0)
+    {
+        dprintf(1, "Previsione: nessun intervallo osservato\n");
+        return;
+    }
+    dprintf(1, "Previsione: prossimo intervallo %d (margine %d), errore medio %.1f, errore assoluto medio %.1f su %lld intervalli%s",
+            istantanea->previsione, istantanea->previsione_margine, (double)istantanea->previsione_errore / intervalli,
+            (double)istantanea->previsione_errore_assoluto / intervalli, intervalli,
+            istantanea->previsione_in_avvio ? " (avvio: regola fissa)" : "");
+    if (istantanea->previsione_limite >= 0)
+    {
+        dprintf(1, ", limite permessi %d\n", istantanea->previsione_limite);
+    }
+    else
+    {
+        dprintf(1, "\n");
+    }
+}
+
+void stampa_attesa_ultimo_secondo(const istantanea_tick *istantanea)
+{
+    dprintf(1, "Attesa CPU ultimo secondo (us):");
+    for (int c = 0; c < N_COMPONENTI; c++)
+    {
+        if (istantanea->attesa_cpu_us[c] < 0)
+        {
+            continue;
+        }
+        dprintf(1, " %s %lld%s", nome_componente(c), istantanea->attesa_cpu_us[c],
+                c == COMPONENTE_ATOMO ? " (raccolti)" : "");
+    }
+    dprintf(1, "\n");
+}
+
+void stampa_latenza_scheduling(const uso_scheduler *uso, const statistiche_atomi *statistiche)
+{
+    dprintf(1, "\nLATENZA DI SCHEDULING:\n");
+    for (int c = 0; c < N_COMPONENTI; c++)
+    {
+        if (uso[c].fette == 0)
+        {
+            continue;
+        }
+        if (c == COMPONENTE_ATOMO)
+        {
+            dprintf(1, "  %-14s CPU %8lld ms, attesa %8lld ms, %lld us per fetta\n", nome_componente(c),
+                    (statistiche->utime_us + statistiche->stime_us) / 1000, statistiche->attesa_cpu_us / 1000,
+                    statistiche->attesa_cpu_us / statistiche->fette);
+            continue;
+        }
+        dprintf(1, "  %-14s CPU %8lld ms, attesa %8lld ms, %lld us per fetta\n", nome_componente(c),
+                uso[c].esecuzione_ns / 1000000, uso[c].attesa_ns / 1000000, uso[c].attesa_ns / 1000 / uso[c].fette);
+    }
+}
+
+void checkpoint_handler(int signum)
+{
+    checkpoint_richiesto = 1;
+}
+
+void salva_checkpoint()
+{
+    struct timespec inizio;
+    clock_gettime(CLOCK_MONOTONIC, &inizio);
+
+    contatori_master contatori;
+    contatori.tempo_passato = tempo_passato;
+    contatori.num_scissioni = num_scissioni;
+    contatori.num_scorie = num_scorie;
+    contatori.num_attivazioni = num_attivazioni;
 
-    memoria2->energia_totale_ultimo_secondo = 0;
-    num_scissioni_ultimo_secondo = 0;
-    num_scorie_ultimo_secondo = 0;
-    num_attivazioni_ultimo_secondo = 0;
+    mkdir("build", 0755);
+    int atomi = scrivi_checkpoint(percorso_checkpoint, &contatori, memoria2);
+    if (atomi == -1)
+    {
+        dprintf(2, "CHECKPOINT: impossibile scrivere %s\n", percorso_checkpoint);
+        return;
+    }
+    dprintf(1, "CHECKPOINT: secondo %d, %d atomi vivi salvati in %s (%lld us)\n",
+            tempo_passato, atomi, percorso_checkpoint, nanosecondi_da(&inizio) / 1000);
 }
 
 int new_atomo(int n_atomico)
 {
-    char buffer[100];
-    sprintf(buffer, "%d", n_atomico); // Converti il numero atomico in stringa
-    char *pathname = "bin/atomo";
-    int pid = fork();
+    // Un atomo sotto MIN_N_ATOMICO sarebbe subito scoria: viene contato come tale senza processo
+    if (scoria_senza_processo(n_atomico, &params, memoria2))
+    {
+        secchio_corrente->scorie++;
+        secchio_corrente->scorie_senza_processo++;
+        registra_evento(&registro, EVENTO_SCORIA, 1);
+        statistiche_eventi.messaggi_equivalenti += 3;
+        return 0;
+    }
 
-    switch (pid)
+    lignaggio_atomo radice = nuova_radice(arena, LOTTO_MASTER);
+    int pid = genera_atomo(n_atomico, &radice, memoria->pgid_reattore, memoria, memoria2);
+    if (pid == -1)
     {
-    case -1:
-        perror("Error starting the process");
+        annulla_figlio(arena, NULL, &radice);
+    }
 
-        send_type_message(queue, -1, 4);
-        send_type_message(queue, 3, 15);
-        exit(EXIT_FAILURE);
-        break;
-    case 0:
-        execlp(pathname, pathname, buffer, NULL);
-        perror("Exec fallito");
-        exit(EXIT_FAILURE);
-    default:
-        return pid;
+    // Il master è il destinatario della coda: gli atomi che genera vengono contati senza record,
+    // mentre prima ognuno si annunciava con un messaggio
+    if (pid != -1)
+    {
+        secchio_corrente->delta_atomi++;
+        statistiche_eventi.messaggi_equivalenti++;
+    }
+    // Il MELTDOWN viene letto dal ciclo principale, che esegue l'arresto ordinato
+    else if (meltdown_sostenuto(memoria2, &params))
+    {
+        invia_terminazione(3);
     }
+    return pid;
 }
 
 void inibitore_handler(int signum)
@@ -316,12 +1384,123 @@ void inibitore_handler(int signum)
             {
                 kill(pid_inibitore, SIGUSR2);
                 inibitore_attivo = 0;
+                registra_evento(&registro, EVENTO_INIBITORE, 0);
             }
             else
             {
                 kill(pid_inibitore, SIGUSR2);
                 inibitore_attivo = 1;
+                registra_evento(&registro, EVENTO_INIBITORE, 1);
+            }
+        }
+    }
+}
+
+void stampa_lignaggi()
+{
+    int n_lignaggi;
+    aggregato_lignaggio *aggregati = aggrega_lignaggi(arena, &n_lignaggi);
+    if (aggregati == NULL)
+    {
+        return;
+    }
+
+    uint32_t n_archi = arena->n_archi;
+    int profondita = 0;
+    for (int i = 0; i < n_lignaggi; i++)
+    {
+        if (aggregati[i].profondita > profondita)
+        {
+            profondita = aggregati[i].profondita;
+        }
+    }
+    dprintf(1, "Lignaggi: %d, archi %u su %u (%u persi per arena piena), generazione massima %d\n",
+            n_lignaggi, n_archi < arena->capacita ? n_archi : arena->capacita, arena->capacita,
+            n_archi > arena->capacita ? n_archi - arena->capacita : 0, profondita);
+
+    // Selezione dei lignaggi più energetici: pochi passaggi sul vettore invece di ordinarlo
+    int scelti[LIGNAGGI_STAMPATI];
+    int n_scelti = 0;
+    for (; n_scelti < LIGNAGGI_STAMPATI; n_scelti++)
+    {
+        int migliore = -1;
+        for (int i = 0; i < n_lignaggi; i++)
+        {
+            int gia_scelto = 0;
+            for (int j = 0; j < n_scelti; j++)
+            {
+                gia_scelto |= scelti[j] == i;
             }
+            if (!gia_scelto && aggregati[i].atomi > 0 &&
+                (migliore == -1 || aggregati[i].energia > aggregati[migliore].energia))
+            {
+                migliore = i;
+            }
+        }
+        if (migliore == -1)
+        {
+            break;
         }
+        scelti[n_scelti] = migliore;
     }
+
+    for (int j = 0; j < n_scelti; j++)
+    {
+        aggregato_lignaggio *a = &aggregati[scelti[j]];
+        char origine[32];
+        if (a->lotto == LOTTO_MASTER)
+        {
+            snprintf(origine, sizeof(origine), "master");
+        }
+        else if (a->lotto > 0)
+        {
+            snprintf(origine, sizeof(origine), "alimentazione, passo %d", a->lotto);
+        }
+        else
+        {
+            snprintf(origine, sizeof(origine), "radice non registrata");
+        }
+        dprintf(1, "  lignaggio %d (%s): energia %lld, %d atomi, profondita %d, ventaglio massimo %d, medio %.2f\n",
+                scelti[j], origine, a->energia, a->atomi, a->profondita, a->ventaglio,
+                a->genitori > 0 ? (double)a->figli / a->genitori : 0.0);
+    }
+    free(aggregati);
+}
+
+void pubblica_stato_metriche()
+{
+    campione_metriche campione;
+    campione.tick = tempo_passato;
+    campione.energia = memoria2->energia_totale;
+    campione.energia_prelevata = memoria2->energia_prelevata;
+    campione.energia_assorbita = memoria2->energia_assorbita;
+    campione.scissioni = num_scissioni;
+    campione.scorie = num_scorie;
+    campione.attivazioni = num_attivazioni;
+    campione.atomi_attivi = memoria2->atomi_attivi;
+    campione.inibitore_attivo = avvia_inibitore && inibitore_attivo;
+    campione.interventi_inibitore = __atomic_load_n(&memoria2->interventi_inibitore, __ATOMIC_RELAXED);
+    campione.generazioni_riuscite = __atomic_load_n(&memoria2->generazione.riusciti, __ATOMIC_RELAXED);
+    campione.generazioni_fallite = __atomic_load_n(&memoria2->generazione.falliti, __ATOMIC_RELAXED);
+    campione.generazioni_scartate = __atomic_load_n(&memoria2->generazione.scartati, __ATOMIC_RELAXED);
+    campione.ritardo_tick_us = ritardo_tick_us;
+    campione.ritardo_tick_massimo_us = ritardo_tick_massimo_us;
+    campione.ritardo_tick_totale_us = ritardo_tick_totale_us;
+    pubblica_metriche(&metriche, &campione);
+}
+
+void stampa_latenza_contabilita_totale()
+{
+    // Le scissioni contate dopo l'ultimo tick sono ancora nei secchi
+    for (int i = 0; i < N_SECCHI; i++)
+    {
+        somma_latenze(&latenze_contabilita_totali, &secchi[i].latenze);
+        fuori_secondo_totali += secchi[i].fuori_secondo;
+    }
+
+    istogramma_latenza *totale = &latenze_contabilita_totali;
+    dprintf(1, "Latenza scissione-contabilita' totale: %lld scissioni, p50 %lld us, p90 %lld us, p99 %lld us, max %lld us, nel secondo sbagliato: %lld (%.2f%%)\n",
+            totale->campioni, percentile_latenza(totale, 50) / 1000, percentile_latenza(totale, 90) / 1000,
+            percentile_latenza(totale, 99) / 1000, totale->massimo_ns / 1000, fuori_secondo_totali,
+            totale->campioni > 0 ? 100.0 * fuori_secondo_totali / totale->campioni : 0.0);
 }
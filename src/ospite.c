@@ -0,0 +1,207 @@
+#include "../headers/ospite.h"
+/**
+ * @file ospite.c
+ * @brief Processo ospite che esegue molti atomi come macchine a stati.
+ *
+ * Ogni ospite riceve il proprio indice come argomento, accoglie gli atomi che il master e
+ * l'alimentazione gli affidano e, a ogni attivazione concessa dall'attivatore, fa scindere uno
+ * dei propri atomi a turno. Il figlio della scissione resta nello stesso ospite.
+ */
+
+// VARIABILI GLOBALI
+SimulationParams params;
+shmseg *memoria;
+shmseg2 *memoria2;
+arena_lignaggi *arena = NULL;
+int indice_ospite;
+atomo_ospitato *atomi = NULL;
+int n_atomi = 0;
+int capacita_atomi = 0;
+int prossimo_attivato = 0;
+
+int main(int argc, char *argv[])
+{
+    // INIZIALIZZAZIONE
+    if (argc < 2)
+    {
+        fprintf(stderr, "Uso: %s <indice ospite>\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+    const char *filename = percorso_configurazione();
+    params = read_params_from_file(filename);
+    // Gli ospiti eseguono gli atomi: ne ereditano CPU, politica e nice
+    applica_profilo(&params, COMPONENTE_ATOMO);
+    indice_ospite = atoi(argv[1]);
+    ignore(SIGINT);
+    ignore(SIGUSR2);
+
+    int istanza = istanza_corrente();
+    int m1 = create_shared_memory("src/master.c", istanza, sizeof(shmseg));
+    memoria = attach_shared_memory(m1);
+    int m2 = create_shared_memory("src/inibitore.c", istanza, sizeof(shmseg2));
+    memoria2 = attach_shared_memory2(m2);
+    arena = collega_arena(memoria->id_arena_lignaggi);
+
+    if (!attendi_avvio_ospite())
+    {
+        rilascia_atomi();
+        exit(EXIT_SUCCESS);
+    }
+
+    // CICLO DELLA SIMULAZIONE
+    while (reattore_in_corso(memoria))
+    {
+        accogli_atomi();
+        elimina_scorie();
+        if (n_atomi == 0)
+        {
+            usleep(ATTESA_OSPITE_MS * 1000);
+            continue;
+        }
+
+        // L'attesa è breve: gli atomi affidati all'ospite vanno accolti anche senza attivazioni
+        int esito = decrease_sem_timed(memoria->id_attivatore_sem, ATTESA_OSPITE_MS);
+        if (esito == -1)
+        {
+            break;
+        }
+        if (esito == 0 && reattore_in_corso(memoria))
+        {
+            // Gli atomi vengono attivati a turno, come i processi in attesa sul semaforo
+            prossimo_attivato = prossimo_attivato % n_atomi;
+            scissione_ospitata(prossimo_attivato++);
+        }
+    }
+
+    rilascia_atomi();
+    exit(EXIT_SUCCESS);
+}
+
+int attendi_avvio_ospite()
+{
+    while (reattore_in_corso(memoria))
+    {
+        accogli_atomi();
+        int esito = wait_for_zero_sem_timed(memoria->id_start, ATTESA_OSPITE_MS);
+        if (esito == 0)
+        {
+            return 1;
+        }
+        if (esito == -1)
+        {
+            return 0;
+        }
+    }
+    return 0;
+}
+
+void aggiungi_atomo(int n_atomico, const lignaggio_atomo *lignaggio)
+{
+    if (n_atomi == capacita_atomi)
+    {
+        capacita_atomi = capacita_atomi > 0 ? capacita_atomi * 2 : 64;
+        atomi = realloc(atomi, capacita_atomi * sizeof(atomo_ospitato));
+        if (atomi == NULL)
+        {
+            perror("realloc error");
+            exit(EXIT_FAILURE);
+        }
+    }
+    atomi[n_atomi].n_atomico = n_atomico;
+    atomi[n_atomi].lignaggio = *lignaggio;
+    n_atomi++;
+    // Come un processo atomo al proprio avvio
+    aggiorna_popolazione(memoria2, 0, n_atomico);
+}
+
+void accogli_atomi()
+{
+    messaggio_ospite messaggio;
+    // Gli atomi ricevuti sono già contati da chi li ha affidati all'ospite
+    while (ricevi_atomo(memoria, indice_ospite, &messaggio))
+    {
+        aggiungi_atomo(messaggio.n_atomico, &messaggio.lignaggio);
+    }
+}
+
+void elimina_scorie()
+{
+    for (int i = 0; i < n_atomi;)
+    {
+        if (atomi[i].n_atomico >= params.min_n_atomico)
+        {
+            i++;
+            continue;
+        }
+        record_evento scoria = nuovo_record(RECORD_SCORIA);
+        scoria.n_atomico = atomi[i].n_atomico;
+        scoria.delta_atomi = -1;
+        pubblica_record(memoria, memoria2, &scoria);
+        aggiorna_popolazione(memoria2, atomi[i].n_atomico, 0);
+        aggiorna_atomi_ospitati(-1);
+        // Rimuove l'atomo sostituendolo con l'ultimo
+        atomi[i] = atomi[--n_atomi];
+    }
+}
+
+int scissione_ospitata(int i)
+{
+    int n_atomico = atomi[i].n_atomico;
+    int n_atomico_figlio = estrai_numero_atomico(memoria2, n_atomico);
+    n_atomico = n_atomico - n_atomico_figlio;
+    atomi[i].n_atomico = n_atomico;
+    aggiorna_popolazione(memoria2, n_atomico + n_atomico_figlio, n_atomico);
+
+    if (!richiedi_permesso(memoria, memoria2))
+    {
+        // Come per un processo atomo, la scissione bloccata non crea il figlio
+        return 0;
+    }
+
+    int energia = energy(n_atomico, n_atomico_figlio);
+    lignaggio_atomo lignaggio_figlio = nuovo_figlio(arena, &atomi[i].lignaggio, energia);
+
+    record_evento record = nuovo_record(RECORD_SCISSIONE);
+    record.genitore = getpid();
+    record.n_atomico = n_atomico;
+    record.n_atomico_figlio = n_atomico_figlio;
+    record.energia = energia;
+
+    // Un figlio sotto MIN_N_ATOMICO è contato come scoria senza entrare nell'ospite
+    if (scoria_senza_processo(n_atomico_figlio, &params, memoria2))
+    {
+        record.pid = 0;
+        record.valore = SCORIA_SENZA_PROCESSO;
+        pubblica_record(memoria, memoria2, &record);
+        return energia;
+    }
+
+    // Il figlio nasce nell'ospite: la generazione non può fallire per mancanza di processi
+    struct timespec inizio;
+    clock_gettime(CLOCK_MONOTONIC, &inizio);
+    aggiungi_atomo(n_atomico_figlio, &lignaggio_figlio);
+    aggiorna_atomi_ospitati(1);
+    registra_generazione(memoria2, 1, nanosecondi_da(&inizio) / 1000);
+
+    record.pid = getpid();
+    record.delta_atomi = 1;
+    pubblica_record(memoria, memoria2, &record);
+    return energia;
+}
+
+void rilascia_atomi()
+{
+    for (int i = 0; i < n_atomi; i++)
+    {
+        aggiorna_popolazione(memoria2, atomi[i].n_atomico, 0);
+    }
+    aggiorna_atomi_ospitati(-n_atomi);
+    n_atomi = 0;
+    free(atomi);
+    atomi = NULL;
+}
+
+void aggiorna_atomi_ospitati(int delta)
+{
+    __atomic_fetch_add(&memoria2->atomi_ospitati[indice_ospite], delta, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,170 @@
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "../lib/conf.h"
+#include "../lib/istanza.h"
+#include "../lib/report.h"
+#include "../lib/processi.h"
+#include "../lib/popolazione.h"
+
+/**
+ * @file popolazione.c
+ * @brief Misura le scissioni al secondo per core del motore a colonne e del modello a processi.
+ *
+ * Il motore a colonne esegue `tick` passi su una popolazione iniziale di `atomi iniziali` atomi,
+ * aggiungendo a ogni passo `nuovi atomi per tick` atomi come l'alimentazione, con i parametri
+ * del file di configurazione. Con `-p` viene eseguita anche una simulazione a processi con la
+ * stessa configurazione, e il confronto usa il tempo di CPU di tutti i suoi processi.
+ *
+ * Uso: bin/popolazione [-t tick] [-n atomi iniziali] [-a nuovi atomi per tick] [-s seme] [-p]
+ */
+
+#define DIRECTORY_POPOLAZIONE "build/popolazione"
+#define TICK_DEFAULT 1000
+#define ATOMI_INIZIALI_DEFAULT 100000
+
+/**
+ * @brief Tempo di CPU consumato dal processo chiamante, in microsecondi.
+ */
+long long tempo_cpu_us()
+{
+    struct rusage uso;
+    getrusage(RUSAGE_SELF, &uso);
+    return uso.ru_utime.tv_sec * 1000000LL + uso.ru_utime.tv_usec +
+           uso.ru_stime.tv_sec * 1000000LL + uso.ru_stime.tv_usec;
+}
+
+/**
+ * @brief Esegue una simulazione a processi e ne restituisce il resoconto.
+ *
+ * Usa l'ultima istanza disponibile per non interferire con altre simulazioni.
+ *
+ * @param report Resoconto da riempire
+ * @return 0 in caso di successo, -1 in caso di errore
+ */
+int esegui_modello_processi(report_simulazione *report)
+{
+    mkdir("build", 0755);
+    mkdir(DIRECTORY_POPOLAZIONE, 0755);
+
+    pid_t pid = avvia_istanza(ISTANZE_MAX - 1, 1, NULL, DIRECTORY_POPOLAZIONE "/processi.log",
+                              DIRECTORY_POPOLAZIONE "/processi.txt");
+    if (pid == -1 || waitpid(pid, NULL, 0) == -1)
+    {
+        return -1;
+    }
+    return leggi_report(DIRECTORY_POPOLAZIONE "/processi.txt", report);
+}
+
+int main(int argc, char *argv[])
+{
+    int tick = TICK_DEFAULT;
+    int atomi_iniziali = ATOMI_INIZIALI_DEFAULT;
+    int nuovi_per_tick = -1;
+    uint32_t seme = (uint32_t)time(NULL);
+    int confronta = 0;
+    int opzione;
+
+    while ((opzione = getopt(argc, argv, "t:n:a:s:p")) != -1)
+    {
+        switch (opzione)
+        {
+        case 't':
+            tick = atoi(optarg);
+            break;
+        case 'n':
+            atomi_iniziali = atoi(optarg);
+            break;
+        case 'a':
+            nuovi_per_tick = atoi(optarg);
+            break;
+        case 's':
+            seme = (uint32_t)strtoul(optarg, NULL, 10);
+            break;
+        case 'p':
+            confronta = 1;
+            break;
+        default:
+            fprintf(stderr, "Uso: %s [-t tick] [-n atomi iniziali] [-a nuovi atomi per tick] [-s seme] [-p]\n", argv[0]);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    SimulationParams params = read_params_from_file(percorso_configurazione());
+    int capacita = params.max_atomi_attivi > 0 ? params.max_atomi_attivi : POPOLAZIONE_MAX_DEFAULT;
+    if (atomi_iniziali > capacita)
+    {
+        atomi_iniziali = capacita;
+    }
+    // In assenza di indicazioni la popolazione viene rinnovata di un decimo a ogni tick
+    if (nuovi_per_tick < 0)
+    {
+        nuovi_per_tick = atomi_iniziali / 10 > params.n_nuovi_atomi ? atomi_iniziali / 10 : params.n_nuovi_atomi;
+    }
+
+    popolazione_atomi popolazione;
+    esito_tick totale = {0};
+    crea_popolazione(&popolazione, capacita, seme);
+    aggiungi_atomi(&popolazione, atomi_iniziali, &params, &totale);
+
+    long long popolazione_massima = popolazione.dimensione;
+    struct timespec inizio;
+    clock_gettime(CLOCK_MONOTONIC, &inizio);
+    long long cpu_inizio = tempo_cpu_us();
+
+    for (int t = 0; t < tick; t++)
+    {
+        esito_tick esito = {0};
+        passo_popolazione(&popolazione, 0, &params, &esito);
+        aggiungi_atomi(&popolazione, nuovi_per_tick, &params, &esito);
+
+        totale.attivazioni += esito.attivazioni;
+        totale.scissioni += esito.scissioni;
+        totale.scorie += esito.scorie;
+        totale.energia += esito.energia;
+        if (popolazione.dimensione > popolazione_massima)
+        {
+            popolazione_massima = popolazione.dimensione;
+        }
+    }
+
+    long long durata_ns = nanosecondi_da(&inizio);
+    long long cpu_us = tempo_cpu_us() - cpu_inizio;
+    double scissioni_per_core = cpu_us > 0 ? totale.scissioni * 1e6 / cpu_us : 0.0;
+
+    dprintf(1, "MOTORE A COLONNE: %d tick, capacita' %d, popolazione massima %lld, finale %d\n",
+            tick, capacita, popolazione_massima, popolazione.dimensione);
+    dprintf(1, "Attivazioni %lld, scissioni %lld, scorie %lld, energia %lld\n",
+            totale.attivazioni, totale.scissioni, totale.scorie, totale.energia);
+    dprintf(1, "Durata %lld ms, CPU %lld ms, %.0f ns per attivazione\n", durata_ns / 1000000, cpu_us / 1000,
+            totale.attivazioni > 0 ? (double)durata_ns / totale.attivazioni : 0.0);
+    dprintf(1, "Scissioni al secondo per core: %.0f\n", scissioni_per_core);
+    distruggi_popolazione(&popolazione);
+
+    if (!confronta)
+    {
+        exit(EXIT_SUCCESS);
+    }
+
+    report_simulazione report;
+    dprintf(1, "\nMODELLO A PROCESSI: simulazione di %d secondi in corso...\n", params.sim_duration);
+    if (esegui_modello_processi(&report) == -1)
+    {
+        fprintf(stderr, "Simulazione a processi non riuscita, vedi %s/processi.log\n", DIRECTORY_POPOLAZIONE);
+        exit(EXIT_FAILURE);
+    }
+    double scissioni_per_core_processi = report.tempo_cpu_ms > 0 ? report.scissioni * 1000.0 / report.tempo_cpu_ms : 0.0;
+    dprintf(1, "Scissioni %lld in %d s, CPU %lld ms, esito %s\n", report.scissioni, report.tempo_passato,
+            report.tempo_cpu_ms, nome_esito(report.causa_terminazione));
+    dprintf(1, "Scissioni al secondo per core: %.0f\n", scissioni_per_core_processi);
+    if (scissioni_per_core_processi > 0)
+    {
+        dprintf(1, "\nRapporto motore a colonne / modello a processi: %.0fx\n",
+                scissioni_per_core / scissioni_per_core_processi);
+    }
+    exit(EXIT_SUCCESS);
+}